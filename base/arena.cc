@@ -0,0 +1,35 @@
+#include "base/arena.h"
+
+#include <cassert>
+
+Arena::Arena(size_t block_size)
+    : block_size_(block_size),
+      next_(nullptr),
+      end_(nullptr),
+      bytes_allocated_(0),
+      bytes_reserved_(0) {}
+
+size_t Arena::bytes_allocated() const {
+  return bytes_allocated_;
+}
+
+size_t Arena::bytes_reserved() const {
+  return bytes_reserved_;
+}
+
+void* Arena::AllocateSlow(size_t size, size_t alignment) {
+  assert(alignment <= alignof(std::max_align_t));
+  if (size > block_size_ / 4) {
+    // Large allocations get a block of their own so that the rest of the
+    // current block is not wasted.
+    blocks_.emplace_back(new char[size]);
+    bytes_allocated_ += size;
+    bytes_reserved_ += size;
+    return blocks_.back().get();
+  }
+  blocks_.emplace_back(new char[block_size_]);
+  bytes_reserved_ += block_size_;
+  next_ = blocks_.back().get();
+  end_ = next_ + block_size_;
+  return Allocate(size, alignment);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A bump allocator. Objects allocated from an arena are never freed one by
+// one; all of its memory is released in one shot when the arena is destroyed.
+// Destructors are not run, so only trivially destructible types are allowed.
+class Arena {
+ public:
+  explicit Arena(size_t block_size = 64 * 1024);
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  template<class T, class... Args>
+  T* New(Args&&... args) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Arena never runs destructors");
+    return new (Allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  // Returns n default-initialized objects.
+  template<class T>
+  T* NewArray(size_t n) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Arena never runs destructors");
+    return new (Allocate(sizeof(T) * n, alignof(T))) T[n];
+  }
+
+  // The number of bytes handed out so far, excluding alignment padding.
+  size_t bytes_allocated() const;
+  // The number of bytes obtained from the system.
+  size_t bytes_reserved() const;
+
+ private:
+  void* Allocate(size_t size, size_t alignment);
+  void* AllocateSlow(size_t size, size_t alignment);
+
+  size_t block_size_;
+  char* next_;
+  char* end_;
+  size_t bytes_allocated_;
+  size_t bytes_reserved_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+};
+
+inline void* Arena::Allocate(size_t size, size_t alignment) {
+  size_t padding = -reinterpret_cast<uintptr_t>(next_) & (alignment - 1);
+  if (size + padding > static_cast<size_t>(end_ - next_)) {
+    return AllocateSlow(size, alignment);
+  }
+  char* p = next_ + padding;
+  next_ = p + size;
+  bytes_allocated_ += size;
+  return p;
+}
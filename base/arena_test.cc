@@ -0,0 +1,57 @@
+#include "base/arena.h"
+
+#include <cstdint>
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Pair {
+  int first;
+  double second;
+
+  Pair(int first, double second) : first(first), second(second) {}
+};
+
+}  // namespace
+
+TEST(ArenaTest, New) {
+  Arena arena(256);
+  Pair* p = arena.New<Pair>(1, 2.5);
+  EXPECT_EQ(1, p->first);
+  EXPECT_EQ(2.5, p->second);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % alignof(Pair));
+  EXPECT_EQ(sizeof(Pair), arena.bytes_allocated());
+}
+
+TEST(ArenaTest, ManySmallObjects) {
+  Arena arena(256);
+  std::vector<Pair*> pairs;
+  for (int i = 0; i < 1000; ++i) {
+    arena.New<char>('x');
+    pairs.push_back(arena.New<Pair>(i, i * 0.5));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(i, pairs[i]->first);
+    EXPECT_EQ(i * 0.5, pairs[i]->second);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pairs[i]) % alignof(Pair));
+  }
+  EXPECT_EQ(1000 * (1 + sizeof(Pair)), arena.bytes_allocated());
+  EXPECT_LE(arena.bytes_allocated(), arena.bytes_reserved());
+}
+
+TEST(ArenaTest, LargeArray) {
+  Arena arena(256);
+  int* small = arena.NewArray<int>(4);
+  double* large = arena.NewArray<double>(1000);
+  int* after = arena.NewArray<int>(4);
+  for (int i = 0; i < 1000; ++i) {
+    large[i] = i;
+  }
+  for (int i = 0; i < 4; ++i) {
+    small[i] = after[i] = i;
+  }
+  EXPECT_EQ(999, large[999]);
+  // The large array got its own block; later small allocations still fit in
+  // the first one.
+  EXPECT_EQ(small + 4, after);
+}
@@ -2,6 +2,7 @@
 #include <cassert>
 #include <cmath>
 #include "base/base.h"
+#include "base/predicates.h"
 
 using std::min_element;
 
@@ -9,9 +10,22 @@ namespace {
 
 const double kEpsilon = 0.0000000001;
 
-bool InRange(double tested, double endpoint1, double endpoint2) {
-  return std::min(endpoint1, endpoint2) - kEpsilon <= tested
-      && tested <= std::max(endpoint1, endpoint2) + kEpsilon;
+// Clamps a rounded intersection coordinate into the range shared by both
+// segments, where the exact intersection lies. Without this an intersection
+// with a vertical segment can land just right of it, after its upper endpoint.
+double ClampToOverlap(double tested,
+                      double endpoint1, double endpoint2,
+                      double other_endpoint1, double other_endpoint2) {
+  double low = std::max(std::min(endpoint1, endpoint2),
+                        std::min(other_endpoint1, other_endpoint2));
+  double high = std::min(std::max(endpoint1, endpoint2),
+                         std::max(other_endpoint1, other_endpoint2));
+  return std::min(high, std::max(low, tested));
+}
+
+template<class T>
+Point ToDouble(BasicPoint<T> p) {
+  return Point(static_cast<double>(p.x), static_cast<double>(p.y));
 }
 
 }  // namespace
@@ -20,19 +34,8 @@ bool Near(double lhs, double rhs) {
   return std::abs(lhs - rhs) < kEpsilon;
 }
 
-bool operator==(Point lhs, Point rhs) {
-  return lhs.x == rhs.x && lhs.y == rhs.y;
-}
-
-bool operator!=(Point lhs, Point rhs) {
-  return !(lhs == rhs);
-}
-
-bool operator<(Point lhs, Point rhs) {
-  return LexicographicLess(lhs, rhs);
-}
-
-std::ostream& operator<<(std::ostream& os, Point point) {
+template<class T>
+std::ostream& operator<<(std::ostream& os, BasicPoint<T> point) {
   os << point.x << ", " << point.y;
   return os;
 }
@@ -49,48 +52,62 @@ bool Near(Point lhs, Point rhs) {
   return Near(lhs.x, rhs.x) && Near(lhs.y, rhs.y);
 }
 
-bool PointsMakesLeftTurn(Point p1, Point p2, Point p3) {
-  return DirectedLine(p1, p3).PointLiesToRight(p2);
+template<class T>
+bool PointsMakesLeftTurn(BasicPoint<T> p1, BasicPoint<T> p2,
+                         BasicPoint<T> p3) {
+  return Orientation(p1, p2, p3) > 0;
 }
 
-bool PointsMakesRightTurn(Point p1, Point p2, Point p3) {
-  return DirectedLine(p1, p3).PointLiesToLeft(p2);
+template<class T>
+bool PointsMakesRightTurn(BasicPoint<T> p1, BasicPoint<T> p2,
+                          BasicPoint<T> p3) {
+  return Orientation(p1, p2, p3) < 0;
 }
 
-DirectedLine::DirectedLine(Point p1, Point p2)
-    : a_(p2.y - p1.y), b_(p1.x - p2.x), c_(p2.x * p1.y - p1.x * p2.y) {}
+template<class T>
+BasicDirectedLine<T>::BasicDirectedLine(BasicPoint<T> p1, BasicPoint<T> p2)
+    : p1_(p1), p2_(p2) {
+  Point q1 = ToDouble(p1), q2 = ToDouble(p2);
+  a_ = q2.y - q1.y;
+  b_ = q1.x - q2.x;
+  c_ = q2.x * q1.y - q1.x * q2.y;
+}
 
-bool DirectedLine::is_vertical() const {
+template<class T>
+bool BasicDirectedLine<T>::is_vertical() const {
   return b_ == 0;
 }
 
-bool DirectedLine::is_horizontal() const {
+template<class T>
+bool BasicDirectedLine<T>::is_horizontal() const {
   return a_ == 0;
 }
 
-double DirectedLine::y_for_x(double x) const {
+template<class T>
+double BasicDirectedLine<T>::y_for_x(double x) const {
   assert(!is_vertical());
   return -(a_ * x + c_) / b_;
 }
 
-double DirectedLine::x_for_y(double y) const {
+template<class T>
+double BasicDirectedLine<T>::x_for_y(double y) const {
   assert(!is_horizontal());
   return -(b_ * y + c_) / a_;
 }
 
-bool DirectedLine::PointLiesToLeft(Point p) const {
-  return determinant(p) < -kEpsilon;
+template<class T>
+bool BasicDirectedLine<T>::PointLiesToLeft(BasicPoint<T> p) const {
+  return Orientation(p1_, p2_, p) > 0;
 }
 
-bool DirectedLine::PointLiesToRight(Point p) const {
-  return determinant(p) > kEpsilon;
+template<class T>
+bool BasicDirectedLine<T>::PointLiesToRight(BasicPoint<T> p) const {
+  return Orientation(p1_, p2_, p) < 0;
 }
 
-double DirectedLine::determinant(Point p) const {
-  return a_ * p.x + b_ * p.y + c_;
-}
-
-bool DirectedLine::IntersectsDirectedLine(DirectedLine other, Point* p) const {
+template<class T>
+bool BasicDirectedLine<T>::IntersectsDirectedLine(BasicDirectedLine other,
+                                                  Point* p) const {
   double A = other.a_ * b_ - a_ * other.b_;
   if (std::fabs(A) > kEpsilon) {
     double x = (c_ * other.b_ - other.c_ * b_) / A;
@@ -104,68 +121,96 @@ bool DirectedLine::IntersectsDirectedLine(DirectedLine other, Point* p) const {
   }
 }
 
-Segment::Segment(Point p1, Point p2)
+template<class T>
+BasicSegment<T>::BasicSegment(BasicPoint<T> p1, BasicPoint<T> p2)
     : endpoints_{{std::min(p1, p2), std::max(p1,p2)}} {}
 
-const std::array<Point, 2>& Segment::endpoints() const {
+template<class T>
+const std::array<BasicPoint<T>, 2>& BasicSegment<T>::endpoints() const {
   return endpoints_;
 }
 
-Point Segment::endpoint(int i) const {
+template<class T>
+BasicPoint<T> BasicSegment<T>::endpoint(int i) const {
   return endpoints_[i];
 }
 
-bool Segment::is_vertical() const {
+template<class T>
+bool BasicSegment<T>::is_vertical() const {
   return endpoint(0).x == endpoint(1).x;
 }
 
-bool Segment::is_horizontal() const {
+template<class T>
+bool BasicSegment<T>::is_horizontal() const {
   return endpoint(0).y == endpoint(1).y;
 }
 
-double Segment::y_for_x(double x) const {
+template<class T>
+double BasicSegment<T>::y_for_x(double x) const {
   return as_directed_line().y_for_x(x);
 }
 
-double Segment::x_for_y(double y) const {
+template<class T>
+double BasicSegment<T>::x_for_y(double y) const {
   return as_directed_line().x_for_y(y);
 }
 
-DirectedLine Segment::as_directed_line() const {
-  return DirectedLine(endpoint(0), endpoint(1));
+template<class T>
+BasicDirectedLine<T> BasicSegment<T>::as_directed_line() const {
+  return BasicDirectedLine<T>(endpoint(0), endpoint(1));
 }
 
-bool Segment::IntersectsSegment(Segment other, Point* p) const {
-  Point p1;
-  bool intersects =
-      as_directed_line().IntersectsDirectedLine(other.as_directed_line(), &p1);
-  if (intersects
-      && InRange(p1.x, endpoint(0).x, endpoint(1).x)
-      && InRange(p1.x, other.endpoint(0).x, other.endpoint(1).x)
-      && InRange(p1.y, endpoint(0).y, endpoint(1).y)
-      && InRange(p1.y, other.endpoint(0).y, other.endpoint(1).y)) {
-    if (p) {
-      *p = p1;
-    }
-    return true;
-  } else {
+template<class T>
+bool BasicSegment<T>::IntersectsSegment(BasicSegment other, Point* p) const {
+  int b0_side = Orientation(endpoint(0), endpoint(1), other.endpoint(0));
+  int b1_side = Orientation(endpoint(0), endpoint(1), other.endpoint(1));
+  int a0_side = Orientation(other.endpoint(0), other.endpoint(1), endpoint(0));
+  int a1_side = Orientation(other.endpoint(0), other.endpoint(1), endpoint(1));
+  if ((b0_side == 0 && b1_side == 0)
+      || b0_side * b1_side > 0 || a0_side * a1_side > 0) {
     return false;
   }
+  if (p) {
+    Point a0 = ToDouble(endpoint(0)), a1 = ToDouble(endpoint(1));
+    Point b0 = ToDouble(other.endpoint(0)), b1 = ToDouble(other.endpoint(1));
+    if (b0_side == 0) {
+      *p = b0;
+    } else if (b1_side == 0) {
+      *p = b1;
+    } else if (a0_side == 0) {
+      *p = a0;
+    } else if (a1_side == 0) {
+      *p = a1;
+    } else {
+      // Interpolate along this segment by the distances of its endpoints to
+      // the other line.
+      Point d = Point(b1.x - b0.x, b1.y - b0.y);
+      double s0 = d.x * (a0.y - b0.y) - d.y * (a0.x - b0.x);
+      double s1 = d.x * (a1.y - b0.y) - d.y * (a1.x - b0.x);
+      double t = std::min(1.0, std::max(0.0, s0 / (s0 - s1)));
+      Point p1(a0.x + t * (a1.x - a0.x), a0.y + t * (a1.y - a0.y));
+      *p = Point(ClampToOverlap(p1.x, a0.x, a1.x, b0.x, b1.x),
+                 ClampToOverlap(p1.y, a0.y, a1.y, b0.y, b1.y));
+    }
+  }
+  return true;
 }
 
-std::ostream& operator<<(std::ostream& os, Segment segment) {
+template<class T>
+std::ostream& operator<<(std::ostream& os, BasicSegment<T> segment) {
   os << "(" << segment.endpoint(0) << "), (" << segment.endpoint(1) << ")";
   return os;
 }
 
-bool operator==(const Polygon& lhs, const Polygon& rhs) {
+template<class T>
+bool operator==(const BasicPolygon<T>& lhs, const BasicPolygon<T>& rhs) {
   if (lhs.points.size() != rhs.points.size()) {
     return false;
   }
   auto lhs_min =
-      min_element(lhs.points.begin(), lhs.points.end(), LexicographicLess);
+      min_element(lhs.points.begin(), lhs.points.end());
   auto rhs_min =
-      min_element(rhs.points.begin(), rhs.points.end(), LexicographicLess);
+      min_element(rhs.points.begin(), rhs.points.end());
   for (int i = 0 ; i < lhs.points.size(); ++i) {
     if (*lhs_min != *rhs_min) {
       return false;
@@ -182,14 +227,14 @@ bool operator==(const Polygon& lhs, const Polygon& rhs) {
   return true;
 }
 
-bool operator!=(const Polygon& lhs, const Polygon& rhs) {
+template<class T>
+bool operator!=(const BasicPolygon<T>& lhs, const BasicPolygon<T>& rhs) {
   return !(lhs == rhs);
 }
 
-std::ostream& operator<<(std::ostream& os, const Polygon& polygon) {
-  auto iter = min_element(polygon.points.begin(),
-                          polygon.points.end(),
-                          LexicographicLess);
+template<class T>
+std::ostream& operator<<(std::ostream& os, const BasicPolygon<T>& polygon) {
+  auto iter = min_element(polygon.points.begin(), polygon.points.end());
   for (int i = 0; i < polygon.points.size(); ++i) {
     if (i != 0) {
       os << ", ";
@@ -202,3 +247,23 @@ std::ostream& operator<<(std::ostream& os, const Polygon& polygon) {
   }
   return os;
 }
+
+#define INSTANTIATE_GEOMETRY(T)                                               \
+  template std::ostream& operator<<(std::ostream&, BasicPoint<T>);            \
+  template bool PointsMakesLeftTurn(BasicPoint<T>, BasicPoint<T>,             \
+                                    BasicPoint<T>);                           \
+  template bool PointsMakesRightTurn(BasicPoint<T>, BasicPoint<T>,            \
+                                     BasicPoint<T>);                          \
+  template class BasicDirectedLine<T>;                                        \
+  template class BasicSegment<T>;                                             \
+  template std::ostream& operator<<(std::ostream&, BasicSegment<T>);          \
+  template bool operator==(const BasicPolygon<T>&, const BasicPolygon<T>&);   \
+  template bool operator!=(const BasicPolygon<T>&, const BasicPolygon<T>&);   \
+  template std::ostream& operator<<(std::ostream&, const BasicPolygon<T>&);
+
+INSTANTIATE_GEOMETRY(double)
+INSTANTIATE_GEOMETRY(float)
+INSTANTIATE_GEOMETRY(int32_t)
+INSTANTIATE_GEOMETRY(int64_t)
+
+#undef INSTANTIATE_GEOMETRY
@@ -1,31 +1,68 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 
 bool Near(double lhs, double rhs);
 
-struct Point {
-  double x;
-  double y;
-
-  Point() : x(0), y(0) {}
-  Point(double x, double y) : x(x), y(y) {}
+// The geometric types are templates on the coordinate type T, instantiated
+// for double, float, int32_t and int64_t. The double instantiations, Point,
+// Segment, DirectedLine and Polygon, are the ones used throughout. Every
+// instantiation decides orientations exactly with the fastest predicate for
+// its type, see base/predicates.h, which is exact for every int64_t
+// coordinate. Algorithms that compute in double can require less, such as
+// FindIntersections of chapter2/segment-intersection.h, which asserts that
+// int64_t coordinates do not exceed 2^53 in magnitude.
+
+template<class T>
+struct BasicPoint {
+  T x;
+  T y;
+
+  BasicPoint() : x(0), y(0) {}
+  BasicPoint(T x, T y) : x(x), y(y) {}
 };
 
-bool operator==(Point lhs, Point rhs);
-bool operator!=(Point lhs, Point rhs);
-bool operator<(Point lhs, Point rhs);
-std::ostream& operator<<(std::ostream& os, Point point);
+using Point = BasicPoint<double>;
+
+template<class T>
+bool operator==(BasicPoint<T> lhs, BasicPoint<T> rhs) {
+  return lhs.x == rhs.x && lhs.y == rhs.y;
+}
+
+template<class T>
+bool operator!=(BasicPoint<T> lhs, BasicPoint<T> rhs) {
+  return !(lhs == rhs);
+}
+
+// Lexicographic.
+template<class T>
+bool operator<(BasicPoint<T> lhs, BasicPoint<T> rhs) {
+  return lhs.x < rhs.x || (lhs.x == rhs.x && lhs.y < rhs.y);
+}
+
+template<class T>
+std::ostream& operator<<(std::ostream& os, BasicPoint<T> point);
+
+// operator< on Point, as a plain function that can be passed to algorithms.
 bool LexicographicLess(Point lhs, Point rhs);
 bool Near(Point lhs, Point rhs);
-bool PointsMakesLeftTurn(Point p1, Point p2, Point p3);
-bool PointsMakesRightTurn(Point p1, Point p2, Point p3);
-
-class DirectedLine {
+// Exact: collinear points make neither turn.
+template<class T>
+bool PointsMakesLeftTurn(BasicPoint<T> p1, BasicPoint<T> p2,
+                         BasicPoint<T> p3);
+template<class T>
+bool PointsMakesRightTurn(BasicPoint<T> p1, BasicPoint<T> p2,
+                          BasicPoint<T> p3);
+
+// Lines and intersection points are computed in double for every coordinate
+// type, since they do not have integer coordinates in general.
+template<class T>
+class BasicDirectedLine {
  public:
-  DirectedLine(Point p1, Point p2);
+  BasicDirectedLine(BasicPoint<T> p1, BasicPoint<T> p2);
 
   bool is_vertical() const;
   bool is_horizontal() const;
@@ -33,24 +70,27 @@ class DirectedLine {
   double y_for_x(double x) const;
   double x_for_y(double y) const;
 
-  bool PointLiesToLeft(Point p) const;
-  bool PointLiesToRight(Point p) const;
+  // Exact: points on the line lie neither to the left nor to the right.
+  bool PointLiesToLeft(BasicPoint<T> p) const;
+  bool PointLiesToRight(BasicPoint<T> p) const;
 
-  bool IntersectsDirectedLine(DirectedLine other, Point* p) const;
+  bool IntersectsDirectedLine(BasicDirectedLine other, Point* p) const;
 
  private:
+  BasicPoint<T> p1_, p2_;
   double a_, b_, c_;
-
-  double determinant(Point p) const;
 };
 
-class Segment {
+using DirectedLine = BasicDirectedLine<double>;
+
+template<class T>
+class BasicSegment {
  public:
-  Segment(Point p1, Point p2);
+  BasicSegment(BasicPoint<T> p1, BasicPoint<T> p2);
 
   // It is guaranteed that endpoints are sorted lexicographically.
-  const std::array<Point, 2>& endpoints() const;
-  Point endpoint(int i) const;
+  const std::array<BasicPoint<T>, 2>& endpoints() const;
+  BasicPoint<T> endpoint(int i) const;
 
   bool is_vertical() const;
   bool is_horizontal() const;
@@ -58,24 +98,39 @@ class Segment {
   double y_for_x(double x) const;
   double x_for_y(double y) const;
 
-  DirectedLine as_directed_line() const;
+  BasicDirectedLine<T> as_directed_line() const;
 
-  bool IntersectsSegment(Segment other, Point* p) const;
+  // Whether the segments cross or touch is decided exactly; collinear
+  // segments are reported as not intersecting. A touching endpoint is
+  // returned exactly, a crossing point is rounded into the bounding box
+  // shared by both segments.
+  bool IntersectsSegment(BasicSegment other, Point* p) const;
 
 private:
-  std::array<Point, 2> endpoints_;
+  std::array<BasicPoint<T>, 2> endpoints_;
 };
 
-std::ostream& operator<<(std::ostream& os, Segment segment);
+using Segment = BasicSegment<double>;
 
-struct Polygon {
-  std::vector<Point> points;
+template<class T>
+std::ostream& operator<<(std::ostream& os, BasicSegment<T> segment);
 
-  Polygon() {}
-  explicit Polygon(const std::vector<Point>& points) : points(points) {}
-  Polygon(const std::initializer_list<Point>& points) : points(points) {}
+template<class T>
+struct BasicPolygon {
+  std::vector<BasicPoint<T>> points;
+
+  BasicPolygon() {}
+  explicit BasicPolygon(const std::vector<BasicPoint<T>>& points)
+      : points(points) {}
+  BasicPolygon(const std::initializer_list<BasicPoint<T>>& points)
+      : points(points) {}
 };
 
-bool operator==(const Polygon& lhs, const Polygon& rhs);
-bool operator!=(const Polygon& lhs, const Polygon& rhs);
-std::ostream& operator<<(std::ostream& os, const Polygon& polygon);
+using Polygon = BasicPolygon<double>;
+
+template<class T>
+bool operator==(const BasicPolygon<T>& lhs, const BasicPolygon<T>& rhs);
+template<class T>
+bool operator!=(const BasicPolygon<T>& lhs, const BasicPolygon<T>& rhs);
+template<class T>
+std::ostream& operator<<(std::ostream& os, const BasicPolygon<T>& polygon);
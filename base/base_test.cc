@@ -60,23 +60,33 @@ TEST(DirectedLineTest, XForY_Vertical) {
 }
 
 TEST(DirectedLineTest, PointLiesToLeftRight_PositiveGradient) {
-  DirectedLine line(Point(3.8, -5.2), Point(13.2, 4.8));
-  EXPECT_FALSE(line.PointLiesToLeft(Point(8.5, -0.3)));
-  EXPECT_TRUE(line.PointLiesToRight(Point(8.5, -0.3)));
-  EXPECT_FALSE(line.PointLiesToLeft(Point(8.5, -0.2)));
-  EXPECT_FALSE(line.PointLiesToRight(Point(8.5, -0.2)));
-  EXPECT_TRUE(line.PointLiesToLeft(Point(8.5, -0.1)));
-  EXPECT_FALSE(line.PointLiesToRight(Point(8.5, -0.1)));
+  DirectedLine line(Point(3.75, -5.25), Point(13.25, 4.75));
+  EXPECT_FALSE(line.PointLiesToLeft(Point(8.5, -0.375)));
+  EXPECT_TRUE(line.PointLiesToRight(Point(8.5, -0.375)));
+  EXPECT_FALSE(line.PointLiesToLeft(Point(8.5, -0.25)));
+  EXPECT_FALSE(line.PointLiesToRight(Point(8.5, -0.25)));
+  EXPECT_TRUE(line.PointLiesToLeft(Point(8.5, -0.125)));
+  EXPECT_FALSE(line.PointLiesToRight(Point(8.5, -0.125)));
 }
 
 TEST(DirectedLineTest, PointLiesToLeftRight_NegativeGradient) {
-  DirectedLine line(Point(-3.8, -5.2), Point(-13.2, 4.8));
-  EXPECT_TRUE(line.PointLiesToLeft(Point(-8.5, -0.3)));
-  EXPECT_FALSE(line.PointLiesToRight(Point(-8.5, -0.3)));
-  EXPECT_FALSE(line.PointLiesToLeft(Point(-8.5, -0.2)));
-  EXPECT_FALSE(line.PointLiesToRight(Point(-8.5, -0.2)));
-  EXPECT_FALSE(line.PointLiesToLeft(Point(-8.5, -0.1)));
-  EXPECT_TRUE(line.PointLiesToRight(Point(-8.5, -0.1)));
+  DirectedLine line(Point(-3.75, -5.25), Point(-13.25, 4.75));
+  EXPECT_TRUE(line.PointLiesToLeft(Point(-8.5, -0.375)));
+  EXPECT_FALSE(line.PointLiesToRight(Point(-8.5, -0.375)));
+  EXPECT_FALSE(line.PointLiesToLeft(Point(-8.5, -0.25)));
+  EXPECT_FALSE(line.PointLiesToRight(Point(-8.5, -0.25)));
+  EXPECT_FALSE(line.PointLiesToLeft(Point(-8.5, -0.125)));
+  EXPECT_TRUE(line.PointLiesToRight(Point(-8.5, -0.125)));
+}
+
+TEST(DirectedLineTest, PointLiesToLeftRight_NearlyCollinear) {
+  // The rounded determinant is zero for both lines.
+  DirectedLine above(Point(0.5, 0.50000000000000011), Point(12, 12));
+  EXPECT_TRUE(above.PointLiesToLeft(Point(24, 24)));
+  EXPECT_FALSE(above.PointLiesToRight(Point(24, 24)));
+  DirectedLine below(Point(0.50000000000000011, 0.5), Point(12, 12));
+  EXPECT_FALSE(below.PointLiesToLeft(Point(24, 24)));
+  EXPECT_TRUE(below.PointLiesToRight(Point(24, 24)));
 }
 
 TEST(DirectedLineTest, PointLiesToLeftRight_Vertical) {
@@ -172,14 +182,61 @@ TEST(SegmentTest, Constructor) {
 }
 
 TEST(SegmentTest, IntersectsSegment) {
-  Segment s(Point(0.3, 0.5), Point(0.5, 0.7));
+  Segment s(Point(0.375, 0.625), Point(0.625, 0.875));
+  Point out;
+  EXPECT_FALSE(s.IntersectsSegment(Segment(Point(0.375, 0.375), Point(0.125, 0.625)), &out));
+  ASSERT_TRUE(s.IntersectsSegment(Segment(Point(0.5, 0.5), Point(0.25, 0.75)), &out));
+  EXPECT_EQ(Point(0.375, 0.625), out);
+  ASSERT_TRUE(s.IntersectsSegment(Segment(Point(0.625, 0.625), Point(0.375, 0.875)), &out));
+  EXPECT_TRUE(Near(Point(0.5, 0.75), out));
+  ASSERT_TRUE(s.IntersectsSegment(Segment(Point(0.75, 0.75), Point(0.5, 1)), &out));
+  EXPECT_EQ(Point(0.625, 0.875), out);
+  EXPECT_FALSE(s.IntersectsSegment(Segment(Point(0.875, 0.875), Point(0.625, 1.125)), &out));
+  EXPECT_FALSE(s.IntersectsSegment(Segment(Point(0.5, 0.75), Point(0.75, 1)), &out));
+}
+
+TEST(SegmentTest, IntersectsSegment_LargeCoordinates) {
+  Segment s(Point(500000.25, 4000000.5), Point(500100.75, 4000100.25));
+  Point out;
+  ASSERT_TRUE(s.IntersectsSegment(Segment(Point(500000.25, 4000100.25),
+                                          Point(500100.75, 4000000.5)),
+                                  &out));
+  EXPECT_EQ(Point(500050.5, 4000050.375), out);
+  EXPECT_FALSE(s.IntersectsSegment(Segment(Point(500100.75, 4000100.375),
+                                           Point(500200, 4000200)),
+                                   &out));
+}
+
+TEST(SegmentTest, IntersectsSegment_AxisParallel) {
+  Segment horizontal(Point(0.29247491536339665, 0.36411977403757267),
+                     Point(0.34637618219481703, 0.36411977403757267));
+  Segment vertical(Point(0.29450657340000019, 0.29576294402681413),
+                   Point(0.29450657340000019, 0.39489644903253529));
+  Point out;
+  ASSERT_TRUE(horizontal.IntersectsSegment(vertical, &out));
+  EXPECT_EQ(Point(0.29450657340000019, 0.36411977403757267), out);
+  ASSERT_TRUE(vertical.IntersectsSegment(horizontal, &out));
+  EXPECT_EQ(Point(0.29450657340000019, 0.36411977403757267), out);
+}
+
+TEST(SegmentTest, IntegerCoordinates) {
+  using Segment32 = BasicSegment<int32_t>;
+  using Point32 = BasicPoint<int32_t>;
+  Segment32 s(Point32(2000000000, -2000000000),
+              Point32(-2000000000, 2000000000));
+  EXPECT_EQ(Point32(-2000000000, 2000000000), s.endpoint(0));
   Point out;
-  EXPECT_FALSE(s.IntersectsSegment(Segment(Point(0.3, 0.3), Point(0.1, 0.5)), &out));
-  ASSERT_TRUE(s.IntersectsSegment(Segment(Point(0.4, 0.4), Point(0.2, 0.6)), &out));
-  EXPECT_TRUE(Near(Point(0.3, 0.5), out));
-  ASSERT_TRUE(s.IntersectsSegment(Segment(Point(0.5, 0.5), Point(0.3, 0.7)), &out));
-  EXPECT_TRUE(Near(Point(0.4, 0.6), out));
-  ASSERT_TRUE(s.IntersectsSegment(Segment(Point(0.6, 0.6), Point(0.4, 0.8)), &out));
-  EXPECT_TRUE(Near(Point(0.5, 0.7), out));
-  EXPECT_FALSE(s.IntersectsSegment(Segment(Point(0.7, 0.7), Point(0.5, 0.9)), &out));
+  ASSERT_TRUE(s.IntersectsSegment(Segment32(Point32(-2000000000, -2000000000),
+                                            Point32(2000000000, 2000000000)),
+                                  &out));
+  EXPECT_EQ(Point(0, 0), out);
+  // Parallel, one unit away.
+  EXPECT_FALSE(s.IntersectsSegment(Segment32(Point32(1999999999, -1999999998),
+                                              Point32(2000000000, -1999999999)),
+                                   &out));
+  EXPECT_TRUE(s.as_directed_line().PointLiesToLeft(
+      Point32(1999999999, -1999999998)));
+
+  BasicPolygon<int32_t> polygon{{0, 0}, {1, 0}, {0, 1}};
+  EXPECT_EQ(polygon, (BasicPolygon<int32_t>{{1, 0}, {0, 1}, {0, 0}}));
 }
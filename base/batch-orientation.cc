@@ -0,0 +1,442 @@
+#include "base/batch-orientation.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include "base/predicates.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_INTRINSICS 1
+#endif
+
+using predicates_internal::kOrientationErrorBound;
+
+// The vector kernels load points as pairs of doubles.
+static_assert(sizeof(Point) == 2 * sizeof(double), "Point must be packed");
+
+namespace batch_orientation_internal {
+
+namespace {
+
+// Every kernel evaluates the determinant exactly as Orientation does,
+//   left = (x2 - x1) * (y3 - y1), right = (y2 - y1) * (x3 - x1),
+// and decides the sign of left - right when it exceeds the error bound.
+
+size_t CountLeftScalar(const double* xs, const double* ys, size_t n,
+                       Point p1, Point p2) {
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) {
+    count += Orientation(p1, p2, Point(xs[i], ys[i])) > 0;
+  }
+  return count;
+}
+
+void ClassifyScalar(const double* xs, const double* ys, size_t n,
+                    Point p1, Point p2, signed char* out) {
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = Orientation(p1, p2, Point(xs[i], ys[i]));
+  }
+}
+
+void ClassifyTurnsScalar(const double* xs1, const double* ys1,
+                         const double* xs2, const double* ys2,
+                         const double* xs3, const double* ys3,
+                         size_t n, signed char* out) {
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = Orientation(Point(xs1[i], ys1[i]),
+                         Point(xs2[i], ys2[i]),
+                         Point(xs3[i], ys3[i]));
+  }
+}
+
+void MarkInsideConvexScalar(const Point* points, size_t n,
+                            const Point* polygon, size_t m,
+                            signed char* out) {
+  for (size_t i = 0; i < n; ++i) {
+    bool inside = m >= 3;
+    for (size_t j = 0; j < m; ++j) {
+      Point a = polygon[j];
+      Point b = polygon[j + 1 == m ? 0 : j + 1];
+      double left = (b.x - a.x) * (points[i].y - a.y);
+      double right = (b.y - a.y) * (points[i].x - a.x);
+      inside &= left - right
+          > kOrientationErrorBound * (std::fabs(left) + std::fabs(right));
+    }
+    out[i] = inside;
+  }
+}
+
+#ifdef HAVE_X86_INTRINSICS
+
+// The filtered orientation of two lanes. Sets *left and *right to the lanes
+// whose sign the filter decides and returns the mask of undecided lanes.
+inline int FilterSse2(__m128d dx, __m128d dy, __m128d ex, __m128d ey,
+                      __m128d error_bound, __m128d* left, __m128d* right) {
+  __m128d sign = _mm_set1_pd(-0.0);
+  __m128d l = _mm_mul_pd(dx, ey);
+  __m128d r = _mm_mul_pd(dy, ex);
+  __m128d det = _mm_sub_pd(l, r);
+  __m128d bound = _mm_mul_pd(error_bound,
+                             _mm_add_pd(_mm_andnot_pd(sign, l),
+                                        _mm_andnot_pd(sign, r)));
+  *left = _mm_cmpgt_pd(det, bound);
+  *right = _mm_cmplt_pd(det, _mm_xor_pd(bound, sign));
+  return _mm_movemask_pd(_mm_or_pd(*left, *right)) ^ 3;
+}
+
+size_t CountLeftSse2(const double* xs, const double* ys, size_t n,
+                     Point p1, Point p2) {
+  __m128d x1 = _mm_set1_pd(p1.x);
+  __m128d y1 = _mm_set1_pd(p1.y);
+  __m128d dx = _mm_set1_pd(p2.x - p1.x);
+  __m128d dy = _mm_set1_pd(p2.y - p1.y);
+  __m128d error_bound = _mm_set1_pd(kOrientationErrorBound);
+  // Matching lanes of a comparison are all ones, that is -1 as an integer,
+  // so subtracting the comparison counts them.
+  __m128i counts = _mm_setzero_si128();
+  size_t exact = 0;
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d left, right;
+    int undecided = FilterSse2(dx, dy,
+                               _mm_sub_pd(_mm_loadu_pd(xs + i), x1),
+                               _mm_sub_pd(_mm_loadu_pd(ys + i), y1),
+                               error_bound, &left, &right);
+    counts = _mm_sub_epi64(counts, _mm_castpd_si128(left));
+    if (undecided) {
+      for (int k = 0; k < 2; ++k) {
+        if (undecided >> k & 1) {
+          exact += Orientation(p1, p2, Point(xs[i + k], ys[i + k])) > 0;
+        }
+      }
+    }
+  }
+  alignas(16) int64_t lanes[2];
+  _mm_store_si128(reinterpret_cast<__m128i*>(lanes), counts);
+  return lanes[0] + lanes[1] + exact
+      + CountLeftScalar(xs + i, ys + i, n - i, p1, p2);
+}
+
+void ClassifySse2(const double* xs, const double* ys, size_t n,
+                  Point p1, Point p2, signed char* out) {
+  __m128d x1 = _mm_set1_pd(p1.x);
+  __m128d y1 = _mm_set1_pd(p1.y);
+  __m128d dx = _mm_set1_pd(p2.x - p1.x);
+  __m128d dy = _mm_set1_pd(p2.y - p1.y);
+  __m128d error_bound = _mm_set1_pd(kOrientationErrorBound);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d left, right;
+    int undecided = FilterSse2(dx, dy,
+                               _mm_sub_pd(_mm_loadu_pd(xs + i), x1),
+                               _mm_sub_pd(_mm_loadu_pd(ys + i), y1),
+                               error_bound, &left, &right);
+    int l = _mm_movemask_pd(left);
+    int r = _mm_movemask_pd(right);
+    out[i] = (l & 1) - (r & 1);
+    out[i + 1] = (l >> 1) - (r >> 1);
+    if (undecided) {
+      ClassifyScalar(xs + i, ys + i, 2, p1, p2, out + i);
+    }
+  }
+  ClassifyScalar(xs + i, ys + i, n - i, p1, p2, out + i);
+}
+
+void ClassifyTurnsSse2(const double* xs1, const double* ys1,
+                       const double* xs2, const double* ys2,
+                       const double* xs3, const double* ys3,
+                       size_t n, signed char* out) {
+  __m128d error_bound = _mm_set1_pd(kOrientationErrorBound);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    __m128d x1 = _mm_loadu_pd(xs1 + i);
+    __m128d y1 = _mm_loadu_pd(ys1 + i);
+    __m128d left, right;
+    int undecided = FilterSse2(_mm_sub_pd(_mm_loadu_pd(xs2 + i), x1),
+                               _mm_sub_pd(_mm_loadu_pd(ys2 + i), y1),
+                               _mm_sub_pd(_mm_loadu_pd(xs3 + i), x1),
+                               _mm_sub_pd(_mm_loadu_pd(ys3 + i), y1),
+                               error_bound, &left, &right);
+    int l = _mm_movemask_pd(left);
+    int r = _mm_movemask_pd(right);
+    out[i] = (l & 1) - (r & 1);
+    out[i + 1] = (l >> 1) - (r >> 1);
+    if (undecided) {
+      ClassifyTurnsScalar(xs1 + i, ys1 + i, xs2 + i, ys2 + i, xs3 + i, ys3 + i,
+                          2, out + i);
+    }
+  }
+  ClassifyTurnsScalar(xs1 + i, ys1 + i, xs2 + i, ys2 + i, xs3 + i, ys3 + i,
+                      n - i, out + i);
+}
+
+void MarkInsideConvexSse2(const Point* points, size_t n,
+                          const Point* polygon, size_t m,
+                          signed char* out) {
+  if (m < 3) {
+    MarkInsideConvexScalar(points, n, polygon, m, out);
+    return;
+  }
+  __m128d error_bound = _mm_set1_pd(kOrientationErrorBound);
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    // Two points are x0 y0 x1 y1 in memory.
+    __m128d p0 = _mm_loadu_pd(&points[i].x);
+    __m128d p1 = _mm_loadu_pd(&points[i + 1].x);
+    __m128d x = _mm_unpacklo_pd(p0, p1);
+    __m128d y = _mm_unpackhi_pd(p0, p1);
+    __m128d inside = _mm_castsi128_pd(_mm_set1_epi32(-1));
+    for (size_t j = 0; j < m; ++j) {
+      Point a = polygon[j];
+      Point b = polygon[j + 1 == m ? 0 : j + 1];
+      __m128d left, right;
+      FilterSse2(_mm_set1_pd(b.x - a.x), _mm_set1_pd(b.y - a.y),
+                 _mm_sub_pd(x, _mm_set1_pd(a.x)),
+                 _mm_sub_pd(y, _mm_set1_pd(a.y)),
+                 error_bound, &left, &right);
+      inside = _mm_and_pd(inside, left);
+    }
+    int mask = _mm_movemask_pd(inside);
+    out[i] = mask & 1;
+    out[i + 1] = mask >> 1;
+  }
+  MarkInsideConvexScalar(points + i, n - i, polygon, m, out + i);
+}
+
+// The AVX2 counterpart of FilterSse2, for four lanes.
+__attribute__((target("avx2")))
+inline int FilterAvx2(__m256d dx, __m256d dy, __m256d ex, __m256d ey,
+                      __m256d error_bound, __m256d* left, __m256d* right) {
+  __m256d sign = _mm256_set1_pd(-0.0);
+  __m256d l = _mm256_mul_pd(dx, ey);
+  __m256d r = _mm256_mul_pd(dy, ex);
+  __m256d det = _mm256_sub_pd(l, r);
+  __m256d bound = _mm256_mul_pd(error_bound,
+                                _mm256_add_pd(_mm256_andnot_pd(sign, l),
+                                              _mm256_andnot_pd(sign, r)));
+  *left = _mm256_cmp_pd(det, bound, _CMP_GT_OQ);
+  *right = _mm256_cmp_pd(det, _mm256_xor_pd(bound, sign), _CMP_LT_OQ);
+  return _mm256_movemask_pd(_mm256_or_pd(*left, *right)) ^ 15;
+}
+
+__attribute__((target("avx2")))
+size_t CountLeftAvx2(const double* xs, const double* ys, size_t n,
+                     Point p1, Point p2) {
+  __m256d x1 = _mm256_set1_pd(p1.x);
+  __m256d y1 = _mm256_set1_pd(p1.y);
+  __m256d dx = _mm256_set1_pd(p2.x - p1.x);
+  __m256d dy = _mm256_set1_pd(p2.y - p1.y);
+  __m256d error_bound = _mm256_set1_pd(kOrientationErrorBound);
+  __m256i counts = _mm256_setzero_si256();
+  size_t exact = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d left, right;
+    int undecided = FilterAvx2(dx, dy,
+                               _mm256_sub_pd(_mm256_loadu_pd(xs + i), x1),
+                               _mm256_sub_pd(_mm256_loadu_pd(ys + i), y1),
+                               error_bound, &left, &right);
+    counts = _mm256_sub_epi64(counts, _mm256_castpd_si256(left));
+    if (undecided) {
+      for (int k = 0; k < 4; ++k) {
+        if (undecided >> k & 1) {
+          exact += Orientation(p1, p2, Point(xs[i + k], ys[i + k])) > 0;
+        }
+      }
+    }
+  }
+  alignas(32) int64_t lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), counts);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + exact
+      + CountLeftScalar(xs + i, ys + i, n - i, p1, p2);
+}
+
+__attribute__((target("avx2")))
+void ClassifyAvx2(const double* xs, const double* ys, size_t n,
+                  Point p1, Point p2, signed char* out) {
+  __m256d x1 = _mm256_set1_pd(p1.x);
+  __m256d y1 = _mm256_set1_pd(p1.y);
+  __m256d dx = _mm256_set1_pd(p2.x - p1.x);
+  __m256d dy = _mm256_set1_pd(p2.y - p1.y);
+  __m256d error_bound = _mm256_set1_pd(kOrientationErrorBound);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d left, right;
+    int undecided = FilterAvx2(dx, dy,
+                               _mm256_sub_pd(_mm256_loadu_pd(xs + i), x1),
+                               _mm256_sub_pd(_mm256_loadu_pd(ys + i), y1),
+                               error_bound, &left, &right);
+    int l = _mm256_movemask_pd(left);
+    int r = _mm256_movemask_pd(right);
+    for (int k = 0; k < 4; ++k) {
+      out[i + k] = ((l >> k) & 1) - ((r >> k) & 1);
+    }
+    if (undecided) {
+      ClassifyScalar(xs + i, ys + i, 4, p1, p2, out + i);
+    }
+  }
+  ClassifyScalar(xs + i, ys + i, n - i, p1, p2, out + i);
+}
+
+__attribute__((target("avx2")))
+void ClassifyTurnsAvx2(const double* xs1, const double* ys1,
+                       const double* xs2, const double* ys2,
+                       const double* xs3, const double* ys3,
+                       size_t n, signed char* out) {
+  __m256d error_bound = _mm256_set1_pd(kOrientationErrorBound);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m256d x1 = _mm256_loadu_pd(xs1 + i);
+    __m256d y1 = _mm256_loadu_pd(ys1 + i);
+    __m256d left, right;
+    int undecided = FilterAvx2(_mm256_sub_pd(_mm256_loadu_pd(xs2 + i), x1),
+                               _mm256_sub_pd(_mm256_loadu_pd(ys2 + i), y1),
+                               _mm256_sub_pd(_mm256_loadu_pd(xs3 + i), x1),
+                               _mm256_sub_pd(_mm256_loadu_pd(ys3 + i), y1),
+                               error_bound, &left, &right);
+    int l = _mm256_movemask_pd(left);
+    int r = _mm256_movemask_pd(right);
+    for (int k = 0; k < 4; ++k) {
+      out[i + k] = ((l >> k) & 1) - ((r >> k) & 1);
+    }
+    if (undecided) {
+      ClassifyTurnsScalar(xs1 + i, ys1 + i, xs2 + i, ys2 + i, xs3 + i, ys3 + i,
+                          4, out + i);
+    }
+  }
+  ClassifyTurnsScalar(xs1 + i, ys1 + i, xs2 + i, ys2 + i, xs3 + i, ys3 + i,
+                      n - i, out + i);
+}
+
+__attribute__((target("avx2")))
+void MarkInsideConvexAvx2(const Point* points, size_t n,
+                          const Point* polygon, size_t m,
+                          signed char* out) {
+  if (m < 3) {
+    MarkInsideConvexScalar(points, n, polygon, m, out);
+    return;
+  }
+  __m256d error_bound = _mm256_set1_pd(kOrientationErrorBound);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    // Four points are x0 y0 x1 y1 and x2 y2 x3 y3 in memory; unpacking puts
+    // them in lanes 0, 2, 1, 3.
+    __m256d p01 = _mm256_loadu_pd(&points[i].x);
+    __m256d p23 = _mm256_loadu_pd(&points[i + 2].x);
+    __m256d x = _mm256_unpacklo_pd(p01, p23);
+    __m256d y = _mm256_unpackhi_pd(p01, p23);
+    __m256d inside = _mm256_castsi256_pd(_mm256_set1_epi32(-1));
+    for (size_t j = 0; j < m; ++j) {
+      Point a = polygon[j];
+      Point b = polygon[j + 1 == m ? 0 : j + 1];
+      __m256d left, right;
+      FilterAvx2(_mm256_set1_pd(b.x - a.x), _mm256_set1_pd(b.y - a.y),
+                 _mm256_sub_pd(x, _mm256_set1_pd(a.x)),
+                 _mm256_sub_pd(y, _mm256_set1_pd(a.y)),
+                 error_bound, &left, &right);
+      inside = _mm256_and_pd(inside, left);
+    }
+    int mask = _mm256_movemask_pd(inside);
+    out[i] = mask & 1;
+    out[i + 1] = (mask >> 2) & 1;
+    out[i + 2] = (mask >> 1) & 1;
+    out[i + 3] = mask >> 3;
+  }
+  // GCC does not always clear the upper halves of the registers before the
+  // tail call, and SSE code running with them dirty is much slower.
+  _mm256_zeroupper();
+  MarkInsideConvexScalar(points + i, n - i, polygon, m, out + i);
+}
+
+#endif  // HAVE_X86_INTRINSICS
+
+const Kernels& SelectKernels() {
+  if (const Kernels* kernels = Avx2Kernels()) {
+    return *kernels;
+  }
+  if (const Kernels* kernels = Sse2Kernels()) {
+    return *kernels;
+  }
+  return ScalarKernels();
+}
+
+const Kernels& SelectedKernels() {
+  static const Kernels& kernels = SelectKernels();
+  return kernels;
+}
+
+}  // namespace
+
+const Kernels& ScalarKernels() {
+  static const Kernels kernels = {
+    CountLeftScalar, ClassifyScalar, ClassifyTurnsScalar,
+    MarkInsideConvexScalar, "scalar",
+  };
+  return kernels;
+}
+
+const Kernels* Sse2Kernels() {
+#ifdef HAVE_X86_INTRINSICS
+  static const Kernels kernels = {
+    CountLeftSse2, ClassifySse2, ClassifyTurnsSse2, MarkInsideConvexSse2,
+    "sse2",
+  };
+  return __builtin_cpu_supports("sse2") ? &kernels : nullptr;
+#else
+  return nullptr;
+#endif
+}
+
+const Kernels* Avx2Kernels() {
+#ifdef HAVE_X86_INTRINSICS
+  static const Kernels kernels = {
+    CountLeftAvx2, ClassifyAvx2, ClassifyTurnsAvx2, MarkInsideConvexAvx2,
+    "avx2",
+  };
+  return __builtin_cpu_supports("avx2") ? &kernels : nullptr;
+#else
+  return nullptr;
+#endif
+}
+
+}  // namespace batch_orientation_internal
+
+using batch_orientation_internal::SelectedKernels;
+
+size_t CountPointsLeftOfLine(Point p1, Point p2, const PointBuffer& points) {
+  return SelectedKernels().count_left(points.xs(), points.ys(), points.size(),
+                                      p1, p2);
+}
+
+void ClassifyPointsAgainstLine(Point p1,
+                               Point p2,
+                               const PointBuffer& points,
+                               signed char* out) {
+  SelectedKernels().classify(points.xs(), points.ys(), points.size(),
+                             p1, p2, out);
+}
+
+void ClassifyTurns(const PointBuffer& p1,
+                   const PointBuffer& p2,
+                   const PointBuffer& p3,
+                   signed char* out) {
+  assert(p1.size() == p2.size() && p2.size() == p3.size());
+  SelectedKernels().classify_turns(p1.xs(), p1.ys(),
+                                   p2.xs(), p2.ys(),
+                                   p3.xs(), p3.ys(),
+                                   p1.size(), out);
+}
+
+void MarkPointsInsideConvexPolygon(const Point* points,
+                                   size_t num_points,
+                                   const Point* polygon,
+                                   size_t num_vertices,
+                                   signed char* out) {
+  SelectedKernels().mark_inside_convex(points, num_points,
+                                       polygon, num_vertices, out);
+}
+
+const char* BatchOrientationInstructionSet() {
+  return SelectedKernels().name;
+}
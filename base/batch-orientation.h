@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include "base/base.h"
+#include "base/point-buffer.h"
+
+// Orientation predicates evaluated over many points at once. They give the
+// same exact answers as DirectedLine::PointLiesToLeft/Right and
+// PointsMakesLeftTurn/RightTurn, using AVX2 or SSE2 when the CPU supports it.
+// The floating-point filter of Orientation runs vectorized; the few points it
+// cannot decide are passed to the exact predicate one at a time. The
+// instruction set is picked once at run time.
+
+// The number of points lying to the left of the directed line from p1 to p2.
+size_t CountPointsLeftOfLine(Point p1, Point p2, const PointBuffer& points);
+
+// Sets out[i] to 1 if the i-th point lies to the left of the directed line
+// from p1 to p2, -1 if it lies to the right and 0 otherwise.
+void ClassifyPointsAgainstLine(Point p1,
+                               Point p2,
+                               const PointBuffer& points,
+                               signed char* out);
+
+// Sets out[i] to 1 if p1[i], p2[i], p3[i] make a left turn, -1 if they make a
+// right turn and 0 otherwise. The three buffers must have the same size.
+void ClassifyTurns(const PointBuffer& p1,
+                   const PointBuffer& p2,
+                   const PointBuffer& p3,
+                   signed char* out);
+
+// Sets out[i] to 1 if points[i] lies strictly inside the convex polygon with
+// the given counterclockwise vertices and the floating-point filter alone can
+// tell, and to 0 otherwise. Points marked 1 are certainly inside; points very
+// close to the boundary are conservatively marked 0. The polygon must not
+// repeat consecutive vertices.
+void MarkPointsInsideConvexPolygon(const Point* points,
+                                   size_t num_points,
+                                   const Point* polygon,
+                                   size_t num_vertices,
+                                   signed char* out);
+
+// "avx2", "sse2" or "scalar".
+const char* BatchOrientationInstructionSet();
+
+namespace batch_orientation_internal {
+
+// The kernels behind the functions above, one set per instruction set. The
+// SSE2 and AVX2 kernels may only be called where the CPU supports them.
+struct Kernels {
+  size_t (*count_left)(const double* xs, const double* ys, size_t n,
+                       Point p1, Point p2);
+  void (*classify)(const double* xs, const double* ys, size_t n,
+                   Point p1, Point p2, signed char* out);
+  void (*classify_turns)(const double* xs1, const double* ys1,
+                         const double* xs2, const double* ys2,
+                         const double* xs3, const double* ys3,
+                         size_t n, signed char* out);
+  void (*mark_inside_convex)(const Point* points, size_t n,
+                             const Point* polygon, size_t m,
+                             signed char* out);
+  const char* name;
+};
+
+const Kernels& ScalarKernels();
+// Null where the instruction set is not available.
+const Kernels* Sse2Kernels();
+const Kernels* Avx2Kernels();
+
+}  // namespace batch_orientation_internal
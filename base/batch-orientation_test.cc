@@ -0,0 +1,150 @@
+#include "base/batch-orientation.h"
+
+#include <vector>
+#include "base/workload.h"
+#include "gtest/gtest.h"
+
+using batch_orientation_internal::Avx2Kernels;
+using batch_orientation_internal::Kernels;
+using batch_orientation_internal::ScalarKernels;
+using batch_orientation_internal::Sse2Kernels;
+using std::vector;
+
+namespace {
+
+vector<const Kernels*> AvailableKernels() {
+  vector<const Kernels*> kernels{&ScalarKernels()};
+  if (Sse2Kernels()) {
+    kernels.push_back(Sse2Kernels());
+  }
+  if (Avx2Kernels()) {
+    kernels.push_back(Avx2Kernels());
+  }
+  return kernels;
+}
+
+// Lines through lattice points, so that many of the degenerate points lie
+// exactly on them, and a line so close to the diagonal that the filter cannot
+// decide the lattice points on it.
+vector<std::pair<Point, Point>> TestLines() {
+  return {
+    {Point(0, 0), Point(1, 1)},
+    {Point(1, 1), Point(0, 0)},
+    {Point(0, 0.5), Point(1, 0.5)},
+    {Point(0.25, 0), Point(0.25, 1)},
+    {Point(0.1, 0.7), Point(0.9, 0.2)},
+    {Point(0.5, 0.50000000000000011), Point(12, 12)},
+  };
+}
+
+}  // namespace
+
+TEST(BatchOrientationTest, PointsAgainstLine) {
+  for (auto distribution : {UNIFORM_SQUARE, DEGENERATE}) {
+    // An odd size exercises the scalar tails of the vector kernels.
+    vector<Point> points = RandomPoints(distribution, 1001, 5);
+    PointBuffer buffer(points);
+    for (auto line_points : TestLines()) {
+      DirectedLine line(line_points.first, line_points.second);
+      vector<signed char> expected;
+      size_t expected_left = 0;
+      for (Point p : points) {
+        expected.push_back(line.PointLiesToLeft(p) - line.PointLiesToRight(p));
+        expected_left += line.PointLiesToLeft(p);
+      }
+
+      vector<signed char> actual(points.size());
+      ClassifyPointsAgainstLine(line_points.first, line_points.second,
+                                buffer, actual.data());
+      EXPECT_EQ(expected, actual);
+      EXPECT_EQ(expected_left,
+                CountPointsLeftOfLine(line_points.first, line_points.second,
+                                      buffer));
+
+      for (const Kernels* kernels : AvailableKernels()) {
+        vector<signed char> actual(points.size());
+        kernels->classify(buffer.xs(), buffer.ys(), buffer.size(),
+                          line_points.first, line_points.second,
+                          actual.data());
+        EXPECT_EQ(expected, actual) << kernels->name;
+        EXPECT_EQ(expected_left,
+                  kernels->count_left(buffer.xs(), buffer.ys(), buffer.size(),
+                                      line_points.first, line_points.second))
+            << kernels->name;
+      }
+    }
+  }
+}
+
+TEST(BatchOrientationTest, Turns) {
+  for (auto distribution : {UNIFORM_SQUARE, DEGENERATE}) {
+    vector<Point> points = RandomPoints(distribution, 3 * 333, 9);
+    PointBuffer p1, p2, p3;
+    vector<signed char> expected;
+    for (int i = 0; i < points.size(); i += 3) {
+      p1.push_back(points[i]);
+      p2.push_back(points[i + 1]);
+      p3.push_back(points[i + 2]);
+      expected.push_back(
+          PointsMakesLeftTurn(points[i], points[i + 1], points[i + 2])
+          - PointsMakesRightTurn(points[i], points[i + 1], points[i + 2]));
+    }
+
+    vector<signed char> actual(p1.size());
+    ClassifyTurns(p1, p2, p3, actual.data());
+    EXPECT_EQ(expected, actual);
+
+    for (const Kernels* kernels : AvailableKernels()) {
+      vector<signed char> actual(p1.size());
+      kernels->classify_turns(p1.xs(), p1.ys(), p2.xs(), p2.ys(),
+                              p3.xs(), p3.ys(), p1.size(), actual.data());
+      EXPECT_EQ(expected, actual) << kernels->name;
+    }
+  }
+}
+
+TEST(BatchOrientationTest, PointsInsideConvexPolygon) {
+  // The degenerate points include the corners and edges of the polygon.
+  vector<Point> polygon{{0.25, 0}, {1, 0.5}, {0.75, 1}, {0, 0.75}};
+  for (auto distribution : {UNIFORM_SQUARE, DEGENERATE}) {
+    vector<Point> points = RandomPoints(distribution, 1001, 13);
+    vector<signed char> expected(points.size());
+    MarkPointsInsideConvexPolygon(points.data(), points.size(),
+                                  polygon.data(), polygon.size(),
+                                  expected.data());
+    size_t num_inside = 0;
+    for (int i = 0; i < points.size(); ++i) {
+      bool inside = true;
+      for (int j = 0; j < polygon.size(); ++j) {
+        inside &= PointsMakesLeftTurn(polygon[j],
+                                      polygon[(j + 1) % polygon.size()],
+                                      points[i]);
+      }
+      // Marked points are certainly inside; the filter decides all of these
+      // points, none of which is very close to an edge without being on it.
+      EXPECT_EQ(inside, expected[i]) << points[i];
+      num_inside += inside;
+    }
+    EXPECT_GT(num_inside, 0);
+
+    for (const Kernels* kernels : AvailableKernels()) {
+      vector<signed char> actual(points.size());
+      kernels->mark_inside_convex(points.data(), points.size(),
+                                  polygon.data(), polygon.size(),
+                                  actual.data());
+      EXPECT_EQ(expected, actual) << kernels->name;
+    }
+  }
+}
+
+TEST(PointBufferTest, Layout) {
+  PointBuffer buffer({{1, 2}, {3, 4}, {5, 6}});
+  ASSERT_EQ(3, buffer.size());
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(buffer.xs())
+            % PointBuffer::kAlignment);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(buffer.ys())
+            % PointBuffer::kAlignment);
+  EXPECT_EQ(3, buffer.xs()[1]);
+  EXPECT_EQ(4, buffer.ys()[1]);
+  EXPECT_EQ(Point(5, 6), buffer.point(2));
+}
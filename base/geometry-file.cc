@@ -0,0 +1,190 @@
+#include "base/geometry-file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+using std::string;
+
+namespace {
+
+static_assert(sizeof(Point) == 2 * sizeof(double)
+                  && std::is_trivially_copyable<Point>::value,
+              "Points must be two packed doubles to be mapped");
+static_assert(sizeof(Segment) == 2 * sizeof(Point)
+                  && std::is_trivially_copyable<Segment>::value,
+              "Segments must be two packed points to be mapped");
+
+const char kMagic[4] = {'G', 'E', 'O', 'B'};
+
+struct Header {
+  char magic[4];
+  uint32_t version;
+  uint32_t kind;
+  uint32_t reserved;
+  uint64_t num_records;
+};
+
+static_assert(sizeof(Header) == 24, "The header must have no padding");
+
+bool IsLittleEndian() {
+  const uint32_t one = 1;
+  unsigned char first_byte;
+  memcpy(&first_byte, &one, 1);
+  return first_byte == 1;
+}
+
+size_t RecordSize(uint32_t kind) {
+  switch (kind) {
+    case POINT_FILE:
+      return sizeof(Point);
+    case SEGMENT_FILE:
+      return sizeof(Segment);
+  }
+  return 0;
+}
+
+bool Fail(const string& message, string* error) {
+  if (error) {
+    *error = message;
+  }
+  return false;
+}
+
+bool Write(const string& path, GeometryFileKind kind, const void* records,
+           size_t num_records, string* error) {
+  if (!IsLittleEndian()) {
+    return Fail("geometry files need a little-endian host", error);
+  }
+  Header header;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kGeometryFileVersion;
+  header.kind = kind;
+  header.reserved = 0;
+  header.num_records = num_records;
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(static_cast<const char*>(records),
+            num_records * RecordSize(kind));
+  out.close();
+  if (!out) {
+    return Fail(path + ": write failed", error);
+  }
+  return true;
+}
+
+}  // namespace
+
+bool WritePointFile(const string& path, Span<const Point> points,
+                    string* error) {
+  return Write(path, POINT_FILE, points.data(), points.size(), error);
+}
+
+bool WriteSegmentFile(const string& path, Span<const Segment> segments,
+                      string* error) {
+  return Write(path, SEGMENT_FILE, segments.data(), segments.size(), error);
+}
+
+MappedGeometryFile::MappedGeometryFile()
+    : mapping_(nullptr), mapping_size_(0), kind_(POINT_FILE),
+      num_records_(0) {}
+
+MappedGeometryFile::~MappedGeometryFile() {
+  Close();
+}
+
+bool MappedGeometryFile::Open(const string& path, string* error) {
+  Close();
+  if (!IsLittleEndian()) {
+    return Fail("geometry files need a little-endian host", error);
+  }
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return Fail(path + ": " + strerror(errno), error);
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0) {
+    int saved_errno = errno;
+    close(fd);
+    return Fail(path + ": " + strerror(saved_errno), error);
+  }
+  size_t size = status.st_size;
+  if (size < sizeof(Header)) {
+    close(fd);
+    return Fail(path + ": too short for a geometry file header", error);
+  }
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  int saved_errno = errno;
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return Fail(path + ": " + strerror(saved_errno), error);
+  }
+  mapping_ = mapping;
+  mapping_size_ = size;
+
+  Header header;
+  memcpy(&header, mapping_, sizeof(header));
+  string problem;
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    problem = "not a geometry file";
+  } else if (header.version != kGeometryFileVersion) {
+    problem = "unsupported version " + std::to_string(header.version);
+  } else if (RecordSize(header.kind) == 0) {
+    problem = "unknown kind " + std::to_string(header.kind);
+  } else if ((size - sizeof(Header)) / RecordSize(header.kind)
+                 != header.num_records
+             || (size - sizeof(Header)) % RecordSize(header.kind) != 0) {
+    problem = "the file size does not match the number of records";
+  }
+  if (problem.empty()) {
+    kind_ = static_cast<GeometryFileKind>(header.kind);
+    num_records_ = header.num_records;
+    for (const Segment& s : segments()) {
+      if (s.endpoint(1) < s.endpoint(0)) {
+        problem = "segment endpoints are out of order";
+        break;
+      }
+    }
+  }
+  if (!problem.empty()) {
+    Close();
+    return Fail(path + ": " + problem, error);
+  }
+  return true;
+}
+
+void MappedGeometryFile::Close() {
+  if (mapping_) {
+    munmap(mapping_, mapping_size_);
+  }
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+  kind_ = POINT_FILE;
+  num_records_ = 0;
+}
+
+Span<const Point> MappedGeometryFile::points() const {
+  if (!mapping_ || kind_ != POINT_FILE) {
+    return Span<const Point>();
+  }
+  return Span<const Point>(
+      reinterpret_cast<const Point*>(
+          static_cast<const char*>(mapping_) + sizeof(Header)),
+      num_records_);
+}
+
+Span<const Segment> MappedGeometryFile::segments() const {
+  if (!mapping_ || kind_ != SEGMENT_FILE) {
+    return Span<const Segment>();
+  }
+  return Span<const Segment>(
+      reinterpret_cast<const Segment*>(
+          static_cast<const char*>(mapping_) + sizeof(Header)),
+      num_records_);
+}
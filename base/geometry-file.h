@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "base/base.h"
+#include "base/span.h"
+
+// A binary file format for point clouds and segment layers, which can be
+// mapped into memory and handed to the algorithms without parsing or
+// copying. A file is a 24-byte header followed by packed records:
+//
+//   offset  0: the magic bytes "GEOB"
+//   offset  4: uint32 format version, currently 1
+//   offset  8: uint32 GeometryFileKind
+//   offset 12: uint32 zero, reserved
+//   offset 16: uint64 number of records
+//   offset 24: the records, x and y as little-endian IEEE doubles: x, y for
+//              points and x0, y0, x1, y1 for segments, whose endpoints are
+//              sorted lexicographically as in Segment
+//
+// The records start at an offset that is a multiple of 8, so that the
+// mapped records can be read as Points and Segments in place. Only
+// little-endian hosts are supported.
+
+enum GeometryFileKind : uint32_t {
+  POINT_FILE = 1,
+  SEGMENT_FILE = 2,
+};
+
+const uint32_t kGeometryFileVersion = 1;
+
+// Write the records to path, replacing the file. Return false and describe
+// the failure in error unless it is null.
+bool WritePointFile(const std::string& path, Span<const Point> points,
+                    std::string* error);
+bool WriteSegmentFile(const std::string& path, Span<const Segment> segments,
+                      std::string* error);
+
+// A geometry file mapped read-only into memory. The spans point into the
+// mapping and are valid until the file is closed or destroyed. Pages are
+// read from disk as they are first touched.
+class MappedGeometryFile {
+ public:
+  MappedGeometryFile();
+  ~MappedGeometryFile();
+  MappedGeometryFile(const MappedGeometryFile&) = delete;
+  MappedGeometryFile& operator=(const MappedGeometryFile&) = delete;
+
+  // Maps the file at path, closing the file mapped before. The header and
+  // the file size are checked, and so is the order of segment endpoints,
+  // which reads the whole of a segment file. Returns false and describes the
+  // failure in error unless it is null.
+  bool Open(const std::string& path, std::string* error);
+  void Close();
+
+  bool is_open() const { return mapping_ != nullptr; }
+  GeometryFileKind kind() const { return kind_; }
+
+  // Empty unless the file is of that kind.
+  Span<const Point> points() const;
+  Span<const Segment> segments() const;
+
+ private:
+  void* mapping_;
+  size_t mapping_size_;
+  GeometryFileKind kind_;
+  size_t num_records_;
+};
@@ -0,0 +1,110 @@
+#include "base/geometry-file.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "base/workload.h"
+#include "gtest/gtest.h"
+
+using std::string;
+using std::vector;
+
+namespace {
+
+string TempPath(const string& name) {
+  const char* dir = getenv("TEST_TMPDIR");
+  return string(dir ? dir : "/tmp") + "/" + name;
+}
+
+TEST(GeometryFileTest, Points) {
+  vector<Point> points = RandomPoints(UNIFORM_SQUARE, 1000, 1);
+  string path = TempPath("points.geob");
+  string error;
+  ASSERT_TRUE(WritePointFile(path, points, &error)) << error;
+
+  MappedGeometryFile file;
+  ASSERT_TRUE(file.Open(path, &error)) << error;
+  EXPECT_TRUE(file.is_open());
+  EXPECT_EQ(POINT_FILE, file.kind());
+  EXPECT_TRUE(file.segments().empty());
+  EXPECT_EQ(points, vector<Point>(file.points().begin(),
+                                  file.points().end()));
+  file.Close();
+  EXPECT_FALSE(file.is_open());
+  EXPECT_TRUE(file.points().empty());
+}
+
+TEST(GeometryFileTest, Segments) {
+  vector<Segment> segments = RandomSegments(SHORT_SEGMENTS, 1000, 1);
+  string path = TempPath("segments.geob");
+  string error;
+  ASSERT_TRUE(WriteSegmentFile(path, segments, &error)) << error;
+
+  MappedGeometryFile file;
+  ASSERT_TRUE(file.Open(path, &error)) << error;
+  EXPECT_EQ(SEGMENT_FILE, file.kind());
+  EXPECT_TRUE(file.points().empty());
+  ASSERT_EQ(segments.size(), file.segments().size());
+  for (size_t i = 0; i < segments.size(); ++i) {
+    EXPECT_EQ(segments[i].endpoints(), file.segments()[i].endpoints());
+  }
+}
+
+TEST(GeometryFileTest, Empty) {
+  string path = TempPath("empty.geob");
+  string error;
+  ASSERT_TRUE(WritePointFile(path, Span<const Point>(), &error)) << error;
+  MappedGeometryFile file;
+  ASSERT_TRUE(file.Open(path, &error)) << error;
+  EXPECT_TRUE(file.points().empty());
+}
+
+TEST(GeometryFileTest, Errors) {
+  MappedGeometryFile file;
+  string error;
+  EXPECT_FALSE(file.Open(TempPath("missing.geob"), &error));
+  EXPECT_NE(string::npos, error.find("missing.geob")) << error;
+
+  string path = TempPath("bad.geob");
+  vector<Point> points = RandomPoints(UNIFORM_SQUARE, 10, 1);
+  ASSERT_TRUE(WritePointFile(path, points, nullptr));
+  string contents;
+  {
+    std::ifstream in(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+  }
+  auto expect_error = [&](const string& bad, const string& message) {
+    {
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      out << bad;
+    }
+    EXPECT_FALSE(file.Open(path, &error));
+    EXPECT_NE(string::npos, error.find(message)) << error;
+    EXPECT_FALSE(file.is_open());
+  };
+  expect_error(contents.substr(0, 10), "too short");
+  expect_error("XXXX" + contents.substr(4), "not a geometry file");
+  string version = contents;
+  version[4] = 2;
+  expect_error(version, "unsupported version 2");
+  string kind = contents;
+  kind[8] = 7;
+  expect_error(kind, "unknown kind 7");
+  expect_error(contents.substr(0, contents.size() - 1), "file size");
+
+  // Endpoints written in the wrong order.
+  vector<Point> swapped = {Point(1, 1), Point(0, 0)};
+  ASSERT_TRUE(WritePointFile(path, swapped, nullptr));
+  {
+    std::ifstream in(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+  }
+  contents[8] = SEGMENT_FILE;
+  contents[16] = 1;
+  expect_error(contents, "out of order");
+}
+
+}  // namespace
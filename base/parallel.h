@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Below this many points per thread the threads cost more than they save,
+// for loops that do a few predicates or a sort per point.
+const size_t kMinPointsPerThread = 1 << 14;
+
+// Elements sampled per slab to choose the boundaries of vertical slabs at
+// quantiles of x.
+const int kSamplesPerSlab = 64;
+
+// The threads to use for num_items items: num_threads, but at least 1 and no
+// more than give each thread min_items_per_thread items.
+inline int ClampNumThreads(int num_threads, size_t num_items,
+                           size_t min_items_per_thread) {
+  return static_cast<int>(std::max<size_t>(
+      1, std::min<size_t>(std::max(num_threads, 1),
+                          num_items / min_items_per_thread)));
+}
+
+// Runs fn(0), ..., fn(num_threads - 1) concurrently, on the calling thread
+// and num_threads - 1 new ones.
+template<class Function>
+void RunInParallel(int num_threads, const Function& fn) {
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads; ++i) {
+    threads.emplace_back(fn, i);
+  }
+  fn(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
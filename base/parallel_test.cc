@@ -0,0 +1,30 @@
+#include "base/parallel.h"
+
+#include <atomic>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(ClampNumThreadsTest, Bounds) {
+  EXPECT_EQ(4, ClampNumThreads(4, 1000, 10));
+  EXPECT_EQ(3, ClampNumThreads(8, 30, 10));
+  EXPECT_EQ(1, ClampNumThreads(8, 5, 10));
+  EXPECT_EQ(1, ClampNumThreads(0, 1000, 10));
+  EXPECT_EQ(1, ClampNumThreads(-1, 1000, 10));
+}
+
+TEST(RunInParallelTest, EveryThreadOnce) {
+  for (int num_threads : {1, 2, 5}) {
+    std::vector<std::atomic<int>> calls(num_threads);
+    for (auto& c : calls) {
+      c = 0;
+    }
+    RunInParallel(num_threads, [&](int thread) { ++calls[thread]; });
+    for (int thread = 0; thread < num_threads; ++thread) {
+      EXPECT_EQ(1, calls[thread]) << thread;
+    }
+  }
+}
+
+}  // namespace
@@ -0,0 +1,18 @@
+#include "base/point-buffer.h"
+
+PointBuffer::PointBuffer(const std::vector<Point>& points) {
+  reserve(points.size());
+  for (Point p : points) {
+    push_back(p);
+  }
+}
+
+void PointBuffer::clear() {
+  xs_.clear();
+  ys_.clear();
+}
+
+void PointBuffer::reserve(size_t n) {
+  xs_.reserve(n);
+  ys_.reserve(n);
+}
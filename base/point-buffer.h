@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "base/base.h"
+
+// Allocates memory aligned to Alignment bytes, so that vector loads from the
+// start of the allocation never straddle a cache line.
+template<class T, size_t Alignment>
+class AlignedAllocator {
+ public:
+  using value_type = T;
+
+  template<class U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() {}
+  template<class U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+  T* allocate(size_t n) {
+    void* p = nullptr;
+    if (posix_memalign(&p, Alignment, n * sizeof(T)) != 0) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(p);
+  }
+
+  void deallocate(T* p, size_t) {
+    free(p);
+  }
+};
+
+template<class T, class U, size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&) {
+  return true;
+}
+
+template<class T, class U, size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&,
+                const AlignedAllocator<U, Alignment>&) {
+  return false;
+}
+
+// Points in structure-of-arrays layout: the x coordinates and the y
+// coordinates are kept in two separate arrays aligned for 256-bit loads. This
+// is the input format of the batch predicates in base/batch-orientation.h.
+class PointBuffer {
+ public:
+  static const size_t kAlignment = 32;
+
+  PointBuffer() {}
+  explicit PointBuffer(const std::vector<Point>& points);
+
+  size_t size() const { return xs_.size(); }
+  bool empty() const { return xs_.empty(); }
+
+  const double* xs() const { return xs_.data(); }
+  const double* ys() const { return ys_.data(); }
+
+  Point point(size_t i) const { return Point(xs_[i], ys_[i]); }
+
+  void push_back(Point p) {
+    xs_.push_back(p.x);
+    ys_.push_back(p.y);
+  }
+
+  void clear();
+  void reserve(size_t n);
+
+ private:
+  std::vector<double, AlignedAllocator<double, kAlignment>> xs_;
+  std::vector<double, AlignedAllocator<double, kAlignment>> ys_;
+};
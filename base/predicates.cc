@@ -0,0 +1,155 @@
+#include "base/predicates.h"
+
+#include <cmath>
+
+namespace predicates_internal {
+
+namespace {
+
+// a + b = sum + error exactly.
+void TwoSum(double a, double b, double* sum, double* error) {
+  double s = a + b;
+  double bv = s - a;
+  double av = s - bv;
+  *sum = s;
+  *error = (a - av) + (b - bv);
+}
+
+// a - b = difference + error exactly.
+void TwoDiff(double a, double b, double* difference, double* error) {
+  double d = a - b;
+  double bv = a - d;
+  double av = d + bv;
+  *difference = d;
+  *error = (a - av) + (bv - b);
+}
+
+#ifndef FP_FAST_FMA
+// Splits a into two halves of 26 significant bits each, so that products of
+// halves are exact.
+void Split(double a, double* high, double* low) {
+  const double kSplitter = 134217729.0;  // 2^27 + 1
+  double c = kSplitter * a;
+  double big = c - a;
+  *high = c - big;
+  *low = a - *high;
+}
+#endif
+
+// a * b = product + error exactly.
+void TwoProduct(double a, double b, double* product, double* error) {
+  double p = a * b;
+  *product = p;
+#ifdef FP_FAST_FMA
+  *error = std::fma(a, b, -p);
+#else
+  double a_high, a_low, b_high, b_low;
+  Split(a, &a_high, &a_low);
+  Split(b, &b_high, &b_low);
+  *error = a_low * b_low
+      - (((p - a_high * b_high) - a_low * b_high) - a_high * b_low);
+#endif
+}
+
+// Adds b to the nonoverlapping expansion e[0..n), ordered by increasing
+// magnitude, and returns the new length. e must have room for n + 1 terms.
+int GrowExpansion(double* e, int n, double b) {
+  double q = b;
+  for (int i = 0; i < n; ++i) {
+    TwoSum(q, e[i], &q, &e[i]);
+  }
+  e[n] = q;
+  return n + 1;
+}
+
+int Sign(double v) {
+  return (v > 0) - (v < 0);
+}
+
+// The sign of a nonoverlapping expansion is that of its largest component.
+int ExpansionSign(const double* e, int n) {
+  for (int i = n - 1; i >= 0; --i) {
+    if (e[i] != 0) {
+      return Sign(e[i]);
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+bool OrientationFilterDecides(Point a, Point b, Point c) {
+  double left = (b.x - a.x) * (c.y - a.y);
+  double right = (b.y - a.y) * (c.x - a.x);
+  double det = left - right;
+  return std::fabs(det)
+      > kOrientationErrorBound * (std::fabs(left) + std::fabs(right));
+}
+
+int ExactOrientation(Point a, Point b, Point c) {
+  double bax, bay, cax, cay;
+  double bax_error, bay_error, cax_error, cay_error;
+  TwoDiff(b.x, a.x, &bax, &bax_error);
+  TwoDiff(b.y, a.y, &bay, &bay_error);
+  TwoDiff(c.x, a.x, &cax, &cax_error);
+  TwoDiff(c.y, a.y, &cay, &cay_error);
+  double expansion[12];
+  int n = 0;
+  if (bax_error == 0 && bay_error == 0 && cax_error == 0 && cay_error == 0) {
+    // The differences are exact, as they are for points on a common grid, so
+    // only the two products need to be expanded.
+    double product, error;
+    TwoProduct(bax, cay, &product, &error);
+    n = GrowExpansion(expansion, n, error);
+    n = GrowExpansion(expansion, n, product);
+    TwoProduct(-bay, cax, &product, &error);
+    n = GrowExpansion(expansion, n, error);
+    n = GrowExpansion(expansion, n, product);
+    return ExpansionSign(expansion, n);
+  }
+  // Otherwise the determinant is expanded into six products of input
+  // coordinates.
+  const double terms[6][2] = {
+    {b.x, c.y}, {-b.x, a.y}, {-a.x, c.y},
+    {-b.y, c.x}, {b.y, a.x}, {a.y, c.x},
+  };
+  for (const auto& term : terms) {
+    double product, error;
+    TwoProduct(term[0], term[1], &product, &error);
+    n = GrowExpansion(expansion, n, error);
+    n = GrowExpansion(expansion, n, product);
+  }
+  return ExpansionSign(expansion, n);
+}
+
+namespace {
+
+// y - x as a sign and a magnitude, which fits in 64 bits.
+int Difference(int64_t x, int64_t y, uint64_t* magnitude) {
+  if (y >= x) {
+    *magnitude = uint64_t(y) - uint64_t(x);
+    return y > x;
+  }
+  *magnitude = uint64_t(x) - uint64_t(y);
+  return -1;
+}
+
+}  // namespace
+
+int WideIntegerOrientation(BasicPoint<int64_t> a, BasicPoint<int64_t> b,
+                           BasicPoint<int64_t> c) {
+  uint64_t bax, bay, cax, cay;
+  int left_sign = Difference(a.x, b.x, &bax) * Difference(a.y, c.y, &cay);
+  int right_sign = Difference(a.y, b.y, &bay) * Difference(a.x, c.x, &cax);
+  if (left_sign != right_sign) {
+    // Products of different signs are ordered by their signs alone.
+    return left_sign > right_sign ? 1 : -1;
+  }
+  // Magnitudes below 2^64 have products below 2^128.
+  unsigned __int128 left = static_cast<unsigned __int128>(bax) * cay;
+  unsigned __int128 right = static_cast<unsigned __int128>(bay) * cax;
+  int magnitude_sign = (left > right) - (left < right);
+  return left_sign >= 0 ? magnitude_sign : -magnitude_sign;
+}
+
+}  // namespace predicates_internal
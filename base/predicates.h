@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include "base/base.h"
+
+// Exact geometric predicates on double coordinates. A cheap floating-point
+// filter decides almost every case; exact arithmetic is only used when the
+// rounded result is too close to zero to trust. Inputs are assumed not to
+// overflow or underflow when multiplied.
+
+// Returns 1 if a, b, c make a left (counterclockwise) turn, -1 if they make a
+// right turn and 0 if they are exactly collinear.
+int Orientation(Point a, Point b, Point c);
+
+// The same for the other coordinate types. Floats are widened to double and
+// use its predicate. Integers need no filter: differences of int32_t fit in
+// 64 bits, and so do those of int64_t below 2^62 in magnitude, and their
+// products fit in 128 bits. Larger int64_t coordinates take a slower path
+// that compares the products as signs and unsigned magnitudes, so every
+// int64_t input is exact.
+int Orientation(BasicPoint<float> a, BasicPoint<float> b, BasicPoint<float> c);
+int Orientation(BasicPoint<int32_t> a, BasicPoint<int32_t> b,
+                BasicPoint<int32_t> c);
+int Orientation(BasicPoint<int64_t> a, BasicPoint<int64_t> b,
+                BasicPoint<int64_t> c);
+
+namespace predicates_internal {
+
+// Relative error bound of the rounded orientation determinant
+// (bx - ax) * (cy - ay) - (by - ay) * (cx - ax): its sign is correct whenever
+// its magnitude is at least this times the sum of the magnitudes of the two
+// products. This is ccwerrboundA of Shewchuk's "Adaptive Precision
+// Floating-Point Arithmetic and Fast Robust Geometric Predicates".
+constexpr double kOrientationErrorBound =
+    (3.0 + 16.0 / 9007199254740992.0) / 9007199254740992.0;
+
+// True if the floating-point filter alone decides Orientation(a, b, c).
+bool OrientationFilterDecides(Point a, Point b, Point c);
+
+// Orientation computed with exact arithmetic only.
+int ExactOrientation(Point a, Point b, Point c);
+
+// Orientation for integer coordinates whose differences fit in int64_t, that
+// is below 2^62 in magnitude for int64_t.
+template<class T>
+int IntegerOrientation(BasicPoint<T> a, BasicPoint<T> b, BasicPoint<T> c) {
+  int64_t bax = int64_t(b.x) - a.x;
+  int64_t bay = int64_t(b.y) - a.y;
+  int64_t cax = int64_t(c.x) - a.x;
+  int64_t cay = int64_t(c.y) - a.y;
+  __int128 det = static_cast<__int128>(bax) * cay
+      - static_cast<__int128>(bay) * cax;
+  return (det > 0) - (det < 0);
+}
+
+// Whether -2^62 <= x < 2^62.
+inline bool BelowTwoToThe62(int64_t x) {
+  return uint64_t(x) + (uint64_t(1) << 62) < (uint64_t(1) << 63);
+}
+
+// Orientation for any int64_t coordinates, whose differences take 65 bits.
+int WideIntegerOrientation(BasicPoint<int64_t> a, BasicPoint<int64_t> b,
+                           BasicPoint<int64_t> c);
+
+}  // namespace predicates_internal
+
+inline int Orientation(Point a, Point b, Point c) {
+  double left = (b.x - a.x) * (c.y - a.y);
+  double right = (b.y - a.y) * (c.x - a.x);
+  double det = left - right;
+  double bound = predicates_internal::kOrientationErrorBound
+      * (std::fabs(left) + std::fabs(right));
+  if (det > bound) {
+    return 1;
+  } else if (det < -bound) {
+    return -1;
+  }
+  return predicates_internal::ExactOrientation(a, b, c);
+}
+
+inline int Orientation(BasicPoint<float> a, BasicPoint<float> b,
+                       BasicPoint<float> c) {
+  return Orientation(Point(a.x, a.y), Point(b.x, b.y), Point(c.x, c.y));
+}
+
+inline int Orientation(BasicPoint<int32_t> a, BasicPoint<int32_t> b,
+                       BasicPoint<int32_t> c) {
+  return predicates_internal::IntegerOrientation(a, b, c);
+}
+
+inline int Orientation(BasicPoint<int64_t> a, BasicPoint<int64_t> b,
+                       BasicPoint<int64_t> c) {
+  using namespace predicates_internal;
+  if (BelowTwoToThe62(a.x) && BelowTwoToThe62(a.y) && BelowTwoToThe62(b.x)
+      && BelowTwoToThe62(b.y) && BelowTwoToThe62(c.x)
+      && BelowTwoToThe62(c.y)) {
+    return IntegerOrientation(a, b, c);
+  }
+  return WideIntegerOrientation(a, b, c);
+}
@@ -0,0 +1,129 @@
+#include "base/predicates.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include "gtest/gtest.h"
+
+using predicates_internal::ExactOrientation;
+using predicates_internal::IntegerOrientation;
+using predicates_internal::OrientationFilterDecides;
+using predicates_internal::WideIntegerOrientation;
+
+namespace {
+
+// Every double in [0.25, 1) is a multiple of 2^-54 below 2^54 times that, so
+// the orientation of such points can be computed exactly in 128-bit integers.
+int ReferenceOrientation(Point a, Point b, Point c) {
+  auto scaled = [](double v) {
+    return static_cast<__int128>(std::ldexp(v, 54));
+  };
+  __int128 det = (scaled(b.x) - scaled(a.x)) * (scaled(c.y) - scaled(a.y))
+      - (scaled(b.y) - scaled(a.y)) * (scaled(c.x) - scaled(a.x));
+  return (det > 0) - (det < 0);
+}
+
+}  // namespace
+
+TEST(OrientationTest, Simple) {
+  EXPECT_EQ(1, Orientation(Point(0, 0), Point(1, 0), Point(0, 1)));
+  EXPECT_EQ(-1, Orientation(Point(0, 0), Point(0, 1), Point(1, 0)));
+  EXPECT_EQ(0, Orientation(Point(0, 0), Point(1, 1), Point(3, 3)));
+  EXPECT_EQ(0, Orientation(Point(1, 2), Point(1, 2), Point(5, 7)));
+}
+
+TEST(OrientationTest, NearlyCollinear) {
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> coordinate(0.25, 1);
+  std::uniform_real_distribution<double> fraction(0, 1);
+  std::uniform_int_distribution<int> ulps(-2, 2);
+  int undecided = 0;
+  for (int i = 0; i < 20000; ++i) {
+    Point a(coordinate(gen), coordinate(gen));
+    Point b(coordinate(gen), coordinate(gen));
+    double t = fraction(gen);
+    Point c(a.x + t * (b.x - a.x), a.y + t * (b.y - a.y));
+    for (int k = ulps(gen); k != 0; k += k > 0 ? -1 : 1) {
+      c.y = std::nextafter(c.y, k > 0 ? 2.0 : 0.0);
+    }
+    if (c.x < 0.25 || c.y < 0.25) {
+      continue;
+    }
+    int expected = ReferenceOrientation(a, b, c);
+    ASSERT_EQ(expected, Orientation(a, b, c))
+        << "(" << a << ") (" << b << ") (" << c << ")";
+    ASSERT_EQ(expected, ExactOrientation(a, b, c));
+    ASSERT_EQ(expected, Orientation(b, c, a));
+    ASSERT_EQ(-expected, Orientation(b, a, c));
+    undecided += !OrientationFilterDecides(a, b, c);
+  }
+  // Many of these need the exact fallback.
+  EXPECT_GT(undecided, 1000);
+}
+
+TEST(OrientationTest, LargeCoordinates) {
+  // Collinear points around UTM-like coordinates, and the same points moved
+  // off the line by one unit in the last place.
+  Point a(500000.25, 4000000.5);
+  Point b(500100.25, 4000300.5);
+  Point c(500200.25, 4000600.5);
+  EXPECT_EQ(0, Orientation(a, b, c));
+  EXPECT_EQ(1, Orientation(a, b, Point(c.x, std::nextafter(c.y, 5e6))));
+  EXPECT_EQ(-1, Orientation(a, b, Point(std::nextafter(c.x, 1e6), c.y)));
+}
+
+TEST(OrientationTest, WideIntegers) {
+  // The slow path for int64_t agrees with the fast one wherever both apply,
+  // including on collinear points.
+  std::mt19937_64 random(5);
+  std::uniform_int_distribution<int64_t> coordinate(-(int64_t(1) << 60),
+                                                    int64_t(1) << 60);
+  for (int i = 0; i < 10000; ++i) {
+    BasicPoint<int64_t> a(coordinate(random), coordinate(random));
+    BasicPoint<int64_t> b(coordinate(random), coordinate(random));
+    BasicPoint<int64_t> c = i % 2 ? BasicPoint<int64_t>(coordinate(random),
+                                                        coordinate(random))
+                                  : BasicPoint<int64_t>(2 * b.x - a.x,
+                                                        2 * b.y - a.y);
+    EXPECT_EQ(IntegerOrientation(a, b, c), WideIntegerOrientation(a, b, c));
+  }
+}
+
+TEST(OrientationTest, OtherCoordinateTypes) {
+  using Point32 = BasicPoint<int32_t>;
+  using Point64 = BasicPoint<int64_t>;
+  // The extremes of the ranges, where the products need more than 64 bits.
+  const int32_t max32 = std::numeric_limits<int32_t>::max();
+  const int32_t min32 = std::numeric_limits<int32_t>::min();
+  EXPECT_EQ(0, Orientation(Point32(min32, min32), Point32(0, 0),
+                           Point32(max32, max32)));
+  EXPECT_EQ(1, Orientation(Point32(min32, min32), Point32(max32, max32 - 1),
+                           Point32(max32 - 1, max32 - 1)));
+  EXPECT_EQ(-1, Orientation(Point32(max32, min32), Point32(min32, max32),
+                            Point32(max32, max32)));
+
+  const int64_t max64 = (int64_t(1) << 62) - 1;
+  EXPECT_EQ(0, Orientation(Point64(-max64, -max64), Point64(0, 0),
+                           Point64(max64, max64)));
+  EXPECT_EQ(1, Orientation(Point64(-max64, -max64), Point64(max64, max64 - 1),
+                           Point64(max64 - 1, max64 - 1)));
+  EXPECT_EQ(-1, Orientation(Point64(-max64, -max64), Point64(max64 - 1, max64),
+                            Point64(max64 - 1, max64 - 1)));
+  // Beyond 2^62 the differences no longer fit in 64 bits.
+  const int64_t min64 = std::numeric_limits<int64_t>::min();
+  const int64_t top64 = std::numeric_limits<int64_t>::max();
+  EXPECT_EQ(0, Orientation(Point64(min64, min64), Point64(0, 0),
+                           Point64(top64 - 1, top64 - 1)));
+  EXPECT_EQ(1, Orientation(Point64(min64, min64), Point64(top64, top64 - 1),
+                           Point64(top64 - 1, top64 - 1)));
+  EXPECT_EQ(-1, Orientation(Point64(min64, min64), Point64(top64 - 1, top64),
+                            Point64(top64 - 1, top64 - 1)));
+  EXPECT_EQ(-1, Orientation(Point64(top64, min64), Point64(min64, top64),
+                            Point64(top64, top64)));
+
+  using PointF = BasicPoint<float>;
+  EXPECT_EQ(0, Orientation(PointF(0.5f, 0.5f), PointF(12.0f, 12.0f),
+                           PointF(24.0f, 24.0f)));
+  EXPECT_EQ(1, Orientation(PointF(0.5f, 0.5f), PointF(12.0f, 12.0f),
+                           PointF(24.0f, std::nextafter(24.0f, 25.0f))));
+}
@@ -0,0 +1,21 @@
+#include "base/radix-sort.h"
+
+#include <algorithm>
+
+void SortLexicographically(Point* first, size_t n, Point* scratch,
+                           int num_threads) {
+  RadixSort(first, n, scratch, [](Point p) { return OrderedKey(p.x); },
+            num_threads);
+  for (Point* run = first; run != first + n;) {
+    Point* run_end = run + 1;
+    while (run_end != first + n && run_end->x == run->x) {
+      ++run_end;
+    }
+    if (run_end - run > 1) {
+      std::sort(run, run_end, [](Point lhs, Point rhs) {
+        return lhs.y < rhs.y;
+      });
+    }
+    run = run_end;
+  }
+}
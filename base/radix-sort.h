@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "base/base.h"
+#include "base/parallel.h"
+
+// Maps x to an unsigned key with the same order: OrderedKey(a) < OrderedKey(b)
+// exactly when a < b. 0.0 and -0.0 get the same key. x must not be NaN.
+inline uint64_t OrderedKey(double x) {
+  x += 0.0;  // Turns -0.0 into 0.0.
+  uint64_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+  // Negative numbers have all their bits flipped, so that larger magnitudes
+  // come first; non-negative numbers only have the sign bit set.
+  uint64_t mask = (0 - (bits >> 63)) | (uint64_t(1) << 63);
+  return bits ^ mask;
+}
+
+// Stably sorts the n elements starting at first by the unsigned 64-bit key
+// key(element), using a least significant digit radix sort. scratch must have
+// room for n elements; its contents are overwritten. Digits shared by all
+// keys are skipped, so keys from a narrow range sort in fewer passes. The
+// counting and scattering are split over up to num_threads threads.
+template<class T, class KeyFunction>
+void RadixSort(T* first, size_t n, T* scratch, KeyFunction key,
+               int num_threads = 1);
+
+// Sorts the n points starting at first in the order of LexicographicLess,
+// using scratch as above. Points are radix sorted by x, and then each run of
+// points with the same x is sorted by y.
+void SortLexicographically(Point* first, size_t n, Point* scratch,
+                           int num_threads = 1);
+
+namespace radix_sort_internal {
+
+const int kDigitBits = 11;
+const int kNumDigits = (64 + kDigitBits - 1) / kDigitBits;
+const size_t kRadix = size_t(1) << kDigitBits;
+
+// Below this many elements an insertion sort is faster.
+const size_t kMinRadixSortSize = 64;
+
+// Below this many elements per thread the threads cost more than they save.
+const size_t kMinElementsPerThread = 1 << 16;
+
+inline size_t Digit(uint64_t key, int digit) {
+  return (key >> (digit * kDigitBits)) & (kRadix - 1);
+}
+
+template<class T, class KeyFunction>
+void InsertionSort(T* first, size_t n, KeyFunction key) {
+  for (size_t i = 1; i < n; ++i) {
+    T value = first[i];
+    uint64_t value_key = key(value);
+    size_t j = i;
+    for (; j > 0 && value_key < key(first[j - 1]); --j) {
+      first[j] = first[j - 1];
+    }
+    first[j] = value;
+  }
+}
+
+}  // namespace radix_sort_internal
+
+template<class T, class KeyFunction>
+void RadixSort(T* first, size_t n, T* scratch, KeyFunction key,
+               int num_threads) {
+  using namespace radix_sort_internal;
+  if (n < kMinRadixSortSize) {
+    InsertionSort(first, n, key);
+    return;
+  }
+  num_threads = ClampNumThreads(num_threads, n, kMinElementsPerThread);
+  const size_t chunk_size = (n + num_threads - 1) / num_threads;
+
+  // counts[thread][digit][value] counts the elements of the thread's chunk
+  // of src with that value of the digit.
+  std::vector<size_t> counts(num_threads * kNumDigits * kRadix);
+  auto count = [&](int thread, int digit) -> size_t* {
+    return &counts[(thread * kNumDigits + digit) * kRadix];
+  };
+
+  // The total counts of a digit do not depend on the order of the elements,
+  // so one pass finds the digits that are the same for all keys.
+  RunInParallel(num_threads, [&](int thread) {
+    size_t end = std::min(n, (thread + 1) * chunk_size);
+    for (size_t i = thread * chunk_size; i < end; ++i) {
+      uint64_t k = key(first[i]);
+      for (int digit = 0; digit < kNumDigits; ++digit) {
+        ++count(thread, digit)[Digit(k, digit)];
+      }
+    }
+  });
+
+  T* src = first;
+  T* dst = scratch;
+  bool counts_valid = true;
+  for (int digit = 0; digit < kNumDigits; ++digit) {
+    size_t value_of_first = Digit(key(src[0]), digit);
+    size_t total = 0;
+    for (int thread = 0; thread < num_threads; ++thread) {
+      total += count(thread, digit)[value_of_first];
+    }
+    if (total == n) {
+      continue;
+    }
+    // After a scatter, the chunks of src hold other elements than the ones
+    // counted.
+    if (!counts_valid) {
+      RunInParallel(num_threads, [&](int thread) {
+        size_t* c = count(thread, digit);
+        std::fill(c, c + kRadix, 0);
+        size_t end = std::min(n, (thread + 1) * chunk_size);
+        for (size_t i = thread * chunk_size; i < end; ++i) {
+          ++c[Digit(key(src[i]), digit)];
+        }
+      });
+    }
+    // Turns the counts into the position of the first element of each value
+    // for each thread.
+    size_t offset = 0;
+    for (size_t value = 0; value < kRadix; ++value) {
+      for (int thread = 0; thread < num_threads; ++thread) {
+        size_t c = count(thread, digit)[value];
+        count(thread, digit)[value] = offset;
+        offset += c;
+      }
+    }
+    RunInParallel(num_threads, [&](int thread) {
+      size_t* offsets = count(thread, digit);
+      size_t end = std::min(n, (thread + 1) * chunk_size);
+      for (size_t i = thread * chunk_size; i < end; ++i) {
+        dst[offsets[Digit(key(src[i]), digit)]++] = src[i];
+      }
+    });
+    std::swap(src, dst);
+    counts_valid = num_threads == 1;
+  }
+  if (src != first) {
+    std::copy(src, src + n, first);
+  }
+}
@@ -0,0 +1,71 @@
+#include "base/radix-sort.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+#include "base/workload.h"
+#include "gtest/gtest.h"
+
+using std::pair;
+using std::vector;
+
+TEST(OrderedKeyTest, PreservesOrder) {
+  const double inf = std::numeric_limits<double>::infinity();
+  vector<double> values = {
+      -inf, -1e300, -2.5, -1, -std::numeric_limits<double>::denorm_min(), 0,
+      std::numeric_limits<double>::denorm_min(), 1e-300, 0.5, 1,
+      std::nextafter(1.0, 2.0), 1e300, inf};
+  for (size_t i = 1; i < values.size(); ++i) {
+    EXPECT_LT(OrderedKey(values[i - 1]), OrderedKey(values[i])) << values[i];
+  }
+  EXPECT_EQ(OrderedKey(0.0), OrderedKey(-0.0));
+}
+
+TEST(RadixSortTest, SortsStably) {
+  std::mt19937 gen(3);
+  for (size_t n : {0, 1, 5, 63, 64, 1000, 300000}) {
+    for (int num_threads : {1, 4}) {
+      // Keys from a narrow range, so that most digits are skipped, and with
+      // many duplicates, so that stability matters.
+      vector<pair<uint64_t, size_t>> elements(n);
+      std::uniform_int_distribution<uint64_t> key_dist(0, n / 4);
+      for (size_t i = 0; i < n; ++i) {
+        elements[i] = {(key_dist(gen) << 40) + 12345, i};
+      }
+      vector<pair<uint64_t, size_t>> expected = elements;
+      std::stable_sort(expected.begin(), expected.end(),
+                       [](const pair<uint64_t, size_t>& lhs,
+                          const pair<uint64_t, size_t>& rhs) {
+                         return lhs.first < rhs.first;
+                       });
+      vector<pair<uint64_t, size_t>> scratch(n);
+      RadixSort(elements.data(), n, scratch.data(),
+                [](const pair<uint64_t, size_t>& e) { return e.first; },
+                num_threads);
+      EXPECT_EQ(expected, elements) << n << " " << num_threads;
+    }
+  }
+}
+
+TEST(SortLexicographicallyTest, SameAsStdSort) {
+  for (auto distribution : {UNIFORM_SQUARE, UNIFORM_DISK, ON_CIRCLE,
+                            CLUSTERED, DEGENERATE}) {
+    for (int n : {10, 100000}) {
+      vector<Point> points = RandomPoints(distribution, n, 5);
+      // Negative coordinates and both signs of zero.
+      for (size_t i = 0; i < points.size(); i += 7) {
+        points[i].x = -points[i].x;
+      }
+      points[0] = Point(0.0, 1.0);
+      points[1] = Point(-0.0, 0.5);
+      vector<Point> expected = points;
+      std::sort(expected.begin(), expected.end(), LexicographicLess);
+      vector<Point> scratch(points.size());
+      SortLexicographically(points.data(), points.size(), scratch.data(), 2);
+      EXPECT_EQ(expected, points) << PointDistributionName(distribution);
+    }
+  }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// A view of size consecutive objects of type T owned by someone else, like
+// std::span of C++20. Use Span<const T> for read-only access.
+template<class T>
+class Span {
+ public:
+  using value_type = typename std::remove_const<T>::type;
+  using iterator = T*;
+
+  Span() : data_(nullptr), size_(0) {}
+  Span(T* data, size_t size) : data_(data), size_(size) {}
+  Span(std::vector<value_type>& v) : data_(v.data()), size_(v.size()) {}
+  Span(const std::vector<value_type>& v) : data_(v.data()), size_(v.size()) {}
+
+  T* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  T& operator[](size_t i) const { return data_[i]; }
+
+  iterator begin() const { return data_; }
+  iterator end() const { return data_ + size_; }
+
+  // The count objects starting at offset.
+  Span subspan(size_t offset, size_t count) const {
+    return Span(data_ + offset, count);
+  }
+
+ private:
+  T* data_;
+  size_t size_;
+};
@@ -0,0 +1,36 @@
+#include "base/stats.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using std::string;
+
+string NumbersToJson(
+    std::initializer_list<std::pair<const char*, double>> fields) {
+  string json = "{";
+  for (const auto& field : fields) {
+    if (json.size() > 1) {
+      json += ", ";
+    }
+    json += "\"";
+    json += field.first;
+    json += "\": ";
+    if (std::isfinite(field.second)) {
+      // The shortest of these precisions that reads back exactly.
+      char number[32];
+      for (int precision = 15; precision <= 17; ++precision) {
+        snprintf(number, sizeof(number), "%.*g", precision, field.second);
+        if (strtod(number, nullptr) == field.second) {
+          break;
+        }
+      }
+      json += number;
+    } else {
+      // JSON has no infinities or NaN.
+      json += "null";
+    }
+  }
+  json += "}";
+  return json;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <chrono>
+#include <initializer_list>
+#include <string>
+#include <utility>
+
+// Instrumentation of the hot paths of the algorithms, such as counting the
+// comparisons of a sweep. It is compiled in only when GEOMETRY_STATS is
+// defined, as with bazel build --copt=-DGEOMETRY_STATS. Otherwise the
+// statements wrapped in GEOMETRY_STATS_ONLY vanish, and the fields of stats
+// structs that they fill in stay zero. The layout of the stats structs does
+// not depend on the macro, so code built with and without it can be linked.
+#ifdef GEOMETRY_STATS
+#define GEOMETRY_STATS_ONLY(...) __VA_ARGS__
+const bool kGeometryStatsEnabled = true;
+#else
+#define GEOMETRY_STATS_ONLY(...)
+const bool kGeometryStatsEnabled = false;
+#endif
+
+// Measures the phases of an algorithm one after the other.
+class Stopwatch {
+ public:
+  Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+  // Adds the seconds since construction or the previous lap to *seconds.
+  void Lap(double* seconds) {
+    auto now = std::chrono::steady_clock::now();
+    *seconds += std::chrono::duration<double>(now - start_).count();
+    start_ = now;
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+// A JSON object with the given numeric fields, in order, such as
+// {"events": 12, "sort_seconds": 0.25}. Numbers are written so that they read
+// back exactly.
+std::string NumbersToJson(
+    std::initializer_list<std::pair<const char*, double>> fields);
@@ -0,0 +1,36 @@
+#include "base/stats.h"
+
+#include <limits>
+#include <thread>
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(NumbersToJsonTest, Fields) {
+  EXPECT_EQ("{}", NumbersToJson({}));
+  EXPECT_EQ("{\"events\": 12}", NumbersToJson({{"events", 12}}));
+  EXPECT_EQ("{\"events\": 9007199254740992, \"seconds\": 0.25, "
+            "\"ratio\": null}",
+            NumbersToJson({{"events", 9007199254740992.0},
+                           {"seconds", 0.25},
+                           {"ratio",
+                            std::numeric_limits<double>::infinity()}}));
+}
+
+TEST(StopwatchTest, Lap) {
+  Stopwatch stopwatch;
+  double first = 0, second = 0;
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  stopwatch.Lap(&first);
+  stopwatch.Lap(&second);
+  EXPECT_GE(first, 0.01);
+  EXPECT_LT(second, first);
+}
+
+TEST(GeometryStatsOnlyTest, Statements) {
+  int count = 0;
+  GEOMETRY_STATS_ONLY(++count;)
+  EXPECT_EQ(kGeometryStatsEnabled ? 1 : 0, count);
+}
+
+}  // namespace
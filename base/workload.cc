@@ -0,0 +1,261 @@
+#include "base/workload.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using std::vector;
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+// Clamps a coordinate into the unit interval.
+double Clamp(double v) {
+  return std::min(1.0, std::max(0.0, v));
+}
+
+Point UniformInSquare(std::mt19937* rng) {
+  std::uniform_real_distribution<double> unit(0, 1);
+  double x = unit(*rng);
+  double y = unit(*rng);
+  return Point(x, y);
+}
+
+Point UniformInDisk(std::mt19937* rng) {
+  std::uniform_real_distribution<double> unit(0, 1);
+  double r = 0.5 * std::sqrt(unit(*rng));
+  double theta = 2 * kPi * unit(*rng);
+  return Point(0.5 + r * std::cos(theta), 0.5 + r * std::sin(theta));
+}
+
+Point OnCircle(std::mt19937* rng) {
+  std::uniform_real_distribution<double> unit(0, 1);
+  double theta = 2 * kPi * unit(*rng);
+  return Point(0.5 + 0.5 * std::cos(theta), 0.5 + 0.5 * std::sin(theta));
+}
+
+}  // namespace
+
+const char* PointDistributionName(PointDistribution distribution) {
+  switch (distribution) {
+    case UNIFORM_SQUARE: return "uniform_square";
+    case UNIFORM_DISK: return "uniform_disk";
+    case ON_CIRCLE: return "on_circle";
+    case CLUSTERED: return "clustered";
+    case DEGENERATE: return "degenerate";
+  }
+  return "unknown";
+}
+
+const char* SegmentDistributionName(SegmentDistribution distribution) {
+  switch (distribution) {
+    case SHORT_SEGMENTS: return "short";
+    case LONG_SEGMENTS: return "long";
+    case AXIS_PARALLEL_SEGMENTS: return "axis_parallel";
+  }
+  return "unknown";
+}
+
+vector<Point> RandomPoints(PointDistribution distribution,
+                           int n,
+                           unsigned seed) {
+  std::mt19937 rng(seed);
+  vector<Point> points;
+  points.reserve(n);
+  switch (distribution) {
+    case UNIFORM_SQUARE:
+      for (int i = 0; i < n; ++i) {
+        points.push_back(UniformInSquare(&rng));
+      }
+      break;
+
+    case UNIFORM_DISK:
+      for (int i = 0; i < n; ++i) {
+        points.push_back(UniformInDisk(&rng));
+      }
+      break;
+
+    case ON_CIRCLE:
+      for (int i = 0; i < n; ++i) {
+        points.push_back(OnCircle(&rng));
+      }
+      break;
+
+    case CLUSTERED: {
+      const int kNumClusters = 8;
+      vector<Point> centers;
+      for (int i = 0; i < kNumClusters; ++i) {
+        Point c = UniformInSquare(&rng);
+        centers.push_back(Point(0.1 + 0.8 * c.x, 0.1 + 0.8 * c.y));
+      }
+      std::uniform_int_distribution<int> pick(0, kNumClusters - 1);
+      std::normal_distribution<double> offset(0, 0.02);
+      for (int i = 0; i < n; ++i) {
+        Point c = centers[pick(rng)];
+        points.push_back(Point(Clamp(c.x + offset(rng)),
+                               Clamp(c.y + offset(rng))));
+      }
+      break;
+    }
+
+    case DEGENERATE: {
+      // A 17x17 lattice with spacing 1/16 keeps every coordinate exactly
+      // representable, so collinear triples stay exactly collinear.
+      const int kGrid = 16;
+      std::uniform_int_distribution<int> cell(0, kGrid);
+      std::uniform_int_distribution<int> side(0, 4);
+      for (int i = 0; i < n; ++i) {
+        double u = static_cast<double>(cell(rng)) / kGrid;
+        double v = static_cast<double>(cell(rng)) / kGrid;
+        switch (side(rng)) {
+          case 0: points.push_back(Point(u, 0)); break;
+          case 1: points.push_back(Point(u, 1)); break;
+          case 2: points.push_back(Point(0, v)); break;
+          case 3: points.push_back(Point(1, v)); break;
+          default: points.push_back(Point(u, v)); break;
+        }
+      }
+      break;
+    }
+  }
+  return points;
+}
+
+vector<Segment> RandomSegments(SegmentDistribution distribution,
+                               int n,
+                               unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> unit(0, 1);
+  vector<Segment> segments;
+  segments.reserve(n);
+  switch (distribution) {
+    case SHORT_SEGMENTS: {
+      double length = 1 / std::sqrt(std::max(n, 1));
+      for (int i = 0; i < n; ++i) {
+        Point c = UniformInSquare(&rng);
+        double theta = 2 * kPi * unit(rng);
+        double dx = 0.5 * length * std::cos(theta);
+        double dy = 0.5 * length * std::sin(theta);
+        segments.push_back(Segment(Point(Clamp(c.x - dx), Clamp(c.y - dy)),
+                                   Point(Clamp(c.x + dx), Clamp(c.y + dy))));
+      }
+      break;
+    }
+
+    case LONG_SEGMENTS:
+      for (int i = 0; i < n; ++i) {
+        Point p = UniformInSquare(&rng);
+        Point q = UniformInSquare(&rng);
+        segments.push_back(Segment(p, q));
+      }
+      break;
+
+    case AXIS_PARALLEL_SEGMENTS:
+      for (int i = 0; i < n; ++i) {
+        Point c = UniformInSquare(&rng);
+        double half = 0.05 * unit(rng);
+        if (i % 2 == 0) {
+          segments.push_back(Segment(Point(Clamp(c.x - half), c.y),
+                                     Point(Clamp(c.x + half), c.y)));
+        } else {
+          segments.push_back(Segment(Point(c.x, Clamp(c.y - half)),
+                                     Point(c.x, Clamp(c.y + half))));
+        }
+      }
+      break;
+  }
+  return segments;
+}
+
+Polygon RandomPolygon(int n, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> unit(0, 1);
+  double phase1 = 2 * kPi * unit(rng);
+  double phase2 = 2 * kPi * unit(rng);
+  Polygon polygon;
+  polygon.points.reserve(n);
+  for (int i = 0; i < n; ++i) {
+    // Vertex i keeps to its own sector, so the angles increase.
+    double theta = 2 * kPi * (i + unit(rng)) / n;
+    double r = 0.35 + 0.1 * std::sin(3 * theta + phase1)
+        + 0.05 * std::sin(17 * theta + phase2) + (2 * unit(rng) - 1) / n;
+    r = std::min(0.5, std::max(0.2, r));
+    polygon.points.push_back(Point(0.5 + r * std::cos(theta),
+                                   0.5 + r * std::sin(theta)));
+  }
+  return polygon;
+}
+
+vector<Point> RandomTrack(int n, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> unit(0, 1);
+  std::normal_distribution<double> normal(0, 1);
+  double heading = 2 * kPi * unit(rng);
+  Point forward(std::cos(heading), std::sin(heading));
+  vector<Point> track;
+  track.reserve(n);
+  double along = 0, side = 0, side_speed = 0;
+  for (int i = 0; i < n; ++i) {
+    along += 0.5 + unit(rng);
+    side_speed = 0.95 * side_speed + 0.3 * normal(rng);
+    side += side_speed;
+    track.push_back(Point(along * forward.x - side * forward.y,
+                          along * forward.y + side * forward.x));
+  }
+  // The same scale for both coordinates keeps the track simple.
+  double min_x = track[0].x, min_y = track[0].y;
+  double max_x = min_x, max_y = min_y;
+  for (Point p : track) {
+    min_x = std::min(min_x, p.x);
+    min_y = std::min(min_y, p.y);
+    max_x = std::max(max_x, p.x);
+    max_y = std::max(max_y, p.y);
+  }
+  double extent = std::max(max_x - min_x, max_y - min_y);
+  double scale = extent > 0 ? 1 / extent : 1;
+  for (Point& p : track) {
+    p = Point(Clamp((p.x - min_x) * scale), Clamp((p.y - min_y) * scale));
+  }
+  return track;
+}
+
+vector<Segment> RandomSubdivision(int n, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> unit(0, 1);
+  int k = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(n))));
+  double cell = 1.0 / k;
+  // Corner (i, j) is corners[i * (k + 1) + j].
+  vector<Point> corners;
+  corners.reserve((k + 1) * (k + 1));
+  for (int i = 0; i <= k; ++i) {
+    for (int j = 0; j <= k; ++j) {
+      double dx = (i == 0 || i == k) ? 0 : (unit(rng) - 0.5) * 0.5;
+      double dy = (j == 0 || j == k) ? 0 : (unit(rng) - 0.5) * 0.5;
+      corners.push_back(Point((i + dx) * cell, (j + dy) * cell));
+    }
+  }
+  vector<Segment> edges;
+  edges.reserve(2 * k * (k + 1) + 3 * (k * k / 8 + 1));
+  for (int i = 0; i <= k; ++i) {
+    for (int j = 0; j <= k; ++j) {
+      Point p = corners[i * (k + 1) + j];
+      if (i < k && unit(rng) >= 0.1) {
+        edges.push_back(Segment(p, corners[(i + 1) * (k + 1) + j]));
+      }
+      if (j < k && unit(rng) >= 0.1) {
+        edges.push_back(Segment(p, corners[i * (k + 1) + j + 1]));
+      }
+      if (i < k && j < k && unit(rng) < 0.125) {
+        // Within the middle of the cell, which no jittered edge reaches.
+        Point a((i + 0.4) * cell, (j + 0.4) * cell);
+        Point b((i + 0.6) * cell, (j + 0.4 + 0.2 * unit(rng)) * cell);
+        Point c((i + 0.4 + 0.2 * unit(rng)) * cell, (j + 0.6) * cell);
+        edges.push_back(Segment(a, b));
+        edges.push_back(Segment(b, c));
+        edges.push_back(Segment(c, a));
+      }
+    }
+  }
+  return edges;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include "base/base.h"
+
+// Seeded generators of synthetic inputs for tests and benchmarks. The same
+// seed always yields the same input, so runs can be compared across releases.
+// Every generated coordinate lies in the unit square [0, 1] x [0, 1].
+
+enum PointDistribution {
+  UNIFORM_SQUARE,
+  UNIFORM_DISK,
+  // Every point lies on the hull.
+  ON_CIRCLE,
+  // A few tight Gaussian clusters.
+  CLUSTERED,
+  // Points snapped to a coarse grid, so there are many duplicates and many
+  // collinear triples, including along the hull.
+  DEGENERATE,
+};
+
+enum SegmentDistribution {
+  // Segments of length about 1 / sqrt(n); O(n) intersections in expectation.
+  SHORT_SEGMENTS,
+  // Endpoints drawn uniformly from the square; O(n^2) intersections.
+  LONG_SEGMENTS,
+  // Half horizontal and half vertical segments of moderate length.
+  AXIS_PARALLEL_SEGMENTS,
+};
+
+const char* PointDistributionName(PointDistribution distribution);
+const char* SegmentDistributionName(SegmentDistribution distribution);
+
+std::vector<Point> RandomPoints(PointDistribution distribution,
+                                int n,
+                                unsigned seed);
+
+std::vector<Segment> RandomSegments(SegmentDistribution distribution,
+                                    int n,
+                                    unsigned seed);
+
+// A simple polygon with n >= 3 vertices in counterclockwise order, like the
+// outline of a region: star-shaped around the center of the square, with
+// every vertex at its own angle and at a distance from the center that
+// varies smoothly between 0.2 and 0.5, plus jitter of up to 1 / n.
+Polygon RandomPolygon(int n, unsigned seed);
+
+// A simple polyline of n >= 1 vertices like a GPS track of a drive: it
+// advances in a random direction by steps of random length, drifting from
+// side to side with a smoothly varying lateral speed, and is scaled to fit
+// the square. As it always advances, it never crosses itself.
+std::vector<Point> RandomTrack(int n, unsigned seed);
+
+// The edges of a planar subdivision of about n faces, like a parcel map: a
+// square grid of cells whose corners are jittered by up to a quarter of a
+// cell, so that edges meet only at shared corners. About one edge in ten is
+// left out, merging cells and leaving some corners dangling, and one cell in
+// eight holds a small triangular island in its middle. No two edges cross
+// or overlap.
+std::vector<Segment> RandomSubdivision(int n, unsigned seed);
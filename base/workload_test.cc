@@ -0,0 +1,132 @@
+#include "base/workload.h"
+#include "gtest/gtest.h"
+
+using std::vector;
+
+TEST(RandomPointsTest, Deterministic) {
+  for (auto distribution : {UNIFORM_SQUARE, UNIFORM_DISK, ON_CIRCLE,
+                            CLUSTERED, DEGENERATE}) {
+    vector<Point> a = RandomPoints(distribution, 100, 42);
+    vector<Point> b = RandomPoints(distribution, 100, 42);
+    ASSERT_EQ(100, a.size());
+    EXPECT_TRUE(a == b) << PointDistributionName(distribution);
+    vector<Point> c = RandomPoints(distribution, 100, 43);
+    EXPECT_FALSE(a == c) << PointDistributionName(distribution);
+  }
+}
+
+TEST(RandomPointsTest, InUnitSquare) {
+  for (auto distribution : {UNIFORM_SQUARE, UNIFORM_DISK, ON_CIRCLE,
+                            CLUSTERED, DEGENERATE}) {
+    for (Point p : RandomPoints(distribution, 1000, 1)) {
+      EXPECT_LE(0, p.x);
+      EXPECT_GE(1, p.x);
+      EXPECT_LE(0, p.y);
+      EXPECT_GE(1, p.y);
+    }
+  }
+}
+
+TEST(RandomPointsTest, OnCircle) {
+  for (Point p : RandomPoints(ON_CIRCLE, 100, 7)) {
+    EXPECT_NEAR(0.25, (p.x - 0.5) * (p.x - 0.5) + (p.y - 0.5) * (p.y - 0.5),
+                1e-12);
+  }
+}
+
+TEST(RandomSegmentsTest, Deterministic) {
+  for (auto distribution : {SHORT_SEGMENTS, LONG_SEGMENTS,
+                            AXIS_PARALLEL_SEGMENTS}) {
+    vector<Segment> a = RandomSegments(distribution, 100, 42);
+    vector<Segment> b = RandomSegments(distribution, 100, 42);
+    ASSERT_EQ(100, a.size());
+    for (int i = 0; i < a.size(); ++i) {
+      EXPECT_EQ(a[i].endpoint(0), b[i].endpoint(0));
+      EXPECT_EQ(a[i].endpoint(1), b[i].endpoint(1));
+    }
+  }
+}
+
+TEST(RandomSegmentsTest, AxisParallel) {
+  for (const Segment& s : RandomSegments(AXIS_PARALLEL_SEGMENTS, 100, 3)) {
+    EXPECT_TRUE(s.is_horizontal() || s.is_vertical()) << s;
+  }
+}
+
+TEST(RandomPolygonTest, Simple) {
+  Polygon polygon = RandomPolygon(200, 3);
+  ASSERT_EQ(200, polygon.points.size());
+  EXPECT_TRUE(polygon == RandomPolygon(200, 3));
+  const vector<Point>& v = polygon.points;
+  double twice_area = 0;
+  for (size_t i = 0; i < v.size(); ++i) {
+    Point p = v[i], q = v[(i + 1) % v.size()];
+    EXPECT_LE(0, p.x);
+    EXPECT_GE(1, p.x);
+    EXPECT_LE(0, p.y);
+    EXPECT_GE(1, p.y);
+    twice_area += p.x * q.y - q.x * p.y;
+  }
+  EXPECT_GT(twice_area, 0);
+  // Edges that are not consecutive do not meet.
+  for (size_t i = 0; i < v.size(); ++i) {
+    Segment e(v[i], v[(i + 1) % v.size()]);
+    for (size_t j = i + 2; j < v.size(); ++j) {
+      if (i == 0 && j == v.size() - 1) {
+        continue;
+      }
+      Point p;
+      EXPECT_FALSE(e.IntersectsSegment(Segment(v[j], v[(j + 1) % v.size()]),
+                                       &p))
+          << i << " " << j;
+    }
+  }
+}
+
+TEST(RandomTrackTest, Simple) {
+  vector<Point> track = RandomTrack(300, 4);
+  ASSERT_EQ(300, track.size());
+  EXPECT_TRUE(track == RandomTrack(300, 4));
+  EXPECT_EQ(1, RandomTrack(1, 4).size());
+  for (Point p : track) {
+    EXPECT_LE(0, p.x);
+    EXPECT_GE(1, p.x);
+    EXPECT_LE(0, p.y);
+    EXPECT_GE(1, p.y);
+  }
+  // Edges that are not consecutive do not meet.
+  for (size_t i = 0; i + 1 < track.size(); ++i) {
+    Segment e(track[i], track[i + 1]);
+    for (size_t j = i + 2; j + 1 < track.size(); ++j) {
+      Point p;
+      EXPECT_FALSE(e.IntersectsSegment(Segment(track[j], track[j + 1]), &p))
+          << i << " " << j;
+    }
+  }
+}
+
+TEST(RandomSubdivisionTest, Simple) {
+  vector<Segment> edges = RandomSubdivision(100, 5);
+  EXPECT_LT(150, edges.size());
+  EXPECT_GT(300, edges.size());
+  for (const Segment& e : edges) {
+    for (Point p : e.endpoints()) {
+      EXPECT_LE(0, p.x);
+      EXPECT_GE(1, p.x);
+      EXPECT_LE(0, p.y);
+      EXPECT_GE(1, p.y);
+    }
+  }
+  // Edges meet only at shared endpoints.
+  for (size_t i = 0; i < edges.size(); ++i) {
+    for (size_t j = i + 1; j < edges.size(); ++j) {
+      Point p;
+      if (edges[i].IntersectsSegment(edges[j], &p)) {
+        EXPECT_TRUE(p == edges[i].endpoint(0) || p == edges[i].endpoint(1))
+            << edges[i] << " " << edges[j];
+        EXPECT_TRUE(p == edges[j].endpoint(0) || p == edges[j].endpoint(1))
+            << edges[i] << " " << edges[j];
+      }
+    }
+  }
+}
@@ -0,0 +1,81 @@
+#include <vector>
+#include "base/base.h"
+#include "base/batch-orientation.h"
+#include "base/point-buffer.h"
+#include "base/workload.h"
+#include "benchmark/benchmark.h"
+
+using batch_orientation_internal::Avx2Kernels;
+using batch_orientation_internal::Kernels;
+using batch_orientation_internal::ScalarKernels;
+using batch_orientation_internal::Sse2Kernels;
+using std::vector;
+
+namespace {
+
+const unsigned kSeed = 1;
+const int kNumPoints = 4096;
+
+// Argument: 0 for scalar, 1 for SSE2, 2 for AVX2.
+const Kernels* KernelsForArg(int arg) {
+  switch (arg) {
+    case 0: return &ScalarKernels();
+    case 1: return Sse2Kernels();
+    default: return Avx2Kernels();
+  }
+}
+
+// The loop these kernels replace: one DirectedLine test per point.
+void BM_PointLiesToLeft(benchmark::State& state) {
+  vector<Point> points = RandomPoints(UNIFORM_SQUARE, kNumPoints, kSeed);
+  DirectedLine line(Point(0.1, 0.2), Point(0.8, 0.9));
+  while (state.KeepRunning()) {
+    size_t count = 0;
+    for (Point p : points) {
+      count += line.PointLiesToLeft(p);
+    }
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_PointLiesToLeft);
+
+void BM_CountPointsLeftOfLine(benchmark::State& state) {
+  const Kernels* kernels = KernelsForArg(state.range(0));
+  if (!kernels) {
+    state.SkipWithError("instruction set not supported");
+    return;
+  }
+  PointBuffer points(RandomPoints(UNIFORM_SQUARE, kNumPoints, kSeed));
+  Point p1(0.1, 0.2);
+  Point p2(0.8, 0.9);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(
+        kernels->count_left(points.xs(), points.ys(), points.size(), p1, p2));
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+  state.SetLabel(kernels->name);
+}
+BENCHMARK(BM_CountPointsLeftOfLine)->DenseRange(0, 2);
+
+void BM_ClassifyTurns(benchmark::State& state) {
+  const Kernels* kernels = KernelsForArg(state.range(0));
+  if (!kernels) {
+    state.SkipWithError("instruction set not supported");
+    return;
+  }
+  PointBuffer p1(RandomPoints(UNIFORM_SQUARE, kNumPoints, kSeed));
+  PointBuffer p2(RandomPoints(UNIFORM_SQUARE, kNumPoints, kSeed + 1));
+  PointBuffer p3(RandomPoints(UNIFORM_SQUARE, kNumPoints, kSeed + 2));
+  vector<signed char> out(kNumPoints);
+  while (state.KeepRunning()) {
+    kernels->classify_turns(p1.xs(), p1.ys(), p2.xs(), p2.ys(),
+                            p3.xs(), p3.ys(), kNumPoints, out.data());
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumPoints);
+  state.SetLabel(kernels->name);
+}
+BENCHMARK(BM_ClassifyTurns)->DenseRange(0, 2);
+
+}  // namespace
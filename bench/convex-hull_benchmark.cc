@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <vector>
+#include "base/workload.h"
+#include "benchmark/benchmark.h"
+#include "chapter1/convex-hull.h"
+#include "chapter1/incremental-convex-hull.h"
+#include "chapter1/sliding-window-convex-hull.h"
+
+using std::vector;
+
+namespace {
+
+const unsigned kSeed = 1;
+
+// Arguments: {PointDistribution, number of points}.
+void AllDistributions(benchmark::internal::Benchmark* b) {
+  for (int distribution : {UNIFORM_SQUARE, UNIFORM_DISK, ON_CIRCLE,
+                           CLUSTERED, DEGENERATE}) {
+    for (int n = 1 << 8; n <= 1 << 20; n <<= 2) {
+      b->Args({distribution, n});
+    }
+  }
+}
+
+// SlowConvexHull is cubic and cannot handle duplicated points, so it only
+// gets small, non-degenerate inputs.
+void SmallNonDegenerateDistributions(benchmark::internal::Benchmark* b) {
+  for (int distribution : {UNIFORM_SQUARE, UNIFORM_DISK, ON_CIRCLE,
+                           CLUSTERED}) {
+    for (int n = 1 << 4; n <= 1 << 8; n <<= 2) {
+      b->Args({distribution, n});
+    }
+  }
+}
+
+void BM_SlowConvexHull(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  vector<Point> points = RandomPoints(distribution, state.range(1), kSeed);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(SlowConvexHull(points));
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_SlowConvexHull)->Apply(SmallNonDegenerateDistributions);
+
+void BM_ConvexHull(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  vector<Point> points = RandomPoints(distribution, state.range(1), kSeed);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(ConvexHull(points));
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_ConvexHull)->Apply(AllDistributions);
+
+// The same points on a grid of 2^30 by 2^30 integer coordinates.
+void BM_ConvexHull_Int32(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  vector<BasicPoint<int32_t>> points;
+  for (Point p : RandomPoints(distribution, state.range(1), kSeed)) {
+    points.push_back(BasicPoint<int32_t>(p.x * (1 << 30), p.y * (1 << 30)));
+  }
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(ConvexHull(points));
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_ConvexHull_Int32)->Apply(AllDistributions);
+
+// Arguments: {PointDistribution, number of points}, for loops computing many
+// small hulls.
+void SmallInputs(benchmark::internal::Benchmark* b) {
+  for (int distribution : {UNIFORM_SQUARE, CLUSTERED}) {
+    for (int n = 1 << 3; n <= 1 << 11; n <<= 2) {
+      b->Args({distribution, n});
+    }
+  }
+}
+
+void BM_ConvexHull_SmallInputs(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  vector<Point> points = RandomPoints(distribution, state.range(1), kSeed);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(ConvexHull(points));
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_ConvexHull_SmallInputs)->Apply(SmallInputs);
+
+// Copies the points into a buffer reused by every iteration and computes the
+// hull there, without allocating.
+void BM_ConvexHullInPlace(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  vector<Point> points = RandomPoints(distribution, state.range(1), kSeed);
+  vector<Point> buffer(points.size());
+  while (state.KeepRunning()) {
+    std::copy(points.begin(), points.end(), buffer.begin());
+    benchmark::DoNotOptimize(ConvexHullInPlace(buffer.begin(), buffer.end()));
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_ConvexHullInPlace)->Apply(SmallInputs)->Apply(AllDistributions);
+
+void BM_ConvexHull_CullInteriorPoints(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  vector<Point> points = RandomPoints(distribution, state.range(1), kSeed);
+  ConvexHullOptions options;
+  options.cull_interior_points = true;
+  ConvexHullStats stats;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(ConvexHull(points, options, &stats));
+  }
+  state.counters["culled_fraction"] =
+      static_cast<double>(stats.culled_points) / stats.input_points;
+  state.SetItemsProcessed(state.iterations() * points.size());
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_ConvexHull_CullInteriorPoints)->Apply(AllDistributions);
+
+void BM_OutputSensitiveConvexHull(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  vector<Point> points = RandomPoints(distribution, state.range(1), kSeed);
+  size_t hull_size = 0;
+  while (state.KeepRunning()) {
+    hull_size = OutputSensitiveConvexHull(points).points.size();
+  }
+  state.counters["hull_size"] = hull_size;
+  state.SetItemsProcessed(state.iterations() * points.size());
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_OutputSensitiveConvexHull)->Apply(AllDistributions);
+
+void BM_AdaptiveConvexHull(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  vector<Point> points = RandomPoints(distribution, state.range(1), kSeed);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(AdaptiveConvexHull(points));
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_AdaptiveConvexHull)->Apply(AllDistributions);
+
+// Inserts the points one at a time, as they would arrive from a feed.
+void BM_IncrementalConvexHull(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  vector<Point> points = RandomPoints(distribution, state.range(1), kSeed);
+  while (state.KeepRunning()) {
+    IncrementalConvexHull hull;
+    for (Point p : points) {
+      hull.Insert(p);
+    }
+    benchmark::DoNotOptimize(hull.Snapshot());
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_IncrementalConvexHull)->Apply(AllDistributions);
+
+// Arguments: {PointDistribution, window size}.
+void WindowSizes(benchmark::internal::Benchmark* b) {
+  for (int distribution : {UNIFORM_SQUARE, ON_CIRCLE, CLUSTERED}) {
+    for (int window : {1 << 10, 1 << 13, 1 << 16}) {
+      b->Args({distribution, window});
+    }
+  }
+}
+
+// The number of window steps each iteration of the window benchmarks takes.
+const int kWindowSteps = 256;
+
+// Every step slides the window by one point and takes the hull of it.
+void BM_SlidingWindowConvexHull(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  int window = state.range(1);
+  vector<Point> points = RandomPoints(distribution, window + kWindowSteps,
+                                      kSeed);
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    SlidingWindowConvexHull hull;
+    for (int i = 0; i < window; ++i) {
+      hull.Insert(points[i]);
+    }
+    state.ResumeTiming();
+    for (int i = window; i < window + kWindowSteps; ++i) {
+      hull.Insert(points[i]);
+      hull.RemoveOldest();
+      benchmark::DoNotOptimize(hull.Snapshot());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kWindowSteps);
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_SlidingWindowConvexHull)->Apply(WindowSizes);
+
+// The same steps with ConvexHull run from scratch on every window.
+void BM_SlidingWindowConvexHull_Recompute(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  int window = state.range(1);
+  vector<Point> points = RandomPoints(distribution, window + kWindowSteps,
+                                      kSeed);
+  while (state.KeepRunning()) {
+    for (int i = window; i < window + kWindowSteps; ++i) {
+      vector<Point> in_window(points.begin() + i + 1 - window,
+                              points.begin() + i + 1);
+      benchmark::DoNotOptimize(ConvexHull(in_window));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kWindowSteps);
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_SlidingWindowConvexHull_Recompute)->Apply(WindowSizes);
+
+// Arguments: {PointDistribution, number of points, number of threads}.
+void ThreadScaling(benchmark::internal::Benchmark* b) {
+  for (int distribution : {UNIFORM_SQUARE, CLUSTERED}) {
+    for (int n : {1 << 20, 1 << 23}) {
+      for (int num_threads : {1, 2, 4, 8, 16}) {
+        b->Args({distribution, n, num_threads});
+      }
+    }
+  }
+}
+
+void BM_ParallelConvexHull(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  vector<Point> points = RandomPoints(distribution, state.range(1), kSeed);
+  int num_threads = state.range(2);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(ParallelConvexHull(points, num_threads));
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_ParallelConvexHull)->Apply(ThreadScaling)->UseRealTime();
+
+// Arguments: {0 for RandomTrack or 1 for the outline of RandomPolygon,
+// number of vertices}.
+void Polylines(benchmark::internal::Benchmark* b) {
+  for (int shape : {0, 1}) {
+    for (int n = 1 << 8; n <= 1 << 20; n <<= 2) {
+      b->Args({shape, n});
+    }
+  }
+}
+
+vector<Point> RandomPolyline(int shape, int n) {
+  return shape == 0 ? RandomTrack(n, kSeed) : RandomPolygon(n, kSeed).points;
+}
+
+// ConvexHull on the same input, which ignores the order of the vertices.
+void BM_ConvexHull_Polyline(benchmark::State& state) {
+  vector<Point> polyline = RandomPolyline(state.range(0), state.range(1));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(ConvexHull(polyline));
+  }
+  state.SetItemsProcessed(state.iterations() * polyline.size());
+  state.SetLabel(state.range(0) == 0 ? "track" : "outline");
+}
+BENCHMARK(BM_ConvexHull_Polyline)->Apply(Polylines);
+
+void BM_PolylineConvexHull(benchmark::State& state) {
+  vector<Point> polyline = RandomPolyline(state.range(0), state.range(1));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(PolylineConvexHull(polyline));
+  }
+  state.SetItemsProcessed(state.iterations() * polyline.size());
+  state.SetLabel(state.range(0) == 0 ? "track" : "outline");
+}
+BENCHMARK(BM_PolylineConvexHull)->Apply(Polylines);
+
+}  // namespace
@@ -0,0 +1,103 @@
+#include <vector>
+#include "base/predicates.h"
+#include "base/workload.h"
+#include "benchmark/benchmark.h"
+#include "chapter1/convex-hull.h"
+#include "chapter1/convex-polygon-index.h"
+
+using std::vector;
+
+namespace {
+
+const unsigned kSeed = 1;
+
+// Query points per iteration.
+const int kQueries = 1 << 14;
+
+// Arguments: {number of hull vertices}.
+void Sizes(benchmark::internal::Benchmark* b) {
+  for (int h : {1 << 4, 1 << 8, 1 << 12, 1 << 16}) {
+    b->Arg(h);
+  }
+}
+
+Polygon Hull(int h) {
+  return ConvexHull(RandomPoints(ON_CIRCLE, h, kSeed));
+}
+
+// A scan of all edges, which the index replaces.
+void BM_ConvexPolygon_ContainsScan(benchmark::State& state) {
+  Polygon hull = Hull(state.range(0));
+  const vector<Point>& v = hull.points;
+  vector<Point> points = RandomPoints(UNIFORM_SQUARE, 256, kSeed);
+  while (state.KeepRunning()) {
+    for (Point p : points) {
+      bool inside = true;
+      for (size_t i = 0; i < v.size(); ++i) {
+        inside &= Orientation(v[i], v[i + 1 == v.size() ? 0 : i + 1], p) <= 0;
+      }
+      benchmark::DoNotOptimize(inside);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_ConvexPolygon_ContainsScan)->Apply(Sizes);
+
+void BM_ConvexPolygonIndex_Contains(benchmark::State& state) {
+  ConvexPolygonIndex index(Hull(state.range(0)));
+  vector<Point> points = RandomPoints(UNIFORM_SQUARE, kQueries, kSeed);
+  while (state.KeepRunning()) {
+    for (Point p : points) {
+      benchmark::DoNotOptimize(index.Contains(p));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_ConvexPolygonIndex_Contains)->Apply(Sizes);
+
+void BM_ConvexPolygonIndex_ContainsBatch(benchmark::State& state) {
+  ConvexPolygonIndex index(Hull(state.range(0)));
+  vector<Point> points = RandomPoints(UNIFORM_SQUARE, kQueries, kSeed);
+  vector<signed char> inside(points.size());
+  while (state.KeepRunning()) {
+    index.Contains(points, inside);
+    benchmark::DoNotOptimize(inside.data());
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_ConvexPolygonIndex_ContainsBatch)->Apply(Sizes);
+
+void BM_ConvexPolygonIndex_ExtremeVertices(benchmark::State& state) {
+  ConvexPolygonIndex index(Hull(state.range(0)));
+  vector<Point> directions = RandomPoints(UNIFORM_DISK, kQueries, kSeed);
+  for (Point& d : directions) {
+    d = Point(d.x - 0.5, d.y - 0.5);
+  }
+  vector<size_t> vertices(directions.size());
+  while (state.KeepRunning()) {
+    index.ExtremeVertices(directions, vertices);
+    benchmark::DoNotOptimize(vertices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * directions.size());
+}
+BENCHMARK(BM_ConvexPolygonIndex_ExtremeVertices)->Apply(Sizes);
+
+// Points around the hull, all outside it.
+void BM_ConvexPolygonIndex_Tangents(benchmark::State& state) {
+  ConvexPolygonIndex index(Hull(state.range(0)));
+  vector<Point> points = RandomPoints(ON_CIRCLE, kQueries, kSeed + 1);
+  for (Point& p : points) {
+    p = Point(2 * p.x - 0.5, 2 * p.y - 0.5);
+  }
+  while (state.KeepRunning()) {
+    for (Point p : points) {
+      size_t first, second;
+      benchmark::DoNotOptimize(index.Tangents(p, &first, &second));
+      benchmark::DoNotOptimize(first);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_ConvexPolygonIndex_Tangents)->Apply(Sizes);
+
+}  // namespace
@@ -0,0 +1,65 @@
+#include <vector>
+#include "base/workload.h"
+#include "benchmark/benchmark.h"
+#include "chapter2/dcel.h"
+#include "chapter2/segment-intersection.h"
+
+using std::vector;
+
+namespace {
+
+const unsigned kSeed = 1;
+
+// Arguments: {number of faces of each subdivision}.
+void Sizes(benchmark::internal::Benchmark* b) {
+  for (int n : {1 << 10, 1 << 14, 1 << 18}) {
+    b->Arg(n);
+  }
+}
+
+void BM_Dcel_FromSegments(benchmark::State& state) {
+  vector<Segment> segments = RandomSubdivision(state.range(0), kSeed);
+  size_t bytes = 0;
+  while (state.KeepRunning()) {
+    Dcel dcel = Dcel::FromSegments(segments);
+    bytes = dcel.bytes_used();
+  }
+  state.SetItemsProcessed(state.iterations() * segments.size());
+  state.counters["bytes_per_edge"] =
+      static_cast<double>(bytes) / segments.size();
+}
+BENCHMARK(BM_Dcel_FromSegments)->Apply(Sizes);
+
+// The sweep that MapOverlay runs first, for comparison.
+void BM_Dcel_RedBlueSweep(benchmark::State& state) {
+  vector<Segment> red = RandomSubdivision(state.range(0), kSeed);
+  vector<Segment> blue = RandomSubdivision(state.range(0), kSeed + 1);
+  while (state.KeepRunning()) {
+    size_t count = 0;
+    FindRedBlueIntersections(red, blue, [&](const RedBlueIntersection&) {
+      ++count;
+      return true;
+    });
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * (red.size() + blue.size()));
+}
+BENCHMARK(BM_Dcel_RedBlueSweep)->Apply(Sizes);
+
+void BM_MapOverlay(benchmark::State& state) {
+  Dcel red = Dcel::FromSegments(RandomSubdivision(state.range(0), kSeed));
+  Dcel blue =
+      Dcel::FromSegments(RandomSubdivision(state.range(0), kSeed + 1));
+  vector<OverlayLabel> labels;
+  size_t num_edges = 0;
+  while (state.KeepRunning()) {
+    Dcel overlay = MapOverlay(red, blue, &labels);
+    num_edges = overlay.num_edges();
+  }
+  state.SetItemsProcessed(state.iterations()
+                          * (red.num_edges() + blue.num_edges()));
+  state.counters["overlay_edges"] = num_edges;
+}
+BENCHMARK(BM_MapOverlay)->Apply(Sizes);
+
+}  // namespace
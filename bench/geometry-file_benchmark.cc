@@ -0,0 +1,80 @@
+#include <fstream>
+#include <string>
+#include <vector>
+#include "base/geometry-file.h"
+#include "base/workload.h"
+#include "benchmark/benchmark.h"
+#include "chapter1/convex-hull.h"
+#include "chapter2/segment-intersection.h"
+
+using std::string;
+using std::vector;
+
+namespace {
+
+const unsigned kSeed = 1;
+
+string BenchPath(const string& name) {
+  return "/tmp/geometry-file_benchmark_" + name;
+}
+
+// Arguments: {number of points}.
+void Sizes(benchmark::internal::Benchmark* b) {
+  b->Arg(1 << 16);
+  b->Arg(1 << 20);
+}
+
+// Loading points from text, one "x y" line per point, as the files we
+// receive are stored today.
+void BM_ConvexHull_TextFile(benchmark::State& state) {
+  string path = BenchPath("points.txt");
+  {
+    std::ofstream out(path);
+    out.precision(17);
+    for (Point p : RandomPoints(UNIFORM_DISK, state.range(0), kSeed)) {
+      out << p.x << " " << p.y << "\n";
+    }
+  }
+  while (state.KeepRunning()) {
+    std::ifstream in(path);
+    vector<Point> points;
+    Point p;
+    while (in >> p.x >> p.y) {
+      points.push_back(p);
+    }
+    benchmark::DoNotOptimize(ConvexHull(points));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ConvexHull_TextFile)->Apply(Sizes);
+
+// Mapping the file each time; the pages stay in the page cache, as they
+// would for a file read recently.
+void BM_ConvexHull_MappedFile(benchmark::State& state) {
+  string path = BenchPath("points.geob");
+  WritePointFile(path, RandomPoints(UNIFORM_DISK, state.range(0), kSeed),
+                 nullptr);
+  while (state.KeepRunning()) {
+    MappedGeometryFile file;
+    file.Open(path, nullptr);
+    benchmark::DoNotOptimize(ConvexHull(file.points()));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ConvexHull_MappedFile)->Apply(Sizes);
+
+void BM_FindIntersections_MappedFile(benchmark::State& state) {
+  string path = BenchPath("segments.geob");
+  WriteSegmentFile(path,
+                   RandomSegments(SHORT_SEGMENTS, state.range(0), kSeed),
+                   nullptr);
+  while (state.KeepRunning()) {
+    MappedGeometryFile file;
+    file.Open(path, nullptr);
+    benchmark::DoNotOptimize(FindIntersections(file.segments()));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FindIntersections_MappedFile)->Arg(1 << 16);
+
+}  // namespace
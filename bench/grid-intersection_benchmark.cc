@@ -0,0 +1,81 @@
+#include <vector>
+#include "base/workload.h"
+#include "benchmark/benchmark.h"
+#include "chapter2/grid-intersection.h"
+#include "chapter2/segment-intersection.h"
+
+using std::vector;
+
+namespace {
+
+const unsigned kSeed = 1;
+
+// Arguments: {SegmentDistribution, number of segments}. Long segments have a
+// quadratic number of crossings, so they stop at smaller sizes.
+void Workloads(benchmark::internal::Benchmark* b) {
+  for (int n : {1 << 10, 1 << 14, 1 << 18}) {
+    b->Args({SHORT_SEGMENTS, n});
+  }
+  for (int n : {1 << 10, 1 << 14}) {
+    b->Args({AXIS_PARALLEL_SEGMENTS, n});
+  }
+  for (int n : {1 << 8, 1 << 11}) {
+    b->Args({LONG_SEGMENTS, n});
+  }
+}
+
+void BM_Sweep(benchmark::State& state) {
+  auto distribution = static_cast<SegmentDistribution>(state.range(0));
+  vector<Segment> segments =
+      RandomSegments(distribution, state.range(1), kSeed);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(FindIntersections(segments));
+  }
+  state.SetItemsProcessed(state.iterations() * segments.size());
+  state.SetLabel(SegmentDistributionName(distribution));
+}
+BENCHMARK(BM_Sweep)->Apply(Workloads);
+
+void BM_Grid(benchmark::State& state) {
+  auto distribution = static_cast<SegmentDistribution>(state.range(0));
+  vector<Segment> segments =
+      RandomSegments(distribution, state.range(1), kSeed);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(
+        GridFindIntersections(segments, GridIntersectionOptions()));
+  }
+  state.SetItemsProcessed(state.iterations() * segments.size());
+  state.SetLabel(SegmentDistributionName(distribution));
+}
+BENCHMARK(BM_Grid)->Apply(Workloads);
+
+// Includes the time to choose the engine.
+void BM_Auto(benchmark::State& state) {
+  auto distribution = static_cast<SegmentDistribution>(state.range(0));
+  vector<Segment> segments =
+      RandomSegments(distribution, state.range(1), kSeed);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(AutoFindIntersections(segments));
+  }
+  state.SetItemsProcessed(state.iterations() * segments.size());
+  state.SetLabel(SegmentDistributionName(distribution));
+  state.counters["grid"] = ChooseIntersectionEngine(segments) == GRID_ENGINE;
+}
+BENCHMARK(BM_Auto)->Apply(Workloads);
+
+// Arguments: {number of segments, number of threads}.
+void BM_Grid_Threads(benchmark::State& state) {
+  vector<Segment> segments =
+      RandomSegments(SHORT_SEGMENTS, state.range(0), kSeed);
+  GridIntersectionOptions options;
+  options.num_threads = state.range(1);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(GridFindIntersections(segments, options));
+  }
+  state.SetItemsProcessed(state.iterations() * segments.size());
+}
+BENCHMARK(BM_Grid_Threads)
+    ->Args({1 << 20, 1})->Args({1 << 20, 2})->Args({1 << 20, 4})
+    ->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,17 @@
+#include <string>
+#include <vector>
+#include "benchmark/benchmark.h"
+
+// Runs every registered benchmark. Results are printed as JSON by default so
+// that runs from different releases can be diffed; pass
+// --benchmark_format=console for a human-readable table.
+int main(int argc, char** argv) {
+  std::string json_format = "--benchmark_format=json";
+  std::vector<char*> args(argv, argv + argc);
+  // Flags given on the command line come later and therefore take precedence.
+  args.insert(args.begin() + 1, &json_format[0]);
+  int args_count = args.size();
+  benchmark::Initialize(&args_count, args.data());
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -0,0 +1,100 @@
+#include <vector>
+#include "base/workload.h"
+#include "benchmark/benchmark.h"
+#include "chapter6/polygon-index.h"
+
+using std::vector;
+
+namespace {
+
+const unsigned kSeed = 1;
+
+// Query points per iteration.
+const int kQueries = 1 << 16;
+
+// Arguments: {number of polygon vertices}.
+void Sizes(benchmark::internal::Benchmark* b) {
+  for (int n : {1 << 6, 1 << 10, 1 << 14, 1 << 18}) {
+    b->Arg(n);
+  }
+}
+
+void BM_PointInPolygon(benchmark::State& state) {
+  Polygon polygon = RandomPolygon(state.range(0), kSeed);
+  // The test is linear in the polygon size, so it gets fewer points.
+  vector<Point> points = RandomPoints(UNIFORM_SQUARE, 256, kSeed);
+  while (state.KeepRunning()) {
+    for (Point p : points) {
+      benchmark::DoNotOptimize(PointInPolygon(polygon, p));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_PointInPolygon)->Apply(Sizes);
+
+void BM_PolygonIndex_Build(benchmark::State& state) {
+  Polygon polygon = RandomPolygon(state.range(0), kSeed);
+  while (state.KeepRunning()) {
+    PolygonIndex index(polygon);
+    benchmark::DoNotOptimize(index.num_rows());
+  }
+  state.SetItemsProcessed(state.iterations() * polygon.points.size());
+}
+BENCHMARK(BM_PolygonIndex_Build)->Apply(Sizes);
+
+void BM_PolygonIndex_Contains(benchmark::State& state) {
+  PolygonIndex index(RandomPolygon(state.range(0), kSeed));
+  vector<Point> points = RandomPoints(UNIFORM_SQUARE, kQueries, kSeed);
+  while (state.KeepRunning()) {
+    for (Point p : points) {
+      benchmark::DoNotOptimize(index.Contains(p));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_PolygonIndex_Contains)->Apply(Sizes);
+
+// Points near the boundary, all in cells with edges.
+void BM_PolygonIndex_Contains_NearBoundary(benchmark::State& state) {
+  Polygon polygon = RandomPolygon(state.range(0), kSeed);
+  PolygonIndex index(polygon);
+  vector<Point> points;
+  const vector<Point>& v = polygon.points;
+  for (Point p : RandomPoints(UNIFORM_SQUARE, kQueries, kSeed)) {
+    Point a = v[points.size() % v.size()];
+    Point b = v[(points.size() + 1) % v.size()];
+    points.push_back(Point(a.x + p.x * (b.x - a.x) + 1e-4 * (p.y - 0.5),
+                           a.y + p.x * (b.y - a.y) + 1e-4 * (p.y - 0.5)));
+  }
+  while (state.KeepRunning()) {
+    for (Point p : points) {
+      benchmark::DoNotOptimize(index.Contains(p));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_PolygonIndex_Contains_NearBoundary)->Apply(Sizes);
+
+// Arguments: {number of polygon vertices, number of threads}.
+void BatchSizes(benchmark::internal::Benchmark* b) {
+  for (int n : {1 << 10, 1 << 18}) {
+    for (int num_threads : {1, 4}) {
+      b->Args({n, num_threads});
+    }
+  }
+}
+
+void BM_PolygonIndex_ContainsBatch(benchmark::State& state) {
+  PolygonIndex index(RandomPolygon(state.range(0), kSeed));
+  vector<Point> points = RandomPoints(UNIFORM_SQUARE, 16 * kQueries, kSeed);
+  vector<signed char> inside(points.size());
+  int num_threads = state.range(1);
+  while (state.KeepRunning()) {
+    index.Contains(points, inside, num_threads);
+    benchmark::DoNotOptimize(inside.data());
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_PolygonIndex_ContainsBatch)->Apply(BatchSizes)->UseRealTime();
+
+}  // namespace
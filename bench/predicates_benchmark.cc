@@ -0,0 +1,97 @@
+#include <cmath>
+#include <string>
+#include <vector>
+#include "base/base.h"
+#include "base/predicates.h"
+#include "base/workload.h"
+#include "benchmark/benchmark.h"
+
+using predicates_internal::OrientationFilterDecides;
+using std::vector;
+
+namespace {
+
+const unsigned kSeed = 1;
+const int kNumTriples = 4096;
+
+// Arguments: {PointDistribution, whether to move the points to UTM-like
+// coordinates around (500000, 4000000) meters}.
+void Distributions(benchmark::internal::Benchmark* b) {
+  for (int distribution : {UNIFORM_SQUARE, CLUSTERED, DEGENERATE}) {
+    for (int large : {0, 1}) {
+      b->Args({distribution, large});
+    }
+  }
+}
+
+vector<Point> Triples(const benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  vector<Point> points = RandomPoints(distribution, 3 * kNumTriples, kSeed);
+  if (state.range(1)) {
+    for (Point& p : points) {
+      p = Point(500000 + 1000 * p.x, 4000000 + 1000 * p.y);
+    }
+  }
+  return points;
+}
+
+std::string Label(const benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  return std::string(PointDistributionName(distribution))
+      + (state.range(1) ? "/utm" : "");
+}
+
+// The predicate Orientation replaced: the line coefficients of DirectedLine
+// compared against a fixed tolerance.
+int EpsilonOrientation(Point p1, Point p2, Point p3) {
+  const double kEpsilon = 0.0000000001;
+  double a = p3.y - p1.y;
+  double b = p1.x - p3.x;
+  double c = p3.x * p1.y - p1.x * p3.y;
+  double determinant = a * p2.x + b * p2.y + c;
+  return (determinant > kEpsilon) - (determinant < -kEpsilon);
+}
+
+void BM_EpsilonOrientation(benchmark::State& state) {
+  vector<Point> points = Triples(state);
+  while (state.KeepRunning()) {
+    int sum = 0;
+    for (size_t i = 0; i < points.size(); i += 3) {
+      sum += EpsilonOrientation(points[i], points[i + 1], points[i + 2]);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumTriples);
+  state.SetLabel(Label(state));
+}
+BENCHMARK(BM_EpsilonOrientation)->Apply(Distributions);
+
+// Reports how often the floating-point filter decides on its own and how
+// often the fixed tolerance disagrees with the exact answer.
+void BM_Orientation(benchmark::State& state) {
+  vector<Point> points = Triples(state);
+  int decided = 0;
+  int epsilon_wrong = 0;
+  for (size_t i = 0; i < points.size(); i += 3) {
+    decided += OrientationFilterDecides(points[i], points[i + 1], points[i + 2]);
+    epsilon_wrong +=
+        EpsilonOrientation(points[i], points[i + 1], points[i + 2])
+        != Orientation(points[i], points[i + 1], points[i + 2]);
+  }
+  while (state.KeepRunning()) {
+    int sum = 0;
+    for (size_t i = 0; i < points.size(); i += 3) {
+      sum += Orientation(points[i], points[i + 1], points[i + 2]);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.counters["filter_hit_rate"] =
+      static_cast<double>(decided) / kNumTriples;
+  state.counters["epsilon_error_rate"] =
+      static_cast<double>(epsilon_wrong) / kNumTriples;
+  state.SetItemsProcessed(state.iterations() * kNumTriples);
+  state.SetLabel(Label(state));
+}
+BENCHMARK(BM_Orientation)->Apply(Distributions);
+
+}  // namespace
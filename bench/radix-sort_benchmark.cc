@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <vector>
+#include "base/base.h"
+#include "base/radix-sort.h"
+#include "base/workload.h"
+#include "benchmark/benchmark.h"
+
+using std::vector;
+
+namespace {
+
+const unsigned kSeed = 1;
+
+// Arguments: {PointDistribution, number of points}.
+void Distributions(benchmark::internal::Benchmark* b) {
+  for (int distribution : {UNIFORM_SQUARE, CLUSTERED, DEGENERATE}) {
+    for (int n : {1 << 10, 1 << 16, 1 << 20}) {
+      b->Args({distribution, n});
+    }
+  }
+}
+
+// Both benchmarks time the copy of the input as well as the sort.
+void BM_StdSortLexicographically(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  vector<Point> points = RandomPoints(distribution, state.range(1), kSeed);
+  vector<Point> sorted(points.size());
+  while (state.KeepRunning()) {
+    std::copy(points.begin(), points.end(), sorted.begin());
+    std::sort(sorted.begin(), sorted.end(), LexicographicLess);
+    benchmark::DoNotOptimize(sorted.data());
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_StdSortLexicographically)->Apply(Distributions);
+
+void BM_SortLexicographically(benchmark::State& state) {
+  auto distribution = static_cast<PointDistribution>(state.range(0));
+  vector<Point> points = RandomPoints(distribution, state.range(1), kSeed);
+  vector<Point> sorted(points.size());
+  vector<Point> scratch(points.size());
+  while (state.KeepRunning()) {
+    std::copy(points.begin(), points.end(), sorted.begin());
+    SortLexicographically(sorted.data(), sorted.size(), scratch.data());
+    benchmark::DoNotOptimize(sorted.data());
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+  state.SetLabel(PointDistributionName(distribution));
+}
+BENCHMARK(BM_SortLexicographically)->Apply(Distributions);
+
+// Arguments: {number of threads}.
+void BM_SortLexicographically_Threads(benchmark::State& state) {
+  vector<Point> points = RandomPoints(UNIFORM_SQUARE, 1 << 22, kSeed);
+  vector<Point> sorted(points.size());
+  vector<Point> scratch(points.size());
+  while (state.KeepRunning()) {
+    std::copy(points.begin(), points.end(), sorted.begin());
+    SortLexicographically(sorted.data(), sorted.size(), scratch.data(),
+                          state.range(0));
+    benchmark::DoNotOptimize(sorted.data());
+  }
+  state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_SortLexicographically_Threads)
+    ->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "base/workload.h"
+#include "benchmark/benchmark.h"
+#include "chapter2/segment-intersection.h"
+
+using segment_intersection_internal::PreparedSegment;
+using segment_intersection_internal::SegmentComparator;
+using std::vector;
+
+namespace {
+
+const unsigned kSeed = 1;
+
+// Arguments: {SegmentDistribution, number of segments}. Long segments have a
+// quadratic number of crossings, so they stop at smaller sizes.
+void AllDistributions(benchmark::internal::Benchmark* b) {
+  for (int n = 1 << 6; n <= 1 << 14; n <<= 2) {
+    b->Args({SHORT_SEGMENTS, n});
+    b->Args({AXIS_PARALLEL_SEGMENTS, n});
+  }
+  for (int n = 1 << 4; n <= 1 << 10; n <<= 2) {
+    b->Args({LONG_SEGMENTS, n});
+  }
+}
+
+void BM_FindIntersections(benchmark::State& state) {
+  auto distribution = static_cast<SegmentDistribution>(state.range(0));
+  vector<Segment> segments =
+      RandomSegments(distribution, state.range(1), kSeed);
+  size_t num_intersections = 0;
+  while (state.KeepRunning()) {
+    auto intersections = FindIntersections(segments);
+    num_intersections = intersections.size();
+    benchmark::DoNotOptimize(intersections);
+  }
+  state.SetItemsProcessed(state.iterations() * segments.size());
+  state.SetLabel(SegmentDistributionName(distribution));
+  state.counters["intersections"] = num_intersections;
+}
+BENCHMARK(BM_FindIntersections)->Apply(AllDistributions);
+
+void BM_FindIntersectionsVisitor(benchmark::State& state) {
+  auto distribution = static_cast<SegmentDistribution>(state.range(0));
+  vector<Segment> segments =
+      RandomSegments(distribution, state.range(1), kSeed);
+  size_t num_intersections = 0;
+  while (state.KeepRunning()) {
+    num_intersections = 0;
+    FindIntersections(segments, [&](const Intersection&) {
+      ++num_intersections;
+      return true;
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * segments.size());
+  state.SetLabel(SegmentDistributionName(distribution));
+  state.counters["intersections"] = num_intersections;
+}
+BENCHMARK(BM_FindIntersectionsVisitor)->Apply(AllDistributions);
+
+// Arguments: {SegmentDistribution, number of segments, number of threads}.
+void ThreadScaling(benchmark::internal::Benchmark* b) {
+  for (int num_threads : {1, 2, 4, 8, 16}) {
+    b->Args({SHORT_SEGMENTS, 1 << 18, num_threads});
+    b->Args({AXIS_PARALLEL_SEGMENTS, 1 << 14, num_threads});
+    b->Args({LONG_SEGMENTS, 1 << 11, num_threads});
+  }
+}
+
+void BM_ParallelFindIntersections(benchmark::State& state) {
+  auto distribution = static_cast<SegmentDistribution>(state.range(0));
+  vector<Segment> segments =
+      RandomSegments(distribution, state.range(1), kSeed);
+  int num_threads = state.range(2);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(ParallelFindIntersections(segments, num_threads));
+  }
+  state.SetItemsProcessed(state.iterations() * segments.size());
+  state.SetLabel(SegmentDistributionName(distribution));
+}
+BENCHMARK(BM_ParallelFindIntersections)->Apply(ThreadScaling)->UseRealTime();
+
+// A planar layer of num_lines polylines of num_vertices vertices each, like a
+// road or river network. The lines wiggle from left to right in separate
+// bands, so they never cross each other. The layer is transposed if vertical.
+vector<Segment> PolylineLayer(int num_lines, int num_vertices, bool vertical,
+                              unsigned seed) {
+  vector<Point> jitter = RandomPoints(UNIFORM_SQUARE,
+                                      num_lines * num_vertices, seed);
+  double band = 1.0 / num_lines;
+  vector<Segment> segments;
+  for (int line = 0; line < num_lines; ++line) {
+    Point previous;
+    for (int i = 0; i < num_vertices; ++i) {
+      double along = (i + jitter[line * num_vertices + i].x * 0.5)
+          / num_vertices;
+      double across = (line + 0.5) * band
+          + (jitter[line * num_vertices + i].y - 0.5)
+                * std::min(0.8 * band, 1.0 / num_vertices);
+      Point p = vertical ? Point(across, along) : Point(along, across);
+      if (i > 0) {
+        segments.push_back(Segment(previous, p));
+      }
+      previous = p;
+    }
+  }
+  return segments;
+}
+
+// Arguments: {lines per layer, vertices per line}.
+void Layers(benchmark::internal::Benchmark* b) {
+  b->Args({16, 1 << 10});
+  b->Args({64, 1 << 10});
+  b->Args({256, 1 << 8});
+}
+
+// Finds where roads cross rivers with FindIntersections, which also reports
+// every vertex shared by two segments of the same layer.
+void BM_RedBlueLayers_FindIntersections(benchmark::State& state) {
+  vector<Segment> segments =
+      PolylineLayer(state.range(0), state.range(1), false, kSeed);
+  vector<Segment> blue =
+      PolylineLayer(state.range(0), state.range(1), true, kSeed + 1);
+  size_t num_red = segments.size();
+  segments.insert(segments.end(), blue.begin(), blue.end());
+  size_t num_red_blue = 0;
+  while (state.KeepRunning()) {
+    num_red_blue = 0;
+    FindIntersections(segments, [&](const Intersection& intersection) {
+      bool red = false;
+      bool blue = false;
+      for (const vector<int>* indices : {&intersection.starting,
+                                         &intersection.ending,
+                                         &intersection.containing}) {
+        for (int i : *indices) {
+          (i < num_red ? red : blue) = true;
+        }
+      }
+      num_red_blue += red && blue;
+      return true;
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * segments.size());
+  state.counters["red_blue"] = num_red_blue;
+}
+BENCHMARK(BM_RedBlueLayers_FindIntersections)->Apply(Layers);
+
+void BM_RedBlueLayers_FindRedBlueIntersections(benchmark::State& state) {
+  vector<Segment> red =
+      PolylineLayer(state.range(0), state.range(1), false, kSeed);
+  vector<Segment> blue =
+      PolylineLayer(state.range(0), state.range(1), true, kSeed + 1);
+  size_t num_red_blue = 0;
+  while (state.KeepRunning()) {
+    num_red_blue = 0;
+    FindRedBlueIntersections(red, blue,
+                             [&](const RedBlueIntersection&) {
+                               ++num_red_blue;
+                               return true;
+                             });
+  }
+  state.SetItemsProcessed(state.iterations() * (red.size() + blue.size()));
+  state.counters["red_blue"] = num_red_blue;
+}
+BENCHMARK(BM_RedBlueLayers_FindRedBlueIntersections)->Apply(Layers);
+
+// Checks that one layer is planar: its polylines only meet at shared
+// vertices, so the whole layer has to be swept.
+void BM_PlanarLayer_FindIntersections(benchmark::State& state) {
+  vector<Segment> segments =
+      PolylineLayer(state.range(0), state.range(1), false, kSeed);
+  while (state.KeepRunning()) {
+    bool planar = true;
+    FindIntersections(segments, [&](const Intersection& intersection) {
+      planar = !intersection.containing.empty() ||
+          intersection.starting.size() + intersection.ending.size() <= 2;
+      return planar;
+    });
+    benchmark::DoNotOptimize(planar);
+  }
+  state.SetItemsProcessed(state.iterations() * segments.size());
+}
+BENCHMARK(BM_PlanarLayer_FindIntersections)->Apply(Layers);
+
+void BM_PlanarLayer_AnyIntersection(benchmark::State& state) {
+  vector<Segment> segments =
+      PolylineLayer(state.range(0), state.range(1), false, kSeed);
+  AnyIntersectionOptions options;
+  options.ignore_shared_endpoints = true;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(AnyIntersection(segments, options, nullptr));
+  }
+  state.SetItemsProcessed(state.iterations() * segments.size());
+}
+BENCHMARK(BM_PlanarLayer_AnyIntersection)->Apply(Layers);
+
+// Segments spanning the whole unit square from left to right, so that every
+// pair can be compared at any event point inside it.
+vector<Segment> SpanningSegments(int n) {
+  vector<Point> left = RandomPoints(UNIFORM_SQUARE, n, kSeed);
+  vector<Point> right = RandomPoints(UNIFORM_SQUARE, n, kSeed + 1);
+  vector<Segment> segments;
+  for (int i = 0; i < n; ++i) {
+    segments.push_back(Segment(Point(0, left[i].y), Point(1, right[i].y)));
+  }
+  return segments;
+}
+
+const int kNumComparedSegments = 1024;
+
+// SegmentComparator as it was before segments were prepared, copied
+// unchanged: every y_for_x call builds a DirectedLine and divides.
+class SegmentYForXComparator {
+ public:
+  enum SweepLineShift { NONE, BACKWARD, FORWARD };
+
+  SegmentYForXComparator(Point event_point, SweepLineShift shift)
+      : event_point_(event_point), shift_(shift) {}
+
+  bool operator()(const Segment* lhs, const Segment* rhs) const {
+    const double kEpsilon = 0.00000001;
+    if (lhs->is_vertical() && rhs->is_vertical()) {
+      // Both vertical.
+      return false;
+
+    } else if (lhs->is_vertical()) {
+      double diff = event_point_.y - rhs->y_for_x(event_point_.x);
+      return diff < (shift_ == BACKWARD ? kEpsilon : -kEpsilon);
+
+    } else if (rhs->is_vertical()) {
+      double diff = lhs->y_for_x(event_point_.x) - event_point_.y;
+      return diff < (shift_ == FORWARD ? kEpsilon : -kEpsilon);
+
+    } else {
+      // Neither vertical.
+      double diff =
+          lhs->y_for_x(event_point_.x) - rhs->y_for_x(event_point_.x);
+      if (std::fabs(diff) > kEpsilon) {
+        return diff < 0;
+      } else if (shift_ != NONE) {
+        double shifted = event_point_.x + ((shift_ == FORWARD) ? 1 : -1);
+        diff = lhs->y_for_x(shifted) - rhs->y_for_x(shifted);
+        if (std::fabs(diff) > kEpsilon) {
+          return diff < 0;
+        }
+      }
+      return false;
+    }
+  }
+
+ private:
+  Point event_point_;
+  SweepLineShift shift_;
+};
+
+void BM_CompareSegments_YForX(benchmark::State& state) {
+  vector<Segment> segments = SpanningSegments(kNumComparedSegments);
+  SegmentYForXComparator less(Point(0.5, 0.5),
+                              SegmentYForXComparator::FORWARD);
+  size_t i = 0;
+  int num_less = 0;
+  while (state.KeepRunning()) {
+    const Segment& lhs = segments[i % kNumComparedSegments];
+    const Segment& rhs = segments[(i * 7 + 1) % kNumComparedSegments];
+    num_less += less(&lhs, &rhs);
+    ++i;
+  }
+  benchmark::DoNotOptimize(num_less);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CompareSegments_YForX);
+
+void BM_CompareSegments_Prepared(benchmark::State& state) {
+  vector<Segment> segments = SpanningSegments(kNumComparedSegments);
+  vector<PreparedSegment> prepared(segments.begin(), segments.end());
+  SegmentComparator less(Point(0.5, 0.5), SegmentComparator::FORWARD);
+  size_t i = 0;
+  int num_less = 0;
+  while (state.KeepRunning()) {
+    const PreparedSegment& lhs = prepared[i % kNumComparedSegments];
+    const PreparedSegment& rhs = prepared[(i * 7 + 1) % kNumComparedSegments];
+    num_less += less(&lhs, &rhs);
+    ++i;
+  }
+  benchmark::DoNotOptimize(num_less);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CompareSegments_Prepared);
+
+}  // namespace
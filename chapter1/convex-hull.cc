@@ -1,13 +1,24 @@
 #include "chapter1/convex-hull.h"
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <utility>
 #include <vector>
+#include "base/batch-orientation.h"
+#include "base/parallel.h"
+#include "base/point-buffer.h"
+#include "base/predicates.h"
+#include "base/radix-sort.h"
+#include "base/stats.h"
 
 using std::make_pair;
 using std::pair;
+using std::string;
 using std::vector;
 
 Polygon SlowConvexHull(const vector<Point>& points) {
+  PointBuffer buffer(points);
   vector<pair<Point, Point>> e;
   for (int i = 0; i < points.size(); ++i) {
     Point p = points[i];
@@ -16,17 +27,9 @@ Polygon SlowConvexHull(const vector<Point>& points) {
         continue;
       }
       Point q = points[j];
-      DirectedLine line(p, q);
-      bool valid = true;
-      for (int k = 0; k < points.size(); ++k) {
-        if (k == i || k == j) {
-          continue;
-        }
-        Point r = points[k];
-        if (line.PointLiesToLeft(r)) {
-          valid = false;
-        }
-      }
+      // The innermost loop over all other points is done in one batch; p and
+      // q themselves lie exactly on the line and are never counted.
+      bool valid = CountPointsLeftOfLine(p, q, buffer) == 0;
       if (valid) {
         e.push_back(make_pair(p, q));
       }
@@ -64,32 +67,524 @@ Polygon SlowConvexHull(const vector<Point>& points) {
   return Polygon(l);
 }
 
+namespace {
+
+// Appends the points in [begin, end) to chain, dropping every point at which
+// the chain does not turn right.
+template <typename Iterator, typename P>
+void ExtendChain(Iterator begin, Iterator end, vector<P>* chain) {
+  for (Iterator it = begin; it != end; ++it) {
+    chain->push_back(*it);
+    while (chain->size() >= 3
+           && !PointsMakesRightTurn((*chain)[chain->size() - 3],
+                                    (*chain)[chain->size() - 2],
+                                    (*chain)[chain->size() - 1])) {
+      chain->erase(chain->end() - 2);
+    }
+  }
+}
+
+// The upper chain runs left to right and the lower chain right to left; both
+// include the two extreme points.
+template <typename T>
+BasicPolygon<T> JoinChains(vector<BasicPoint<T>> upper,
+                           const vector<BasicPoint<T>>& lower) {
+  if (lower.size() > 2) {
+    std::copy(lower.begin() + 1,
+              lower.end() - 1,
+              std::back_inserter(upper));
+  }
+  return BasicPolygon<T>(upper);
+}
+
+// Orders points lexicographically. Points with 32-bit integer coordinates
+// are packed into one 64-bit key and radix sorted in a single sort.
+template <typename T>
+void SortForHull(vector<BasicPoint<T>>* points) {
+  std::sort(points->begin(), points->end());
+}
+
+void SortForHull(vector<BasicPoint<int32_t>>* points) {
+  vector<BasicPoint<int32_t>> scratch(points->size());
+  RadixSort(points->data(), points->size(), scratch.data(),
+            [](BasicPoint<int32_t> p) {
+              // Flipping the sign bits orders signed values as unsigned.
+              return uint64_t(uint32_t(p.x) ^ 0x80000000u) << 32
+                  | (uint32_t(p.y) ^ 0x80000000u);
+            });
+}
+
+// Wraps the hull chain from start to end, moving in the direction in which
+// before orders points. ranges delimit chains of groups of points, each
+// ordered by before and turning right, that cover the hull. Returns false if
+// the chain has more than max_vertices vertices.
+template <typename Before>
+bool WrapChain(Point start, Point end, Before before,
+               const vector<Point>& chains,
+               const vector<pair<size_t, size_t>>& ranges,
+               size_t max_vertices, vector<Point>* chain) {
+  chain->assign(1, start);
+  Point p = start;
+  while (p != end) {
+    if (chain->size() == max_vertices) {
+      return false;
+    }
+    // The next vertex has no point to its left as seen from p; of collinear
+    // candidates it is the farthest.
+    bool found = false;
+    Point next;
+    for (auto range : ranges) {
+      const Point* first = chains.data() + range.first;
+      const Point* last = chains.data() + range.second;
+      first = std::upper_bound(first, last, p, before);
+      if (first == last) {
+        continue;
+      }
+      // Seen from p, the points ahead on a chain turn left up to the
+      // tangent point and right after it.
+      size_t lo = 0, hi = last - first - 1;
+      while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (Orientation(p, first[mid], first[mid + 1]) >= 0) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      Point candidate = first[lo];
+      if (!found) {
+        next = candidate;
+        found = true;
+      } else {
+        int orientation = Orientation(p, next, candidate);
+        if (orientation > 0 || (orientation == 0 && before(next, candidate))) {
+          next = candidate;
+        }
+      }
+    }
+    chain->push_back(next);
+    p = next;
+  }
+  return true;
+}
+
+// The extreme points in the eight axis and diagonal directions, in
+// counterclockwise order starting at the bottom, with repetitions removed.
+// Found in one pass without branches.
+vector<Point> ExtremeOctagon(Span<const Point> points) {
+  // Direction k is (cos, sin) of k * 45 degrees starting from -90, up to a
+  // positive factor.
+  const double kDirections[8][2] = {
+    {0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1},
+  };
+  Point extremes[8];
+  double best[8];
+  for (int k = 0; k < 8; ++k) {
+    extremes[k] = points[0];
+    best[k] = kDirections[k][0] * points[0].x + kDirections[k][1] * points[0].y;
+  }
+  for (Point p : points) {
+    for (int k = 0; k < 8; ++k) {
+      double value = kDirections[k][0] * p.x + kDirections[k][1] * p.y;
+      bool better = value > best[k];
+      best[k] = better ? value : best[k];
+      extremes[k] = better ? p : extremes[k];
+    }
+  }
+  vector<Point> octagon;
+  for (int k = 0; k < 8; ++k) {
+    if (octagon.empty() || octagon.back() != extremes[k]) {
+      octagon.push_back(extremes[k]);
+    }
+  }
+  while (octagon.size() > 1 && octagon.back() == octagon.front()) {
+    octagon.pop_back();
+  }
+  return octagon;
+}
+
+// The group size of the first attempt of OutputSensitiveConvexHull. The
+// attempts with 4 and 16 points per group of the textbook algorithm cost more
+// than a sort of the input when the hull is not tiny.
+const size_t kMinGroupSize = 256;
+
+// The number of points AdaptiveConvexHull samples to estimate the hull size.
+const size_t kHullSizeSamples = 1024;
+
+}  // namespace
+
+string ConvexHullStats::ToJson() const {
+  return NumbersToJson({{"input_points", input_points},
+                        {"culled_points", culled_points},
+                        {"cull_seconds", cull_seconds},
+                        {"sort_seconds", sort_seconds},
+                        {"scan_seconds", scan_seconds},
+                        {"merge_seconds", merge_seconds}});
+}
+
 Polygon ConvexHull(const std::vector<Point>& points) {
-  vector<Point> ordered = points;
-  std::sort(ordered.begin(), ordered.end(), LexicographicLess);
-  vector<Point> upper{ordered[0], ordered[1]};
-  for (int i = 2; i < ordered.size(); ++i) {
-    upper.push_back(ordered[i]);
-    while (upper.size() >= 3
-           && !PointsMakesRightTurn(upper[upper.size() - 3],
-                                    upper[upper.size() - 2],
-                                    upper[upper.size() - 1])) {
-      upper.erase(upper.end() - 2);
-    }
-  }
-  vector<Point> lower{ordered[ordered.size() - 1],
-                      ordered[ordered.size() - 2]};
-  for (int i = ordered.size() - 3; i >= 0; --i) {
-    lower.push_back(ordered[i]);
-    while (lower.size() >= 3
-           && !PointsMakesRightTurn(lower[lower.size() - 3],
-                                    lower[lower.size() - 2],
-                                    lower[lower.size() - 1])) {
-      lower.erase(lower.end() - 2);
-    }
-  }
-  std::copy(lower.begin() + 1,
-            lower.end() - 1,
-            std::back_inserter(upper));
-  return Polygon(upper);
+  return ConvexHull(Span<const Point>(points), ConvexHullOptions(), nullptr);
+}
+
+Polygon ConvexHull(const std::vector<Point>& points,
+                   const ConvexHullOptions& options,
+                   ConvexHullStats* stats) {
+  return ConvexHull(Span<const Point>(points), options, stats);
+}
+
+Polygon ConvexHull(Span<const Point> points) {
+  return ConvexHull(points, ConvexHullOptions(), nullptr);
+}
+
+Polygon ConvexHull(Span<const Point> points,
+                   const ConvexHullOptions& options,
+                   ConvexHullStats* stats) {
+  GEOMETRY_STATS_ONLY(Stopwatch stopwatch;)
+  vector<Point> ordered;
+  if (options.cull_interior_points && !points.empty()) {
+    // Points strictly inside the octagon are strictly inside the hull. The
+    // octagon vertices themselves are kept, so at least two points remain.
+    vector<Point> octagon = ExtremeOctagon(points);
+    vector<signed char> inside(points.size());
+    MarkPointsInsideConvexPolygon(points.data(), points.size(),
+                                  octagon.data(), octagon.size(),
+                                  inside.data());
+    ordered.resize(points.size());
+    size_t num_kept = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+      ordered[num_kept] = points[i];
+      num_kept += !inside[i];
+    }
+    ordered.resize(num_kept);
+  } else {
+    ordered.assign(points.begin(), points.end());
+  }
+  ConvexHullStats local;
+  local.input_points = points.size();
+  local.culled_points = points.size() - ordered.size();
+  GEOMETRY_STATS_ONLY(stopwatch.Lap(&local.cull_seconds);)
+  vector<Point> scratch(ordered.size());
+  SortLexicographically(ordered.data(), ordered.size(), scratch.data());
+  GEOMETRY_STATS_ONLY(stopwatch.Lap(&local.sort_seconds);)
+  vector<Point> upper;
+  ExtendChain(ordered.begin(), ordered.end(), &upper);
+  vector<Point> lower;
+  ExtendChain(ordered.rbegin(), ordered.rend(), &lower);
+  Polygon hull = JoinChains(std::move(upper), lower);
+  GEOMETRY_STATS_ONLY(stopwatch.Lap(&local.scan_seconds);)
+  if (stats) {
+    *stats = local;
+  }
+  return hull;
+}
+
+size_t ConvexHull(Span<const Point> points, Span<Point> hull) {
+  std::copy(points.begin(), points.end(), hull.begin());
+  return ConvexHullInPlace(hull.begin(), hull.begin() + points.size())
+      - hull.begin();
+}
+
+size_t ConvexHullIndices(Span<const Point> points, Span<size_t> indices) {
+  for (size_t i = 0; i < points.size(); ++i) {
+    indices[i] = i;
+  }
+  return ConvexHullInPlace(indices.begin(), indices.begin() + points.size(),
+                           [points](size_t i) { return points[i]; })
+      - indices.begin();
+}
+
+template <typename T>
+BasicPolygon<T> ConvexHull(const std::vector<BasicPoint<T>>& points) {
+  vector<BasicPoint<T>> ordered = points;
+  SortForHull(&ordered);
+  vector<BasicPoint<T>> upper;
+  ExtendChain(ordered.begin(), ordered.end(), &upper);
+  vector<BasicPoint<T>> lower;
+  ExtendChain(ordered.rbegin(), ordered.rend(), &lower);
+  return JoinChains(std::move(upper), lower);
+}
+
+template BasicPolygon<float> ConvexHull(
+    const std::vector<BasicPoint<float>>& points);
+template BasicPolygon<int32_t> ConvexHull(
+    const std::vector<BasicPoint<int32_t>>& points);
+template BasicPolygon<int64_t> ConvexHull(
+    const std::vector<BasicPoint<int64_t>>& points);
+
+Polygon ParallelConvexHull(const std::vector<Point>& points, int num_threads,
+                           ConvexHullStats* stats) {
+  num_threads =
+      ClampNumThreads(num_threads, points.size(), kMinPointsPerThread);
+  if (num_threads <= 1) {
+    return ConvexHull(points, ConvexHullOptions(), stats);
+  }
+  ConvexHullStats local;
+  local.input_points = points.size();
+  GEOMETRY_STATS_ONLY(Stopwatch stopwatch;)
+
+  // Slab i holds the points with splitters[i - 1] <= x < splitters[i], so
+  // the slabs are ordered and points with equal x share a slab.
+  vector<double> splitters;
+  int num_samples = num_threads * kSamplesPerSlab;
+  for (int i = 0; i < num_samples; ++i) {
+    splitters.push_back(points[i * (points.size() / num_samples)].x);
+  }
+  std::sort(splitters.begin(), splitters.end());
+  for (int i = 1; i < num_threads; ++i) {
+    splitters[i - 1] = splitters[i * kSamplesPerSlab];
+  }
+  splitters.resize(num_threads - 1);
+  splitters.erase(std::unique(splitters.begin(), splitters.end()),
+                  splitters.end());
+  int num_slabs = splitters.size() + 1;
+  auto slab_of = [&splitters](Point p) {
+    return std::upper_bound(splitters.begin(), splitters.end(), p.x)
+        - splitters.begin();
+  };
+
+  // Bucket the points by slab: every thread counts the points of its chunk
+  // in each slab, and then copies them to their place in ordered.
+  size_t chunk_size = (points.size() + num_threads - 1) / num_threads;
+  vector<vector<size_t>> offsets(num_threads, vector<size_t>(num_slabs));
+  RunInParallel(num_threads, [&](int thread) {
+    size_t end = std::min(points.size(), (thread + 1) * chunk_size);
+    for (size_t i = thread * chunk_size; i < end; ++i) {
+      ++offsets[thread][slab_of(points[i])];
+    }
+  });
+  vector<size_t> slab_begin(num_slabs + 1);
+  size_t offset = 0;
+  for (int slab = 0; slab < num_slabs; ++slab) {
+    slab_begin[slab] = offset;
+    for (int thread = 0; thread < num_threads; ++thread) {
+      size_t count = offsets[thread][slab];
+      offsets[thread][slab] = offset;
+      offset += count;
+    }
+  }
+  slab_begin[num_slabs] = offset;
+  vector<Point> ordered(points.size());
+  RunInParallel(num_threads, [&](int thread) {
+    size_t end = std::min(points.size(), (thread + 1) * chunk_size);
+    for (size_t i = thread * chunk_size; i < end; ++i) {
+      ordered[offsets[thread][slab_of(points[i])]++] = points[i];
+    }
+  });
+
+  GEOMETRY_STATS_ONLY(stopwatch.Lap(&local.sort_seconds);)
+
+  // Sort every slab and compute its chains.
+  vector<Point> scratch(points.size());
+  vector<vector<Point>> uppers(num_slabs), lowers(num_slabs);
+  GEOMETRY_STATS_ONLY(vector<double> sort_seconds(num_threads);
+                      vector<double> scan_seconds(num_threads);)
+  RunInParallel(num_threads, [&](int thread) {
+    GEOMETRY_STATS_ONLY(Stopwatch slab_stopwatch;)
+    for (int slab = thread; slab < num_slabs; slab += num_threads) {
+      auto begin = ordered.begin() + slab_begin[slab];
+      auto end = ordered.begin() + slab_begin[slab + 1];
+      SortLexicographically(ordered.data() + slab_begin[slab], end - begin,
+                            scratch.data() + slab_begin[slab]);
+      GEOMETRY_STATS_ONLY(slab_stopwatch.Lap(&sort_seconds[thread]);)
+      ExtendChain(begin, end, &uppers[slab]);
+      ExtendChain(std::reverse_iterator<decltype(end)>(end),
+                  std::reverse_iterator<decltype(begin)>(begin),
+                  &lowers[slab]);
+      GEOMETRY_STATS_ONLY(slab_stopwatch.Lap(&scan_seconds[thread]);)
+    }
+  });
+  GEOMETRY_STATS_ONLY({
+    double parallel_seconds = 0;
+    stopwatch.Lap(&parallel_seconds);
+    local.sort_seconds +=
+        *std::max_element(sort_seconds.begin(), sort_seconds.end());
+    local.scan_seconds =
+        *std::max_element(scan_seconds.begin(), scan_seconds.end());
+  })
+
+  // A point off the chain of its slab is off the hull, and the slabs are in
+  // order, so scanning the chains of all slabs leaves the hull. Popping
+  // points at the junction of two slabs finds their bridge.
+  vector<Point> upper;
+  for (const auto& chain : uppers) {
+    ExtendChain(chain.begin(), chain.end(), &upper);
+  }
+  vector<Point> lower;
+  for (int slab = num_slabs - 1; slab >= 0; --slab) {
+    ExtendChain(lowers[slab].begin(), lowers[slab].end(), &lower);
+  }
+  Polygon hull = JoinChains(std::move(upper), lower);
+  GEOMETRY_STATS_ONLY(stopwatch.Lap(&local.merge_seconds);)
+  if (stats) {
+    *stats = local;
+  }
+  return hull;
+}
+
+Polygon OutputSensitiveConvexHull(const std::vector<Point>& points) {
+  if (points.size() < 3) {
+    return ConvexHull(points);
+  }
+  auto lex_greater = [](Point lhs, Point rhs) {
+    return LexicographicLess(rhs, lhs);
+  };
+  Point first = *std::min_element(points.begin(), points.end(),
+                                  LexicographicLess);
+  Point last = *std::max_element(points.begin(), points.end(),
+                                 LexicographicLess);
+  if (first == last) {
+    return ConvexHull(points);
+  }
+
+  vector<Point> grouped = points;
+  vector<Point> chains;
+  vector<pair<size_t, size_t>> upper_ranges, lower_ranges;
+  vector<Point> chain, upper, lower;
+  // The group size squares after every failed attempt, so the total time is
+  // dominated by the last one, which takes O(n log h). Smaller groups than
+  // kMinGroupSize are not worth an attempt.
+  for (size_t group_size = kMinGroupSize; ; group_size *= group_size) {
+    group_size = std::min(group_size, points.size());
+    chains.clear();
+    upper_ranges.clear();
+    lower_ranges.clear();
+    for (size_t begin = 0; begin < grouped.size(); begin += group_size) {
+      auto group_begin = grouped.begin() + begin;
+      auto group_end =
+          grouped.begin() + std::min(grouped.size(), begin + group_size);
+      std::sort(group_begin, group_end, LexicographicLess);
+      chain.clear();
+      ExtendChain(group_begin, group_end, &chain);
+      upper_ranges.push_back(make_pair(chains.size(),
+                                       chains.size() + chain.size()));
+      chains.insert(chains.end(), chain.begin(), chain.end());
+      chain.clear();
+      ExtendChain(std::reverse_iterator<decltype(group_end)>(group_end),
+                  std::reverse_iterator<decltype(group_begin)>(group_begin),
+                  &chain);
+      lower_ranges.push_back(make_pair(chains.size(),
+                                       chains.size() + chain.size()));
+      chains.insert(chains.end(), chain.begin(), chain.end());
+    }
+    if (WrapChain(first, last, LexicographicLess, chains, upper_ranges,
+                  group_size, &upper)
+        && WrapChain(last, first, lex_greater, chains, lower_ranges,
+                     group_size, &lower)) {
+      return JoinChains(std::move(upper), lower);
+    }
+  }
+}
+
+Polygon AdaptiveConvexHull(const std::vector<Point>& points,
+                           size_t expected_hull_size) {
+  if (points.size() <= kHullSizeSamples) {
+    return ConvexHull(points);
+  }
+  if (expected_hull_size == 0) {
+    vector<Point> sample;
+    size_t stride = points.size() / kHullSizeSamples;
+    for (size_t i = 0; i < kHullSizeSamples; ++i) {
+      sample.push_back(points[i * stride]);
+    }
+    // The hull of n points uniform in a disk has O(n^(1/3)) vertices, more
+    // than for most other distributions that are not on a convex curve.
+    expected_hull_size = ConvexHull(sample).points.size()
+        * std::cbrt(static_cast<double>(points.size()) / kHullSizeSamples);
+  }
+  // OutputSensitiveConvexHull is faster when its first attempt succeeds.
+  if (expected_hull_size <= kMinGroupSize) {
+    return OutputSensitiveConvexHull(points);
+  }
+  return ConvexHull(points);
+}
+
+Polygon PolylineConvexHull(Span<const Point> polyline) {
+  size_t n = polyline.size();
+  // The polyline starts along a line from polyline[0]; while it does, its
+  // hull is the segment to the last point, as a simple polyline cannot turn
+  // back on the line.
+  size_t second = 1;
+  while (second < n && polyline[second] == polyline[0]) {
+    ++second;
+  }
+  size_t third = second + 1;
+  while (third < n
+         && Orientation(polyline[0], polyline[second], polyline[third]) == 0) {
+    ++third;
+  }
+  if (third >= n) {
+    return ConvexHull(polyline);
+  }
+
+  // The hull counterclockwise in deque[bottom, top], where deque[bottom] and
+  // deque[top] are both the last vertex that changed it. The deque is a ring
+  // buffer whose size is a power of two, indexed modulo its size, so it only
+  // grows with the hull. bottom starts high enough never to drop below 0.
+  vector<Point> deque(16);
+  size_t mask = deque.size() - 1;
+  size_t bottom = n;
+  size_t top = bottom + 3;
+  Point a = polyline[0], b = polyline[third - 1], c = polyline[third];
+  if (Orientation(a, b, c) < 0) {
+    std::swap(a, b);
+  }
+  deque[bottom & mask] = c;
+  deque[(bottom + 1) & mask] = a;
+  deque[(bottom + 2) & mask] = b;
+  deque[top & mask] = c;
+  for (size_t i = third + 1; i < n; ++i) {
+    Point p = polyline[i];
+    // A vertex strictly left of both hull edges at the last one lies inside
+    // the hull, since the polyline walls off the rest of that wedge.
+    if (Orientation(deque[(top - 1) & mask], deque[top & mask], p) > 0
+        && Orientation(deque[bottom & mask], deque[(bottom + 1) & mask], p)
+               > 0) {
+      continue;
+    }
+    if (top - bottom + 3 > deque.size()) {
+      vector<Point> grown(2 * deque.size());
+      size_t grown_mask = grown.size() - 1;
+      for (size_t j = bottom; j <= top; ++j) {
+        grown[j & grown_mask] = deque[j & mask];
+      }
+      deque.swap(grown);
+      mask = grown_mask;
+    }
+    while (top > bottom + 1
+           && Orientation(deque[(top - 1) & mask], deque[top & mask], p)
+                  <= 0) {
+      --top;
+    }
+    deque[++top & mask] = p;
+    while (top > bottom + 1
+           && Orientation(p, deque[bottom & mask],
+                          deque[(bottom + 1) & mask]) <= 0) {
+      ++bottom;
+    }
+    deque[--bottom & mask] = p;
+  }
+
+  // A vertex on a hull edge at the last vertex may stay as a vertex of the
+  // deque, so scan it once more from the lexicographically smallest vertex,
+  // which is a hull vertex, and reverse the result to turn clockwise.
+  size_t start = bottom;
+  for (size_t j = bottom; j < top; ++j) {
+    if (LexicographicLess(deque[j & mask], deque[start & mask])) {
+      start = j;
+    }
+  }
+  Polygon hull;
+  vector<Point>& h = hull.points;
+  for (size_t j = 0; j < top - bottom; ++j) {
+    Point p = deque[((start - bottom + j) % (top - bottom) + bottom) & mask];
+    while (h.size() >= 2 && Orientation(h[h.size() - 2], h.back(), p) <= 0) {
+      h.pop_back();
+    }
+    h.push_back(p);
+  }
+  while (h.size() >= 3 && Orientation(h[h.size() - 2], h.back(), h[0]) <= 0) {
+    h.pop_back();
+  }
+  std::reverse(h.begin() + 1, h.end());
+  return hull;
 }
@@ -1,8 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
 #include <vector>
 #include "base/base.h"
+#include "base/predicates.h"
+#include "base/span.h"
 
 // The algorithm on page 3. Its time complexity is O(n^3).
 Polygon SlowConvexHull(const std::vector<Point>& points);
 
 // Graham's scan; the algorithm on page 6. Its time complexity is O(n log n).
 Polygon ConvexHull(const std::vector<Point>& points);
+
+// The same scan for the other coordinate types of base/base.h: float, int32_t
+// and int64_t. Points with int32_t coordinates are sorted by a single radix
+// sort on both coordinates.
+template <typename T>
+BasicPolygon<T> ConvexHull(const std::vector<BasicPoint<T>>& points);
+
+struct ConvexHullOptions {
+  // Before sorting, discard the points strictly inside the octagon spanned
+  // by the extreme points in the axis and diagonal directions (Akl and
+  // Toussaint). Most points of uniform or clustered clouds go.
+  bool cull_interior_points;
+
+  ConvexHullOptions() : cull_interior_points(false) {}
+};
+
+struct ConvexHullStats {
+  size_t input_points;
+  // The points discarded before sorting.
+  size_t culled_points;
+
+  // The seconds spent in each phase, measured only when built with
+  // GEOMETRY_STATS, see base/stats.h. Culling includes copying the input.
+  // ParallelConvexHull merges the chains of its slabs; its sorting includes
+  // splitting the points into the slabs, and its sorting and scanning are
+  // timed on the slowest thread.
+  double cull_seconds;
+  double sort_seconds;
+  double scan_seconds;
+  double merge_seconds;
+
+  ConvexHullStats()
+      : input_points(0), culled_points(0), cull_seconds(0), sort_seconds(0),
+        scan_seconds(0), merge_seconds(0) {}
+
+  // All fields as one JSON object.
+  std::string ToJson() const;
+};
+
+// ConvexHull with options. Fills in stats unless it is null.
+Polygon ConvexHull(const std::vector<Point>& points,
+                   const ConvexHullOptions& options,
+                   ConvexHullStats* stats);
+
+// ConvexHull of points owned elsewhere, such as in a MappedGeometryFile of
+// base/geometry-file.h. Only the points kept after culling are copied.
+Polygon ConvexHull(Span<const Point> points);
+Polygon ConvexHull(Span<const Point> points,
+                   const ConvexHullOptions& options,
+                   ConvexHullStats* stats);
+
+// Allocation-free forms of ConvexHull for callers that compute many small
+// hulls. They return the same vertices in the same order as ConvexHull.
+//
+// ConvexHullInPlace reorders the points in [first, last), which may be of any
+// of the point types of base/base.h, so that the hull vertices come first,
+// and returns the end of the vertices; the other points follow in an
+// unspecified order. The points are split by the line
+// through the extreme points, and each side is sorted and scanned within its
+// own part of the range.
+template <typename RandomIt>
+RandomIt ConvexHullInPlace(RandomIt first, RandomIt last);
+
+// The same for a range of handles to points, such as indices, where
+// point_of(handle) is the point. The handles are reordered.
+template <typename RandomIt, typename PointOf>
+RandomIt ConvexHullInPlace(RandomIt first, RandomIt last, PointOf point_of);
+
+// Writes the hull vertices to the start of hull, which must have room for
+// points.size() points, and returns their number.
+size_t ConvexHull(Span<const Point> points, Span<Point> hull);
+
+// Writes the indices into points of the hull vertices to the start of
+// indices, which must have room for points.size() indices, and returns their
+// number.
+size_t ConvexHullIndices(Span<const Point> points, Span<size_t> indices);
+
+// The same hull as ConvexHull computed by num_threads threads. The points are
+// split into vertical slabs at sampled x quantiles, the slabs are sorted and
+// scanned concurrently, and the chains of adjacent slabs are merged by a
+// final scan that finds the bridges between them. Small inputs are handed to
+// ConvexHull. Fills in stats unless it is null.
+Polygon ParallelConvexHull(const std::vector<Point>& points, int num_threads,
+                           ConvexHullStats* stats = nullptr);
+
+// Chan's algorithm: the same hull as ConvexHull in O(n log h) time, where h
+// is the number of hull vertices. The points are split into groups whose
+// hulls are wrapped like a gift, with a binary search for the tangent of
+// every group; the group size grows until the wrapping completes.
+Polygon OutputSensitiveConvexHull(const std::vector<Point>& points);
+
+// Picks OutputSensitiveConvexHull when the hull is expected to be small
+// compared to the input and ConvexHull otherwise. Without an
+// expected_hull_size the size is estimated from the hull of a sample.
+Polygon AdaptiveConvexHull(const std::vector<Point>& points,
+                           size_t expected_hull_size = 0);
+
+// Melkman's algorithm: the same hull as ConvexHull of the vertices of a
+// simple polyline, such as a polygon outline or a track that does not cross
+// itself, in O(n) time and without sorting. The vertices are read once in
+// order and the hull kept in a deque, which grows with the hull rather than
+// the input; as the polyline does not cross itself, it can only leave the
+// hull by one of the two hull edges at the last vertex that changed it. For
+// a polyline that crosses itself the result is not the hull.
+Polygon PolylineConvexHull(Span<const Point> polyline);
+
+namespace convex_hull_internal {
+
+// Scans the handles in [begin, end) onto the chain stored in [base, top),
+// dropping every point at which the chain does not turn right, and returns
+// the new top. top must not be after begin: the chain grows by at most one
+// handle per handle read, so each handle is swapped with one already read,
+// and the range stays a permutation of its handles.
+template <typename RandomIt, typename PointOf>
+RandomIt ScanChain(RandomIt base, RandomIt top, RandomIt begin, RandomIt end,
+                   const PointOf& point_of) {
+  for (RandomIt it = begin; it != end; ++it) {
+    while (top - base >= 2
+           && !PointsMakesRightTurn(point_of(top[-2]), point_of(top[-1]),
+                                    point_of(*it))) {
+      --top;
+    }
+    std::iter_swap(top++, it);
+  }
+  return top;
+}
+
+}  // namespace convex_hull_internal
+
+template <typename RandomIt, typename PointOf>
+RandomIt ConvexHullInPlace(RandomIt first, RandomIt last, PointOf point_of) {
+  using convex_hull_internal::ScanChain;
+  using Handle = typename std::iterator_traits<RandomIt>::value_type;
+  if (last - first < 2) {
+    return last;
+  }
+  auto less = [&point_of](const Handle& lhs, const Handle& rhs) {
+    return point_of(lhs) < point_of(rhs);
+  };
+  auto extremes = std::minmax_element(first, last, less);
+  auto left = point_of(*extremes.first);
+  auto right = point_of(*extremes.second);
+  // The upper chain runs left to right through the points on or above the
+  // line from left to right, both of which are among them, and the lower
+  // chain back through the points below it.
+  RandomIt below = std::partition(first, last, [&](const Handle& handle) {
+    return Orientation(left, right, point_of(handle)) >= 0;
+  });
+  std::sort(first, below, less);
+  RandomIt upper_end = ScanChain(first, first, first, below, point_of);
+  std::sort(below, last, [&less](const Handle& lhs, const Handle& rhs) {
+    return less(rhs, lhs);
+  });
+  // The lower chain starts at the last vertex of the upper chain and ends
+  // before its first vertex, which is not repeated.
+  RandomIt base = upper_end - 1;
+  RandomIt top = ScanChain(base, upper_end, below, last, point_of);
+  while (top - base >= 2
+         && !PointsMakesRightTurn(point_of(top[-2]), point_of(top[-1]),
+                                  left)) {
+    --top;
+  }
+  return top;
+}
+
+template <typename RandomIt>
+RandomIt ConvexHullInPlace(RandomIt first, RandomIt last) {
+  using P = typename std::iterator_traits<RandomIt>::value_type;
+  return ConvexHullInPlace(first, last, [](const P& p) { return p; });
+}
@@ -1,4 +1,9 @@
 #include "chapter1/convex-hull.h"
+
+#include <algorithm>
+#include <numeric>
+#include "base/stats.h"
+#include "base/workload.h"
 #include "gtest/gtest.h"
 
 using std::vector;
@@ -6,6 +11,24 @@ using testing::TestWithParam;
 
 using ConvexHullFunc = Polygon(*)(const vector<Point>&);
 
+namespace {
+
+Polygon ParallelConvexHull4(const vector<Point>& points) {
+  return ParallelConvexHull(points, 4);
+}
+
+Polygon ConvexHullWithCulling(const vector<Point>& points) {
+  ConvexHullOptions options;
+  options.cull_interior_points = true;
+  return ConvexHull(points, options, nullptr);
+}
+
+Polygon AdaptiveConvexHullWithoutHint(const vector<Point>& points) {
+  return AdaptiveConvexHull(points);
+}
+
+}  // namespace
+
 class ConvexHullTest : public TestWithParam<ConvexHullFunc> {
  protected:
   ConvexHullFunc func() {
@@ -29,11 +52,250 @@ TEST_P(ConvexHullTest, MoreComplex) {
 
 TEST_P(ConvexHullTest, Degeneracy) {
   Polygon expected {{1, 0}, {0, -1}, {-1, 0}, {0, 1}};
-  vector<Point> input{{1, 0}, {0.3, -0.7}, {0, -1}, {-0.2, -0.8},
-                      {-1, 0}, {-0.29, 0.71}, {0, 1}, {0.59, 0.41}};
+  vector<Point> input{{1, 0}, {0.25, -0.75}, {0, -1}, {-0.125, -0.875},
+                      {-1, 0}, {-0.375, 0.625}, {0, 1}, {0.5, 0.5}};
   EXPECT_EQ(expected, func()(input));
 }
 
 INSTANTIATE_TEST_CASE_P(ConvexHullImpls,
                         ConvexHullTest,
-                        ::testing::Values(SlowConvexHull, ConvexHull));
+                        ::testing::Values(SlowConvexHull,
+                                          static_cast<ConvexHullFunc>(
+                                              ConvexHull),
+                                          ConvexHullWithCulling,
+                                          ParallelConvexHull4,
+                                          OutputSensitiveConvexHull,
+                                          AdaptiveConvexHullWithoutHint));
+
+TEST(ParallelConvexHullTest, SameAsConvexHull) {
+  for (auto distribution : {UNIFORM_SQUARE, UNIFORM_DISK, ON_CIRCLE,
+                            CLUSTERED, DEGENERATE}) {
+    vector<Point> points = RandomPoints(distribution, 1 << 17, 7);
+    Polygon expected = ConvexHull(points);
+    for (int num_threads : {-1, 0, 1, 2, 3, 8}) {
+      EXPECT_EQ(expected, ParallelConvexHull(points, num_threads))
+          << PointDistributionName(distribution) << " " << num_threads;
+    }
+  }
+}
+
+TEST(OutputSensitiveConvexHullTest, SameAsConvexHull) {
+  for (auto distribution : {UNIFORM_SQUARE, UNIFORM_DISK, ON_CIRCLE,
+                            CLUSTERED, DEGENERATE}) {
+    for (int n : {3, 10, 100, 10000}) {
+      vector<Point> points = RandomPoints(distribution, n, 11);
+      EXPECT_EQ(ConvexHull(points), OutputSensitiveConvexHull(points))
+          << PointDistributionName(distribution) << " " << n;
+      EXPECT_EQ(ConvexHull(points), AdaptiveConvexHull(points, 1))
+          << PointDistributionName(distribution) << " " << n;
+    }
+  }
+}
+
+TEST(ConvexHullTest, Span) {
+  vector<Point> points = RandomPoints(UNIFORM_DISK, 10000, 23);
+  // The middle of the points, as from a file mapped into memory.
+  Span<const Point> middle(points.data() + 100, 9000);
+  vector<Point> copy(middle.begin(), middle.end());
+  EXPECT_EQ(ConvexHull(copy), ConvexHull(middle));
+  ConvexHullOptions options;
+  options.cull_interior_points = true;
+  EXPECT_EQ(ConvexHull(copy), ConvexHull(middle, options, nullptr));
+}
+
+TEST(ConvexHullTest, InPlace) {
+  for (auto distribution : {UNIFORM_SQUARE, UNIFORM_DISK, ON_CIRCLE,
+                            CLUSTERED, DEGENERATE}) {
+    for (size_t n : {0, 1, 2, 3, 5, 100, 10000}) {
+      SCOPED_TRACE(PointDistributionName(distribution));
+      SCOPED_TRACE(n);
+      vector<Point> points = RandomPoints(distribution, n, 29);
+      Polygon expected = ConvexHull(points);
+
+      vector<Point> reordered = points;
+      auto end = ConvexHullInPlace(reordered.begin(), reordered.end());
+      EXPECT_EQ(expected, Polygon(vector<Point>(reordered.begin(), end)));
+      vector<Point> sorted = points;
+      std::sort(sorted.begin(), sorted.end());
+      std::sort(reordered.begin(), reordered.end());
+      EXPECT_EQ(sorted, reordered);
+
+      vector<size_t> handles(n);
+      std::iota(handles.begin(), handles.end(), 0);
+      auto handles_end = ConvexHullInPlace(
+          handles.begin(), handles.end(),
+          [&points](size_t i) { return points[i]; });
+      Polygon by_handle;
+      for (auto it = handles.begin(); it != handles_end; ++it) {
+        by_handle.points.push_back(points[*it]);
+      }
+      EXPECT_EQ(expected, by_handle);
+      std::sort(handles.begin(), handles.end());
+      for (size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(i, handles[i]);
+      }
+
+      vector<Point> hull(n);
+      size_t hull_size = ConvexHull(points, hull);
+      hull.resize(hull_size);
+      EXPECT_EQ(expected, Polygon(hull));
+
+      vector<size_t> indices(n);
+      indices.resize(ConvexHullIndices(points, indices));
+      Polygon by_index;
+      for (size_t i : indices) {
+        by_index.points.push_back(points[i]);
+      }
+      EXPECT_EQ(expected, by_index);
+    }
+  }
+
+  // Repeated points and the other coordinate types.
+  vector<Point> same(4, Point(1, 2));
+  EXPECT_EQ(ConvexHull(same),
+            Polygon(vector<Point>(same.begin(),
+                                  ConvexHullInPlace(same.begin(),
+                                                    same.end()))));
+  vector<BasicPoint<int32_t>> points32 = {{0, 0}, {2, 2}, {1, 1}, {2, 0},
+                                          {0, 2}, {1, 0}, {1, 3}};
+  BasicPolygon<int32_t> expected32 = ConvexHull(points32);
+  auto end32 = ConvexHullInPlace(points32.data(),
+                                 points32.data() + points32.size());
+  EXPECT_EQ(expected32, BasicPolygon<int32_t>(vector<BasicPoint<int32_t>>(
+                            points32.data(), end32)));
+}
+
+TEST(ConvexHullOptionsTest, CullInteriorPoints) {
+  ConvexHullOptions options;
+  options.cull_interior_points = true;
+  for (auto distribution : {UNIFORM_SQUARE, UNIFORM_DISK, ON_CIRCLE,
+                            CLUSTERED, DEGENERATE}) {
+    vector<Point> points = RandomPoints(distribution, 10000, 17);
+    ConvexHullStats stats;
+    EXPECT_EQ(ConvexHull(points), ConvexHull(points, options, &stats))
+        << PointDistributionName(distribution);
+    EXPECT_EQ(points.size(), stats.input_points);
+    if (distribution == UNIFORM_SQUARE) {
+      EXPECT_GT(stats.culled_points, points.size() / 2);
+    } else if (distribution == ON_CIRCLE) {
+      EXPECT_EQ(0, stats.culled_points);
+    }
+  }
+
+  ConvexHullStats stats;
+  ConvexHull(RandomPoints(UNIFORM_SQUARE, 100, 17), ConvexHullOptions(),
+             &stats);
+  EXPECT_EQ(100, stats.input_points);
+  EXPECT_EQ(0, stats.culled_points);
+}
+
+TEST(ConvexHullStatsTest, Phases) {
+  vector<Point> points = RandomPoints(UNIFORM_SQUARE, 1 << 16, 31);
+  ConvexHullOptions options;
+  options.cull_interior_points = true;
+  ConvexHullStats stats;
+  ConvexHull(points, options, &stats);
+  EXPECT_EQ(0, stats.merge_seconds);
+  ConvexHullStats parallel_stats;
+  EXPECT_EQ(ConvexHull(points), ParallelConvexHull(points, 2,
+                                                   &parallel_stats));
+  EXPECT_EQ(points.size(), parallel_stats.input_points);
+  EXPECT_EQ(0, parallel_stats.culled_points);
+  EXPECT_EQ(0, parallel_stats.cull_seconds);
+  EXPECT_NE(std::string::npos, stats.ToJson().find("\"sort_seconds\": "));
+  for (const ConvexHullStats* s : {&stats, &parallel_stats}) {
+    if (kGeometryStatsEnabled) {
+      EXPECT_GT(s->sort_seconds, 0);
+      EXPECT_GT(s->scan_seconds, 0);
+    } else {
+      EXPECT_EQ(0, s->sort_seconds);
+      EXPECT_EQ(0, s->scan_seconds);
+    }
+  }
+  EXPECT_EQ(kGeometryStatsEnabled, stats.cull_seconds > 0);
+  EXPECT_EQ(kGeometryStatsEnabled, parallel_stats.merge_seconds > 0);
+}
+
+// The hull of points with other coordinate types, compared to the hull of
+// the same points as doubles.
+template <typename T>
+void ExpectSameHullAsDouble(const vector<BasicPoint<T>>& points) {
+  vector<Point> as_double;
+  for (BasicPoint<T> p : points) {
+    as_double.push_back(Point(p.x, p.y));
+  }
+  Polygon expected = ConvexHull(as_double);
+  BasicPolygon<T> hull = ConvexHull(points);
+  Polygon actual;
+  for (BasicPoint<T> p : hull.points) {
+    actual.points.push_back(Point(p.x, p.y));
+  }
+  EXPECT_EQ(expected, actual);
+}
+
+TEST(ConvexHullTest, OtherCoordinateTypes) {
+  for (auto distribution : {UNIFORM_SQUARE, ON_CIRCLE, CLUSTERED,
+                            DEGENERATE}) {
+    vector<Point> points = RandomPoints(distribution, 10000, 19);
+    vector<BasicPoint<int32_t>> points32;
+    vector<BasicPoint<int64_t>> points64;
+    vector<BasicPoint<float>> points_float;
+    for (Point p : points) {
+      // Negative coordinates check the order of the radix sort keys.
+      points32.push_back(BasicPoint<int32_t>((p.x - 0.5) * 2e9,
+                                             (p.y - 0.5) * 2e9));
+      points64.push_back(BasicPoint<int64_t>((p.x - 0.5) * 1e15,
+                                             (p.y - 0.5) * 1e15));
+      points_float.push_back(BasicPoint<float>(p.x, p.y));
+    }
+    SCOPED_TRACE(PointDistributionName(distribution));
+    ExpectSameHullAsDouble(points32);
+    ExpectSameHullAsDouble(points64);
+    ExpectSameHullAsDouble(points_float);
+  }
+}
+
+// Checks PolylineConvexHull against ConvexHull on the polyline, its
+// reverse, and for a closed outline also from every starting vertex and
+// with the first vertex repeated at the end.
+void ExpectSameHullOfPolyline(vector<Point> polyline, bool closed) {
+  Polygon expected = ConvexHull(polyline);
+  for (int reversed = 0; reversed < 2; ++reversed) {
+    EXPECT_EQ(expected, PolylineConvexHull(polyline));
+    if (closed) {
+      for (size_t i = 1; i < polyline.size(); ++i) {
+        std::rotate(polyline.begin(), polyline.begin() + 1, polyline.end());
+        ASSERT_EQ(expected, PolylineConvexHull(polyline)) << i;
+      }
+      polyline.push_back(polyline[0]);
+      EXPECT_EQ(expected, PolylineConvexHull(polyline));
+      polyline.pop_back();
+    }
+    std::reverse(polyline.begin(), polyline.end());
+  }
+}
+
+TEST(PolylineConvexHullTest, SameAsConvexHull) {
+  EXPECT_EQ(Polygon(), PolylineConvexHull(vector<Point>()));
+  ExpectSameHullOfPolyline({{1, 1}}, false);
+  ExpectSameHullOfPolyline({{1, 1}, {1, 1}, {1, 1}}, false);
+  // Along a line, with repeated vertices, and then off it.
+  ExpectSameHullOfPolyline({{0, 0}, {0, 0}, {1, 1}, {2, 2}, {2, 2}}, false);
+  ExpectSameHullOfPolyline({{0, 0}, {1, 1}, {1, 1}, {2, 2}, {2, 1}}, false);
+  // Outlines with edges through collinear vertices, and a comb whose teeth
+  // end on the hull.
+  ExpectSameHullOfPolyline({{0, 0}, {1, 0}, {2, 0}, {2, 1}, {2, 2}, {1, 2},
+                            {0, 2}, {0, 1}}, true);
+  ExpectSameHullOfPolyline({{0, 0}, {4, 0}, {4, 4}, {3.5, 4}, {3.5, 0.5},
+                            {2.5, 0.5}, {2.5, 4}, {1.5, 4}, {1.5, 0.5},
+                            {0.5, 0.5}, {0.5, 4}, {0, 4}}, true);
+  // A spiral on a lattice, which winds around points inside its hull.
+  ExpectSameHullOfPolyline({{0, 0}, {4, 0}, {4, 4}, {0, 4}, {0, 1}, {3, 1},
+                            {3, 3}, {1, 3}, {1, 2}, {2, 2}}, false);
+  for (int n : {3, 10, 1000}) {
+    ExpectSameHullOfPolyline(RandomPolygon(n, 21).points, true);
+  }
+  for (int n : {2, 3, 10, 100, 10000}) {
+    ExpectSameHullOfPolyline(RandomTrack(n, 22), false);
+  }
+}
@@ -0,0 +1,239 @@
+#include "chapter1/convex-polygon-index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "base/predicates.h"
+
+using std::vector;
+
+namespace {
+
+// Points searched together by the batch form of Contains.
+const size_t kLanes = 8;
+
+// Orientation(a, b, c) <= 0, without a branch on the answer when the filter
+// decides it, which binary searches on random queries would mispredict half
+// of the time.
+bool RightTurnOrCollinear(Point a, Point b, Point c) {
+  double left = (b.x - a.x) * (c.y - a.y);
+  double right = (b.y - a.y) * (c.x - a.x);
+  double det = left - right;
+  double bound = predicates_internal::kOrientationErrorBound
+      * (std::fabs(left) + std::fabs(right));
+  if (std::fabs(det) <= bound) {
+    return predicates_internal::ExactOrientation(a, b, c) <= 0;
+  }
+  return det < 0;
+}
+
+double Dot(Point p, Point direction) {
+  return p.x * direction.x + p.y * direction.y;
+}
+
+}  // namespace
+
+ConvexPolygonIndex::ConvexPolygonIndex(const Polygon& polygon)
+    : start_(0),
+      upper_end_(0),
+      min_x_(std::numeric_limits<double>::infinity()),
+      min_y_(std::numeric_limits<double>::infinity()),
+      max_x_(-std::numeric_limits<double>::infinity()),
+      max_y_(-std::numeric_limits<double>::infinity()) {
+  const vector<Point>& v = polygon.points;
+  if (v.empty()) {
+    return;
+  }
+  start_ = std::min_element(v.begin(), v.end()) - v.begin();
+  vertices_.insert(vertices_.end(), v.begin() + start_, v.end());
+  vertices_.insert(vertices_.end(), v.begin(), v.begin() + start_);
+  upper_end_ = std::max_element(vertices_.begin(), vertices_.end())
+      - vertices_.begin();
+  for (Point p : vertices_) {
+    min_x_ = std::min(min_x_, p.x);
+    min_y_ = std::min(min_y_, p.y);
+    max_x_ = std::max(max_x_, p.x);
+    max_y_ = std::max(max_y_, p.y);
+  }
+}
+
+bool ConvexPolygonIndex::Sees(Point p, size_t i) const {
+  return !RightTurnOrCollinear(Vertex(i), Vertex(i + 1), p);
+}
+
+size_t ConvexPolygonIndex::FanEdge(Point p) const {
+  // The last vertex i of 1, ..., h - 2 with p on or to the right of the ray
+  // from the first vertex through it, by a search that always takes the
+  // same number of steps: the answer lies in [lo, lo + n).
+  Point first = vertices_[0];
+  size_t lo = 1;
+  size_t n = vertices_.size() - 2;
+  while (n > 1) {
+    size_t half = n / 2;
+    lo += half * RightTurnOrCollinear(first, vertices_[lo + half], p);
+    n -= half;
+  }
+  return lo;
+}
+
+bool ConvexPolygonIndex::Contains(Point p) const {
+  if (!(p.x >= min_x_ && p.x <= max_x_ && p.y >= min_y_ && p.y <= max_y_)) {
+    return false;
+  }
+  size_t h = vertices_.size();
+  if (h <= 2) {
+    // Within the bounding box of a point or a segment.
+    return h == 1 || Orientation(vertices_[0], vertices_[1], p) == 0;
+  }
+  if (Sees(p, 0) || Sees(p, h - 1)) {
+    return false;
+  }
+  return !Sees(p, FanEdge(p));
+}
+
+void ConvexPolygonIndex::Contains(Span<const Point> points,
+                                  Span<signed char> inside) const {
+  size_t h = vertices_.size();
+  size_t begin = 0;
+  if (h >= 3) {
+    // The searches of a block of points take their steps in lockstep, so
+    // that they overlap instead of each waiting for the previous step.
+    Point first = vertices_[0];
+    for (; begin + kLanes <= points.size(); begin += kLanes) {
+      const Point* p = points.data() + begin;
+      size_t lo[kLanes];
+      for (size_t lane = 0; lane < kLanes; ++lane) {
+        lo[lane] = 1;
+      }
+      for (size_t n = h - 2; n > 1; n -= n / 2) {
+        size_t half = n / 2;
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+          lo[lane] += half * RightTurnOrCollinear(
+              first, vertices_[lo[lane] + half], p[lane]);
+        }
+      }
+      for (size_t lane = 0; lane < kLanes; ++lane) {
+        Point q = p[lane];
+        bool in_box = q.x >= min_x_ && q.x <= max_x_
+            && q.y >= min_y_ && q.y <= max_y_;
+        inside[begin + lane] = in_box && !Sees(q, 0) && !Sees(q, h - 1)
+            && !Sees(q, lo[lane]);
+      }
+    }
+  }
+  for (size_t i = begin; i < points.size(); ++i) {
+    inside[i] = Contains(points[i]);
+  }
+}
+
+size_t ConvexPolygonIndex::ExtremeOnChain(Point direction, size_t i,
+                                          size_t j) const {
+  // The first vertex whose edge onward does not increase the dot product,
+  // by a search without branches on the answer: it lies in [i, i + n).
+  size_t n = j - i + 1;
+  while (n > 1) {
+    size_t half = n / 2;
+    Point a = Vertex(i + half - 1), b = Vertex(i + half);
+    i += half * (Dot(Point(b.x - a.x, b.y - a.y), direction) > 0);
+    n -= half;
+  }
+  return IndexOf(i);
+}
+
+size_t ConvexPolygonIndex::ExtremeVertex(Point direction) const {
+  // The upper chain runs clockwise from the lexicographically smallest to
+  // the largest vertex, and the lower chain on back to the smallest. A
+  // direction pointing up has its extreme vertex on the upper chain, and
+  // any other on the lower one. Along the lower chain the dot product with
+  // a direction pointing straight left stays level on a vertical first edge
+  // before it increases, but the smallest vertex is extreme for it anyway.
+  if (direction.y > 0) {
+    return ExtremeOnChain(direction, 0, upper_end_);
+  }
+  if (direction.y == 0 && direction.x < 0) {
+    return IndexOf(0);
+  }
+  return ExtremeOnChain(direction, upper_end_, vertices_.size());
+}
+
+void ConvexPolygonIndex::ExtremeVertices(Span<const Point> directions,
+                                         Span<size_t> vertices) const {
+  for (size_t i = 0; i < directions.size(); ++i) {
+    vertices[i] = ExtremeVertex(directions[i]);
+  }
+}
+
+size_t ConvexPolygonIndex::LastLike(Point p, size_t i, size_t j) const {
+  size_t h = vertices_.size();
+  bool sees_first = Sees(p, i);
+  size_t lo = i;
+  size_t hi = j < i ? j + h : j;
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (Sees(p, mid < h ? mid : mid - h) == sees_first) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo < h ? lo : lo - h;
+}
+
+bool ConvexPolygonIndex::Tangents(Point p, size_t* first,
+                                  size_t* second) const {
+  size_t h = vertices_.size();
+  if (h == 0 || Contains(p)) {
+    return false;
+  }
+  if (h == 1) {
+    *first = *second = IndexOf(0);
+    return true;
+  }
+  if (h == 2) {
+    if (Sees(p, 0) || Sees(p, 1)) {
+      *first = IndexOf(Sees(p, 0) ? 0 : 1);
+      *second = IndexOf(Sees(p, 0) ? 1 : 0);
+    } else {
+      // On the line through the segment, beyond one of its ends.
+      *first = *second = IndexOf(p < vertices_[0] ? 0 : 1);
+    }
+    return true;
+  }
+
+  // The edges that p sees form one run. Find one edge in it and one out of
+  // it, and then its ends between them.
+  bool sees_first = Sees(p, 0);
+  bool sees_last = Sees(p, h - 1);
+  size_t seen, unseen;
+  if (!sees_first && !sees_last) {
+    // p lies in the cone at the first vertex, beyond the edge of its
+    // triangle of the fan.
+    seen = FanEdge(p);
+    unseen = 0;
+  } else if (sees_first && sees_last) {
+    // The line from p through the first vertex passes through the polygon
+    // and leaves it through an edge facing away from p: the last vertex i
+    // with the ray from p through the first vertex passing to its left,
+    // which holds for vertex 1 but not for vertex h - 1, begins it.
+    Point v0 = vertices_[0];
+    size_t lo = 1, hi = h - 1;
+    while (hi - lo > 1) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (Orientation(p, v0, vertices_[mid]) > 0) {
+        lo = mid;
+      } else {
+        hi = mid;
+      }
+    }
+    seen = 0;
+    unseen = lo;
+  } else {
+    seen = sees_first ? 0 : h - 1;
+    unseen = sees_first ? h - 1 : 0;
+  }
+  size_t last_seen = LastLike(p, seen, unseen);
+  size_t last_unseen = LastLike(p, unseen, seen);
+  *first = IndexOf(last_unseen + 1);
+  *second = IndexOf(last_seen + 1);
+  return true;
+}
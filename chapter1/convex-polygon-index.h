@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "base/base.h"
+#include "base/span.h"
+
+// A convex polygon, such as one returned by ConvexHull, prepared for queries
+// that take O(log h) time for h vertices instead of a scan of all of them.
+// The polygon must be strictly convex with its vertices in clockwise order,
+// as ConvexHull returns them; it may start at any vertex, and may also have
+// only one or two vertices. Vertices are reported as indices into
+// polygon.points. Containment and tangents are decided exactly; an extreme
+// vertex is found from dot products rounded to doubles.
+//
+// Containment locates the point in the fan of triangles from the first
+// vertex. Extreme vertices are found on the upper or the lower chain, along
+// which the dot product first increases and then decreases. The tangents
+// from a point are the ends of the run of edges it sees, found by binary
+// searches from one edge it sees and one it does not.
+class ConvexPolygonIndex {
+ public:
+  explicit ConvexPolygonIndex(const Polygon& polygon);
+
+  size_t size() const { return vertices_.size(); }
+  bool empty() const { return vertices_.empty(); }
+
+  // Whether p lies inside the polygon or on its boundary, so that adding p
+  // to the points of the hull would leave the hull unchanged.
+  bool Contains(Point p) const;
+
+  // Sets inside[i] to 1 if points[i] lies inside the polygon or on its
+  // boundary and to 0 otherwise; inside must have room for points.size()
+  // values. The binary searches take a fixed number of steps without
+  // branches on the answers, and those of several points run in lockstep,
+  // which makes this up to three times faster than one query at a time.
+  void Contains(Span<const Point> points, Span<signed char> inside) const;
+
+  // A vertex with the largest dot product with direction. The polygon must
+  // not be empty.
+  size_t ExtremeVertex(Point direction) const;
+
+  // Sets vertices[i] to ExtremeVertex(directions[i]); vertices must have
+  // room for directions.size() indices.
+  void ExtremeVertices(Span<const Point> directions,
+                       Span<size_t> vertices) const;
+
+  // For p outside the polygon, sets *first and *second to the vertices at
+  // which the lines from p touch it, and returns true. The polygon lies to
+  // the left of the line from p through the first and to the right of the
+  // one through the second. Where an edge lies on one of the lines, it
+  // touches at the nearer end of the edge. Returns false if p lies inside
+  // the polygon or on its boundary.
+  bool Tangents(Point p, size_t* first, size_t* second) const;
+
+ private:
+  // The vertex i steps clockwise from the first one.
+  Point Vertex(size_t i) const {
+    return vertices_[i < vertices_.size() ? i : i - vertices_.size()];
+  }
+  // The index in the polygon of the vertex i <= size() steps from the first
+  // one.
+  size_t IndexOf(size_t i) const {
+    i += start_;
+    return i < vertices_.size() ? i : i - vertices_.size();
+  }
+  // Whether p sees the edge from Vertex(i) to Vertex(i + 1), that is, lies
+  // strictly on its outer side.
+  bool Sees(Point p, size_t i) const;
+  // Among the edges from i to j clockwise, where p sees exactly one of the
+  // edges i and j, the last one that p sees if it sees edge i and the last
+  // one that it does not see otherwise.
+  size_t LastLike(Point p, size_t i, size_t j) const;
+  // The vertex from i to j clockwise with the largest dot product with
+  // direction, which must first increase and then decrease along them.
+  size_t ExtremeOnChain(Point direction, size_t i, size_t j) const;
+  // For a polygon of at least three vertices and p on or to the right of
+  // the edge from the first vertex and on or to the right of the edge into
+  // it, the edge i such that the triangle of the first vertex and edge i
+  // holds p, or would hold it if the edge were moved outward.
+  size_t FanEdge(Point p) const;
+
+  // The vertices of the polygon in clockwise order from the
+  // lexicographically smallest one, which is polygon.points[start_].
+  std::vector<Point> vertices_;
+  size_t start_;
+  // The lexicographically largest vertex, at the end of the upper chain.
+  size_t upper_end_;
+  double min_x_, min_y_, max_x_, max_y_;
+};
@@ -0,0 +1,196 @@
+#include "chapter1/convex-polygon-index.h"
+
+#include <algorithm>
+#include <vector>
+#include "base/predicates.h"
+#include "base/workload.h"
+#include "chapter1/convex-hull.h"
+#include "gtest/gtest.h"
+
+using std::vector;
+
+namespace {
+
+double Dot(Point p, Point direction) {
+  return p.x * direction.x + p.y * direction.y;
+}
+
+// Whether p sees the edge from vertex i, by the definition.
+bool Sees(const Polygon& polygon, Point p, size_t i) {
+  const vector<Point>& v = polygon.points;
+  return Orientation(v[i], v[(i + 1) % v.size()], p) > 0;
+}
+
+// Checks every query against a scan of all vertices, for a polygon of at
+// least three vertices.
+void ExpectSameAsScan(const Polygon& polygon, const vector<Point>& points) {
+  const vector<Point>& v = polygon.points;
+  size_t h = v.size();
+  ConvexPolygonIndex index(polygon);
+  ASSERT_EQ(h, index.size());
+  vector<signed char> inside(points.size(), -1);
+  index.Contains(points, inside);
+  for (size_t i = 0; i < points.size(); ++i) {
+    Point p = points[i];
+    bool outside = false;
+    size_t first = h, second = h;
+    for (size_t j = 0; j < h; ++j) {
+      bool sees = Sees(polygon, p, j);
+      bool sees_previous = Sees(polygon, p, (j + h - 1) % h);
+      outside |= sees;
+      if (sees && !sees_previous) {
+        first = j;
+      }
+      if (!sees && sees_previous) {
+        second = j;
+      }
+    }
+    ASSERT_EQ(!outside, index.Contains(p)) << p;
+    ASSERT_EQ(!outside, inside[i]) << p;
+    size_t index_first = h, index_second = h;
+    ASSERT_EQ(outside, index.Tangents(p, &index_first, &index_second)) << p;
+    if (outside) {
+      EXPECT_EQ(first, index_first) << p;
+      EXPECT_EQ(second, index_second) << p;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(ConvexPolygonIndexTest, Square) {
+  Polygon square = ConvexHull({{0, 0}, {1, 0}, {1, 1}, {0, 1}});
+  ASSERT_EQ(Polygon({{0, 0}, {0, 1}, {1, 1}, {1, 0}}), square);
+  ConvexPolygonIndex index(square);
+  EXPECT_TRUE(index.Contains(Point(0.5, 0.5)));
+  EXPECT_TRUE(index.Contains(Point(1, 0.5)));
+  EXPECT_TRUE(index.Contains(Point(1, 1)));
+  EXPECT_FALSE(index.Contains(Point(1.5, 0.5)));
+  EXPECT_FALSE(index.Contains(Point(0.5, -0.5)));
+
+  EXPECT_EQ(2, index.ExtremeVertex(Point(1, 1)));
+  EXPECT_EQ(0, index.ExtremeVertex(Point(-1, -2)));
+  EXPECT_EQ(3, index.ExtremeVertex(Point(2, -1)));
+  EXPECT_EQ(1, index.ExtremeVertex(Point(-1, 0.5)));
+
+  size_t first, second;
+  EXPECT_FALSE(index.Tangents(Point(0.5, 0.5), &first, &second));
+  ASSERT_TRUE(index.Tangents(Point(-1, 0.5), &first, &second));
+  EXPECT_EQ(0, first);
+  EXPECT_EQ(1, second);
+  ASSERT_TRUE(index.Tangents(Point(2, 2), &first, &second));
+  EXPECT_EQ(1, first);
+  EXPECT_EQ(3, second);
+  // On the line through the bottom edge.
+  ASSERT_TRUE(index.Tangents(Point(2, 0), &first, &second));
+  EXPECT_EQ(2, first);
+  EXPECT_EQ(3, second);
+}
+
+TEST(ConvexPolygonIndexTest, FewVertices) {
+  ConvexPolygonIndex empty((Polygon()));
+  EXPECT_TRUE(empty.empty());
+  EXPECT_FALSE(empty.Contains(Point(0, 0)));
+  size_t first, second;
+  EXPECT_FALSE(empty.Tangents(Point(0, 0), &first, &second));
+
+  ConvexPolygonIndex point(Polygon{{1, 1}});
+  EXPECT_TRUE(point.Contains(Point(1, 1)));
+  EXPECT_FALSE(point.Contains(Point(1, 2)));
+  EXPECT_EQ(0, point.ExtremeVertex(Point(1, -1)));
+  ASSERT_TRUE(point.Tangents(Point(0, 0), &first, &second));
+  EXPECT_EQ(0, first);
+  EXPECT_EQ(0, second);
+
+  ConvexPolygonIndex segment(Polygon{{1, 1}, {0, 0}});
+  EXPECT_TRUE(segment.Contains(Point(0.5, 0.5)));
+  EXPECT_FALSE(segment.Contains(Point(0.5, 0.25)));
+  EXPECT_FALSE(segment.Contains(Point(2, 2)));
+  EXPECT_EQ(0, segment.ExtremeVertex(Point(1, 0)));
+  EXPECT_EQ(1, segment.ExtremeVertex(Point(-1, 0.5)));
+  ASSERT_TRUE(segment.Tangents(Point(1, 0), &first, &second));
+  EXPECT_EQ(0, first);
+  EXPECT_EQ(1, second);
+  ASSERT_TRUE(segment.Tangents(Point(2, 2), &first, &second));
+  EXPECT_EQ(0, first);
+  EXPECT_EQ(0, second);
+}
+
+TEST(ConvexPolygonIndexTest, SameAsScan) {
+  // A lattice of spacing 1/32 around the unit square, on which the hulls of
+  // degenerate points have vertices, and many points lie on the lines
+  // through their edges.
+  vector<Point> lattice;
+  for (int i = -8; i <= 40; ++i) {
+    for (int j = -8; j <= 40; ++j) {
+      lattice.push_back(Point(i / 32.0, j / 32.0));
+    }
+  }
+  for (auto distribution : {UNIFORM_DISK, ON_CIRCLE, DEGENERATE}) {
+    for (int n : {3, 10, 100, 2000}) {
+      SCOPED_TRACE(PointDistributionName(distribution));
+      SCOPED_TRACE(n);
+      Polygon hull = ConvexHull(RandomPoints(distribution, n, 11));
+      if (hull.points.size() < 3) {
+        continue;
+      }
+      vector<Point> points = RandomPoints(UNIFORM_SQUARE, 2000, 12);
+      points.insert(points.end(), lattice.begin(), lattice.end());
+      points.insert(points.end(), hull.points.begin(), hull.points.end());
+      ExpectSameAsScan(hull, points);
+      // Starting at another vertex.
+      std::rotate(hull.points.begin(), hull.points.begin() + 1,
+                  hull.points.end());
+      ExpectSameAsScan(hull, points);
+    }
+  }
+}
+
+TEST(ConvexPolygonIndexTest, ExtremeVertex) {
+  Polygon hull = ConvexHull(RandomPoints(ON_CIRCLE, 1000, 13));
+  std::rotate(hull.points.begin(), hull.points.begin() + 100,
+              hull.points.end());
+  ConvexPolygonIndex index(hull);
+  vector<Point> directions = RandomPoints(UNIFORM_SQUARE, 1000, 14);
+  for (Point& d : directions) {
+    d = Point(d.x - 0.5, d.y - 0.5);
+  }
+  directions.insert(directions.end(), {{1, 0}, {0, 1}, {-1, 0}, {0, -1}});
+  vector<size_t> vertices(directions.size());
+  index.ExtremeVertices(directions, vertices);
+  for (size_t i = 0; i < directions.size(); ++i) {
+    Point d = directions[i];
+    double best = Dot(hull.points[0], d);
+    for (Point p : hull.points) {
+      best = std::max(best, Dot(p, d));
+    }
+    ASSERT_LT(vertices[i], hull.points.size());
+    EXPECT_EQ(vertices[i], index.ExtremeVertex(d));
+    EXPECT_NEAR(best, Dot(hull.points[vertices[i]], d), 1e-12) << d;
+  }
+}
+
+TEST(ConvexPolygonIndexTest, ExtremeVertexWithVerticalEdges) {
+  // Hulls with a vertical edge on the right, on the left, or both, where
+  // the dot product with an axis direction is level along an edge.
+  const vector<vector<Point>> point_sets {
+    {{0, 0}, {1, 1}, {1, -1}},
+    {{0, 1}, {0, -1}, {1, 0}},
+    {{0, 0}, {0, 1}, {2, 1}, {2, 0}},
+    {{0, 0}, {0, 1}, {1, 2}, {2, 1}, {2, 0}, {1, -1}},
+  };
+  for (const vector<Point>& points : point_sets) {
+    Polygon hull = ConvexHull(points);
+    ConvexPolygonIndex index(hull);
+    for (Point d : {Point(1, 0), Point(1, 1), Point(0, 1), Point(-1, 1),
+                    Point(-1, 0), Point(-1, -1), Point(0, -1),
+                    Point(1, -1)}) {
+      double best = Dot(hull.points[0], d);
+      for (Point p : hull.points) {
+        best = std::max(best, Dot(p, d));
+      }
+      EXPECT_EQ(best, Dot(hull.points[index.ExtremeVertex(d)], d))
+          << hull << " " << d;
+    }
+  }
+}
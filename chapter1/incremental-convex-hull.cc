@@ -0,0 +1,90 @@
+#include "chapter1/incremental-convex-hull.h"
+
+#include <iterator>
+#include <vector>
+#include "base/predicates.h"
+#include "chapter1/convex-hull.h"
+
+using std::vector;
+
+namespace {
+
+// Below this many points InsertBatch inserts them one at a time.
+const size_t kMinBatchHullSize = 64;
+
+Point Rotate(Point p) {
+  return Point(-p.x, -p.y);
+}
+
+}  // namespace
+
+void IncrementalConvexHull::UpperChain::Insert(Point p) {
+  auto next = points_.lower_bound(p);
+  if (next != points_.end() && *next == p) {
+    return;
+  }
+  // Points on or below the chain do not change it.
+  if (next != points_.begin() && next != points_.end()
+      && Orientation(*std::prev(next), *next, p) <= 0) {
+    return;
+  }
+  auto it = points_.insert(next, p);
+  // Drop the neighbours at which the chain no longer turns right.
+  while (true) {
+    auto after = std::next(it);
+    if (after == points_.end() || std::next(after) == points_.end()
+        || PointsMakesRightTurn(p, *after, *std::next(after))) {
+      break;
+    }
+    points_.erase(after);
+  }
+  while (it != points_.begin()) {
+    auto before = std::prev(it);
+    if (before == points_.begin()
+        || PointsMakesRightTurn(*std::prev(before), *before, p)) {
+      break;
+    }
+    points_.erase(before);
+  }
+}
+
+void IncrementalConvexHull::Insert(Point p) {
+  if (upper_.points().size() == 1 && *upper_.points().begin() == p) {
+    repeated_point_ = true;
+  }
+  upper_.Insert(p);
+  lower_.Insert(Rotate(p));
+}
+
+void IncrementalConvexHull::InsertBatch(Span<const Point> points) {
+  if (points.size() < kMinBatchHullSize) {
+    for (Point p : points) {
+      Insert(p);
+    }
+    return;
+  }
+  // Only the vertices of the hull of the batch can be vertices of the
+  // combined hull.
+  ConvexHullOptions options;
+  options.cull_interior_points = true;
+  Polygon hull = ConvexHull(points, options, nullptr);
+  for (Point p : hull.points) {
+    Insert(p);
+  }
+}
+
+Polygon IncrementalConvexHull::Snapshot() const {
+  Polygon hull;
+  hull.points.assign(upper_.points().begin(), upper_.points().end());
+  // The two chains share their end points.
+  if (lower_.points().size() > 2) {
+    for (auto it = std::next(lower_.points().begin());
+         it != std::prev(lower_.points().end()); ++it) {
+      hull.points.push_back(Rotate(*it));
+    }
+  }
+  if (hull.points.size() == 1 && repeated_point_) {
+    hull.points.push_back(hull.points[0]);
+  }
+  return hull;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <set>
+#include "base/base.h"
+#include "base/span.h"
+
+// The convex hull of a growing set of points, such as an endless feed. Only
+// the hull vertices are kept, and an insertion takes amortized O(log h) time
+// where h is the number of hull vertices.
+class IncrementalConvexHull {
+ public:
+  IncrementalConvexHull() : repeated_point_(false) {}
+
+  void Insert(Point p);
+
+  // Inserts all the points. A large batch is reduced to its own hull first,
+  // so it costs about as much as ConvexHull of the batch.
+  void InsertBatch(Span<const Point> points);
+
+  bool empty() const { return upper_.points().empty(); }
+
+  // The hull of the points inserted so far: the same polygon as ConvexHull
+  // of all of them. Takes O(h) time.
+  Polygon Snapshot() const;
+
+ private:
+  // The upper chain of the hull from the lexicographically smallest to the
+  // largest point, turning right at every vertex. The lower chain is the
+  // upper chain of the points rotated by 180 degrees.
+  class UpperChain {
+   public:
+    void Insert(Point p);
+
+    const std::set<Point>& points() const { return points_; }
+
+   private:
+    std::set<Point> points_;
+  };
+
+  UpperChain upper_;
+  UpperChain lower_;
+  // Whether the only point so far was inserted more than once, for which
+  // ConvexHull repeats it.
+  bool repeated_point_;
+};
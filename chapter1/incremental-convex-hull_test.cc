@@ -0,0 +1,68 @@
+#include "chapter1/incremental-convex-hull.h"
+
+#include <vector>
+#include "base/workload.h"
+#include "chapter1/convex-hull.h"
+#include "gtest/gtest.h"
+
+using std::vector;
+
+TEST(IncrementalConvexHullTest, Simple) {
+  IncrementalConvexHull hull;
+  EXPECT_TRUE(hull.empty());
+  EXPECT_EQ(Polygon(), hull.Snapshot());
+  hull.Insert(Point(0, 0));
+  EXPECT_EQ(Polygon({{0, 0}}), hull.Snapshot());
+  hull.Insert(Point(0, 0));
+  EXPECT_EQ(Polygon({{0, 0}, {0, 0}}), hull.Snapshot());
+  hull.Insert(Point(1, 1));
+  EXPECT_EQ(Polygon({{0, 0}, {1, 1}}), hull.Snapshot());
+  hull.Insert(Point(0.5, 0.5));
+  EXPECT_EQ(Polygon({{0, 0}, {1, 1}}), hull.Snapshot());
+  hull.Insert(Point(1, 0));
+  hull.Insert(Point(0.75, 0.25));
+  EXPECT_EQ(Polygon({{0, 0}, {1, 1}, {1, 0}}), hull.Snapshot());
+  hull.Insert(Point(0, 1));
+  EXPECT_EQ(Polygon({{0, 0}, {0, 1}, {1, 1}, {1, 0}}), hull.Snapshot());
+  hull.Insert(Point(-1, 0.5));
+  EXPECT_EQ(Polygon({{-1, 0.5}, {0, 1}, {1, 1}, {1, 0}, {0, 0}}),
+            hull.Snapshot());
+}
+
+TEST(IncrementalConvexHullTest, RepeatedPoints) {
+  vector<Point> same(100, Point(2, 3));
+  IncrementalConvexHull hull;
+  for (size_t n = 1; n <= 3; ++n) {
+    hull.Insert(same[0]);
+    EXPECT_EQ(ConvexHull(vector<Point>(same.begin(), same.begin() + n)),
+              hull.Snapshot());
+  }
+  IncrementalConvexHull batched;
+  batched.InsertBatch(same);
+  EXPECT_EQ(ConvexHull(same), batched.Snapshot());
+  batched.InsertBatch(vector<Point>(100, Point(1, 1)));
+  EXPECT_EQ(Polygon({{1, 1}, {2, 3}}), batched.Snapshot());
+}
+
+TEST(IncrementalConvexHullTest, SameAsConvexHull) {
+  for (auto distribution : {UNIFORM_SQUARE, UNIFORM_DISK, ON_CIRCLE,
+                            CLUSTERED, DEGENERATE}) {
+    vector<Point> points = RandomPoints(distribution, 20000, 3);
+    IncrementalConvexHull hull;
+    IncrementalConvexHull batched;
+    size_t inserted = 0;
+    for (size_t n : {1, 2, 3, 10, 100, 1000, 20000}) {
+      for (; inserted < n; ++inserted) {
+        hull.Insert(points[inserted]);
+      }
+      vector<Point> prefix(points.begin(), points.begin() + n);
+      Polygon expected = ConvexHull(prefix);
+      EXPECT_EQ(expected, hull.Snapshot())
+          << PointDistributionName(distribution) << " " << n;
+
+      batched.InsertBatch(prefix);
+      EXPECT_EQ(expected, batched.Snapshot())
+          << PointDistributionName(distribution) << " " << n;
+    }
+  }
+}
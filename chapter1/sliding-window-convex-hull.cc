@@ -0,0 +1,165 @@
+#include "chapter1/sliding-window-convex-hull.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <utility>
+#include "base/predicates.h"
+#include "chapter1/convex-hull.h"
+
+using std::vector;
+
+namespace {
+
+double Dot(Point p, Point direction) {
+  return p.x * direction.x + p.y * direction.y;
+}
+
+// Appends p to chain, first dropping the points at which the chain would not
+// turn in the direction of turn (1 for left, -1 for right).
+void ExtendChain(Point p, int turn, vector<Point>* chain) {
+  while (chain->size() >= 2
+         && Orientation((*chain)[chain->size() - 2], chain->back(), p)
+                != turn) {
+    chain->pop_back();
+  }
+  chain->push_back(p);
+}
+
+// The vertex of a chain from the lexicographically smallest to the largest
+// point with the largest dot product with direction. Along the upper chain
+// for a direction pointing up, and along the lower chain for one pointing
+// down, the dot product first increases and then decreases.
+Point ExtremeChainPoint(const vector<Point>& chain, Point direction) {
+  size_t lo = 0;
+  size_t hi = chain.size() - 1;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    Point edge(chain[mid + 1].x - chain[mid].x,
+               chain[mid + 1].y - chain[mid].y);
+    if (Dot(edge, direction) > 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return chain[lo];
+}
+
+}  // namespace
+
+void SlidingWindowConvexHull::BuildHull(Block* block) {
+  block->upper.clear();
+  block->lower.clear();
+  for (const TimedPoint& p : block->points) {
+    if (!block->upper.empty() && block->upper.back() == p.point) {
+      continue;
+    }
+    ExtendChain(p.point, -1, &block->upper);
+    ExtendChain(p.point, 1, &block->lower);
+  }
+}
+
+void SlidingWindowConvexHull::Insert(Point p) {
+  Block block;
+  block.begin = next_time_;
+  block.end = next_time_ + 1;
+  block.points.push_back(TimedPoint{p, next_time_});
+  block.split = false;
+  BuildHull(&block);
+  blocks_.push_back(std::move(block));
+  ++next_time_;
+  ++size_;
+
+  while (blocks_.size() >= 2) {
+    Block& newer = blocks_[blocks_.size() - 1];
+    Block& older = blocks_[blocks_.size() - 2];
+    if (newer.split || older.split
+        || newer.end - newer.begin != older.end - older.begin) {
+      break;
+    }
+    vector<TimedPoint> merged;
+    merged.reserve(older.points.size() + newer.points.size());
+    std::merge(older.points.begin(), older.points.end(),
+               newer.points.begin(), newer.points.end(),
+               std::back_inserter(merged),
+               [](const TimedPoint& lhs, const TimedPoint& rhs) {
+                 return LexicographicLess(lhs.point, rhs.point);
+               });
+    older.points.swap(merged);
+    older.end = newer.end;
+    BuildHull(&older);
+    blocks_.pop_back();
+  }
+}
+
+void SlidingWindowConvexHull::RemoveOldest() {
+  assert(!empty());
+  Block oldest = std::move(blocks_.front());
+  blocks_.pop_front();
+  --size_;
+  // The remaining points at times [begin + 1, end) go to blocks of sizes
+  // 1, 2, 4, ..., the last one taking what is left. Distributing the sorted
+  // points keeps every block sorted.
+  uint64_t begin = oldest.begin + 1;
+  vector<Block> parts;
+  for (uint64_t part_begin = begin, part_size = 1; part_begin < oldest.end;
+       part_begin += part_size, part_size *= 2) {
+    Block part;
+    part.begin = part_begin;
+    part.end = std::min(part_begin + part_size, oldest.end);
+    part.split = true;
+    part.points.reserve(part.end - part.begin);
+    parts.push_back(std::move(part));
+  }
+  for (const TimedPoint& p : oldest.points) {
+    if (p.time < begin) {
+      continue;
+    }
+    // Block k holds the offsets [2^k - 1, 2^(k+1) - 1).
+    uint64_t offset = p.time - begin + 1;
+    size_t k = 0;
+    while (offset >>= 1) {
+      ++k;
+    }
+    parts[std::min(k, parts.size() - 1)].points.push_back(p);
+  }
+  for (auto it = parts.rbegin(); it != parts.rend(); ++it) {
+    BuildHull(&*it);
+    blocks_.push_front(std::move(*it));
+  }
+}
+
+Point SlidingWindowConvexHull::ExtremePoint(Point direction) const {
+  assert(!empty());
+  bool up = direction.y >= 0;
+  Point best = ExtremeChainPoint(
+      up ? blocks_.front().upper : blocks_.front().lower, direction);
+  for (const Block& block : blocks_) {
+    Point p = ExtremeChainPoint(up ? block.upper : block.lower, direction);
+    if (Dot(p, direction) > Dot(best, direction)) {
+      best = p;
+    }
+  }
+  return best;
+}
+
+Polygon SlidingWindowConvexHull::Snapshot() const {
+  // Only the vertices of the block hulls can be vertices of the hull.
+  vector<Point> candidates;
+  for (const Block& block : blocks_) {
+    candidates.insert(candidates.end(), block.upper.begin(),
+                      block.upper.end());
+    if (block.lower.size() > 2) {
+      candidates.insert(candidates.end(), block.lower.begin() + 1,
+                        block.lower.end() - 1);
+    }
+  }
+  Polygon hull = ConvexHull(candidates);
+  // The block hulls keep repeated points once, but ConvexHull of a window of
+  // two or more copies of one point repeats it.
+  if (hull.points.size() == 1 && size_ >= 2) {
+    hull.points.push_back(hull.points[0]);
+  }
+  return hull;
+}
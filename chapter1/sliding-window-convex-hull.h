@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "base/base.h"
+
+// The convex hull of a window of the most recent points of a stream: points
+// are inserted as the newest and removed as the oldest. Both take amortized
+// O(log n) time for a window of n points.
+//
+// The window is split into blocks of consecutive points whose sizes are
+// powers of two, like a binary counter. Every block keeps its points sorted
+// lexicographically and its own hull. New blocks of equal size are merged;
+// when the oldest point expires, the rest of the oldest block is split into
+// blocks of sizes 1, 2, 4, ... Both are linear in the block size, and a point
+// takes part in O(log n) of them. Queries combine the O(log n) block hulls.
+class SlidingWindowConvexHull {
+ public:
+  SlidingWindowConvexHull() : size_(0), next_time_(0) {}
+
+  // Adds p as the newest point of the window.
+  void Insert(Point p);
+
+  // Removes the oldest point. The window must not be empty.
+  void RemoveOldest();
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // A point of the window with the largest dot product with direction, in
+  // O(log^2 n) time. The window must not be empty.
+  Point ExtremePoint(Point direction) const;
+
+  // The same polygon as ConvexHull of the points in the window.
+  Polygon Snapshot() const;
+
+ private:
+  struct TimedPoint {
+    Point point;
+    uint64_t time;
+  };
+
+  struct Block {
+    // The points inserted at times [begin, end), sorted lexicographically.
+    uint64_t begin;
+    uint64_t end;
+    std::vector<TimedPoint> points;
+    // The chains of the hull from the lexicographically smallest to the
+    // largest point: the upper one turning right, the lower one left.
+    std::vector<Point> upper;
+    std::vector<Point> lower;
+    // Blocks split off at the front are never merged again.
+    bool split;
+  };
+
+  static void BuildHull(Block* block);
+
+  std::deque<Block> blocks_;
+  size_t size_;
+  uint64_t next_time_;
+};
@@ -0,0 +1,93 @@
+#include "chapter1/sliding-window-convex-hull.h"
+
+#include <algorithm>
+#include <vector>
+#include "base/workload.h"
+#include "chapter1/convex-hull.h"
+#include "gtest/gtest.h"
+
+using std::vector;
+
+namespace {
+
+double Dot(Point p, Point direction) {
+  return p.x * direction.x + p.y * direction.y;
+}
+
+}  // namespace
+
+TEST(SlidingWindowConvexHullTest, Simple) {
+  SlidingWindowConvexHull hull;
+  EXPECT_TRUE(hull.empty());
+  for (Point p : {Point(0, 0), Point(1, 0), Point(1, 1), Point(0, 1),
+                  Point(0.5, 0.5)}) {
+    hull.Insert(p);
+  }
+  EXPECT_EQ(5, hull.size());
+  EXPECT_EQ(Polygon({{0, 0}, {0, 1}, {1, 1}, {1, 0}}), hull.Snapshot());
+  EXPECT_EQ(Point(1, 1), hull.ExtremePoint(Point(1, 1)));
+  hull.RemoveOldest();
+  EXPECT_EQ(Polygon({{0, 1}, {1, 1}, {1, 0}}), hull.Snapshot());
+  EXPECT_EQ(Point(1, 0), hull.ExtremePoint(Point(-1, -1.5)));
+  hull.RemoveOldest();
+  hull.RemoveOldest();
+  EXPECT_EQ(Polygon({{0, 1}, {0.5, 0.5}}), hull.Snapshot());
+  hull.RemoveOldest();
+  hull.RemoveOldest();
+  EXPECT_TRUE(hull.empty());
+  EXPECT_EQ(Polygon(), hull.Snapshot());
+}
+
+TEST(SlidingWindowConvexHullTest, RepeatedPoints) {
+  SlidingWindowConvexHull hull;
+  hull.Insert(Point(2, 3));
+  for (int i = 0; i < 3; ++i) {
+    hull.Insert(Point(1, 1));
+  }
+  EXPECT_EQ(Polygon({{1, 1}, {2, 3}}), hull.Snapshot());
+  hull.RemoveOldest();
+  EXPECT_EQ(ConvexHull(vector<Point>(3, Point(1, 1))), hull.Snapshot());
+  EXPECT_EQ(Polygon({{1, 1}, {1, 1}}), hull.Snapshot());
+  EXPECT_EQ(Point(1, 1), hull.ExtremePoint(Point(0, -1)));
+  hull.RemoveOldest();
+  EXPECT_EQ(Polygon({{1, 1}, {1, 1}}), hull.Snapshot());
+  hull.RemoveOldest();
+  EXPECT_EQ(Polygon({{1, 1}}), hull.Snapshot());
+}
+
+TEST(SlidingWindowConvexHullTest, SameAsConvexHull) {
+  const Point directions[] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1},
+                              {0.6, 0.8}, {-0.28, -0.96}};
+  for (auto distribution : {UNIFORM_SQUARE, UNIFORM_DISK, ON_CIRCLE,
+                            CLUSTERED, DEGENERATE}) {
+    vector<Point> points = RandomPoints(distribution, 3000, 9);
+    for (size_t window : {1, 7, 64, 500}) {
+      SlidingWindowConvexHull hull;
+      for (size_t i = 0; i < points.size(); ++i) {
+        hull.Insert(points[i]);
+        if (i >= window) {
+          hull.RemoveOldest();
+        }
+        if (i % 97 != 0) {
+          continue;
+        }
+        size_t begin = i >= window ? i + 1 - window : 0;
+        vector<Point> in_window(points.begin() + begin,
+                                points.begin() + i + 1);
+        ASSERT_EQ(in_window.size(), hull.size());
+        EXPECT_EQ(ConvexHull(in_window), hull.Snapshot())
+            << PointDistributionName(distribution) << " " << window << " "
+            << i;
+        for (Point d : directions) {
+          double best = Dot(in_window[0], d);
+          for (Point p : in_window) {
+            best = std::max(best, Dot(p, d));
+          }
+          EXPECT_EQ(best, Dot(hull.ExtremePoint(d), d))
+              << PointDistributionName(distribution) << " " << window << " "
+              << i;
+        }
+      }
+    }
+  }
+}
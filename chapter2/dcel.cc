@@ -0,0 +1,486 @@
+#include "chapter2/dcel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include "base/predicates.h"
+#include "base/radix-sort.h"
+#include "chapter2/grid-intersection.h"
+#include "chapter2/segment-intersection.h"
+
+using std::pair;
+using std::vector;
+
+const uint32_t Dcel::kNone;
+const uint32_t Dcel::kUnboundedFace;
+
+namespace {
+
+using grid_intersection_internal::Grid;
+
+// A half-edge leaving its origin.
+struct Outgoing {
+  Point origin;
+  uint32_t half_edge;
+};
+
+// The other end of half-edge e of the segments.
+Point Destination(Span<const Segment> segments, uint32_t e) {
+  return segments[e >> 1].endpoint(1 - (e & 1));
+}
+
+// Orders half-edges leaving the same point counterclockwise, starting just
+// after the downward direction: first those to lexicographically larger
+// points, which are the even ones, and then those to smaller points. Each
+// group spans less than a half-turn, so one orientation test orders two
+// half-edges of a group.
+bool AngleLess(Span<const Segment> segments, const Outgoing& lhs,
+               const Outgoing& rhs) {
+  bool lhs_up = (lhs.half_edge & 1) == 0;
+  bool rhs_up = (rhs.half_edge & 1) == 0;
+  if (lhs_up != rhs_up) {
+    return lhs_up;
+  }
+  return Orientation(lhs.origin, Destination(segments, lhs.half_edge),
+                     Destination(segments, rhs.half_edge)) > 0;
+}
+
+// Whether s passes above t right after the vertical line through a point,
+// for segments that both cross that line or start on it and that meet at
+// most at an endpoint of both. Decided exactly by where the segment starting
+// further right starts relative to the other one; segments starting at the
+// same point are told apart by where they end.
+bool Above(const Segment& s, const Segment& t) {
+  Point sa = s.endpoint(0), sb = s.endpoint(1);
+  Point ta = t.endpoint(0), tb = t.endpoint(1);
+  if (sa.x >= ta.x) {
+    int side = Orientation(ta, tb, sa);
+    return side != 0 ? side > 0 : Orientation(ta, tb, sb) > 0;
+  }
+  int side = Orientation(sa, sb, ta);
+  return side != 0 ? side < 0 : Orientation(sa, sb, tb) < 0;
+}
+
+// Finds the segment right below a point, by walking down the column of
+// cells of a uniform grid that holds it, like the one of
+// GridFindIntersections. Segments are bucketed into the cells their
+// bounding boxes overlap, so with the cell size chosen by the grid, a query
+// usually looks at a few segments in one or two cells, where a plane sweep
+// would keep every segment in a search tree on the way.
+class EdgeFinder {
+ public:
+  explicit EdgeFinder(Span<const Segment> segments)
+      : segments_(segments), grid_(segments, GridIntersectionOptions()) {
+    begin_.assign(grid_.num_cells() + 1, 0);
+    ForEachCell([this](uint32_t, int cell) { ++begin_[cell + 1]; });
+    for (int cell = 0; cell < grid_.num_cells(); ++cell) {
+      begin_[cell + 1] += begin_[cell];
+    }
+    cell_segments_.resize(begin_.back());
+    vector<uint32_t> next(begin_.begin(), begin_.end() - 1);
+    ForEachCell([&](uint32_t i, int cell) {
+      cell_segments_[next[cell]++] = i;
+    });
+  }
+
+  // The segment crossing the vertical line through p, or starting on it,
+  // that is highest among those passing below p, or Dcel::kNone.
+  uint32_t HighestBelow(Point p) const {
+    uint32_t best = Dcel::kNone;
+    int column = grid_.Column(p.x);
+    for (int row = grid_.Row(p.y); row >= 0; --row) {
+      int cell = row * grid_.num_columns() + column;
+      for (uint32_t j = begin_[cell]; j < begin_[cell + 1]; ++j) {
+        uint32_t i = cell_segments_[j];
+        Point a = segments_[i].endpoint(0), b = segments_[i].endpoint(1);
+        if (!(a.x <= p.x && p.x < b.x) || Orientation(a, b, p) <= 0) {
+          continue;
+        }
+        if (best == Dcel::kNone || Above(segments_[i], segments_[best])) {
+          best = i;
+        }
+      }
+      // Segments only in the cells further down lie below this row, so
+      // lower than best if it crosses the line through p in the row. That
+      // is checked at the rounded height of the crossing, lowered by more
+      // than its rounding error, and confirmed to be below the exact one.
+      if (best != Dcel::kNone) {
+        const double kError = 8 * std::numeric_limits<double>::epsilon();
+        Point a = segments_[best].endpoint(0), b = segments_[best].endpoint(1);
+        double y = a.y + (b.y - a.y) * ((p.x - a.x) / (b.x - a.x))
+            - kError * (std::fabs(a.y) + std::fabs(b.y));
+        if (grid_.Row(y) >= row && Orientation(a, b, Point(p.x, y)) <= 0) {
+          break;
+        }
+      }
+    }
+    return best;
+  }
+
+ private:
+  // Calls fn(i, cell) for every cell that the bounding box of segment i
+  // overlaps.
+  template<class Function>
+  void ForEachCell(const Function& fn) const {
+    for (uint32_t i = 0; i < segments_.size(); ++i) {
+      const Segment& s = segments_[i];
+      int low = grid_.Row(std::min(s.endpoint(0).y, s.endpoint(1).y));
+      int high = grid_.Row(std::max(s.endpoint(0).y, s.endpoint(1).y));
+      int left = grid_.Column(s.endpoint(0).x);
+      int right = grid_.Column(s.endpoint(1).x);
+      for (int row = low; row <= high; ++row) {
+        for (int column = left; column <= right; ++column) {
+          fn(i, row * grid_.num_columns() + column);
+        }
+      }
+    }
+  }
+
+  Span<const Segment> segments_;
+  Grid grid_;
+  // The segments in cell c are cell_segments_[begin_[c]] up to
+  // cell_segments_[begin_[c + 1]].
+  vector<uint32_t> begin_;
+  vector<uint32_t> cell_segments_;
+};
+
+}  // namespace
+
+Dcel::Dcel() : faces_(1, Face{kNone}), inner_begin_(2, 0) {}
+
+size_t Dcel::bytes_used() const {
+  return vertices_.size() * sizeof(Vertex)
+      + half_edges_.size() * sizeof(HalfEdge)
+      + faces_.size() * sizeof(Face)
+      + (inner_begin_.size() + inner_components_.size()) * sizeof(uint32_t);
+}
+
+Dcel Dcel::FromSegments(Span<const Segment> segments) {
+  Dcel dcel;
+  const uint32_t num_half_edges = 2 * segments.size();
+  if (num_half_edges == 0) {
+    return dcel;
+  }
+
+  // Sort the half-edges by origin, and those with the same origin by angle,
+  // like the endpoint events of FindIntersections: a radix sort by x, then
+  // a sort of each run with the same x.
+  vector<Outgoing> outgoing(num_half_edges);
+  for (uint32_t e = 0; e < num_half_edges; ++e) {
+    outgoing[e] = Outgoing{segments[e >> 1].endpoint(e & 1), e};
+  }
+  {
+    vector<Outgoing> scratch(num_half_edges);
+    RadixSort(outgoing.data(), outgoing.size(), scratch.data(),
+              [](const Outgoing& o) { return OrderedKey(o.origin.x); });
+  }
+  auto less = [segments](const Outgoing& lhs, const Outgoing& rhs) {
+    if (lhs.origin.y != rhs.origin.y) {
+      return lhs.origin.y < rhs.origin.y;
+    }
+    return AngleLess(segments, lhs, rhs);
+  };
+  for (auto run = outgoing.begin(); run != outgoing.end();) {
+    auto run_end = run + 1;
+    while (run_end != outgoing.end() && run_end->origin.x == run->origin.x) {
+      ++run_end;
+    }
+    std::sort(run, run_end, less);
+    run = run_end;
+  }
+
+  // The half-edges leaving vertex v are outgoing[first[v]] up to
+  // outgoing[first[v + 1]], in counterclockwise order. The face to the left
+  // of one lies between it and the next; so the half-edge coming in along
+  // one continues along the one before it.
+  vector<HalfEdge>& half_edges = dcel.half_edges_;
+  half_edges.resize(num_half_edges);
+  vector<uint32_t> first;
+  for (uint32_t i = 0; i < num_half_edges; ++i) {
+    if (i == 0 || outgoing[i].origin != outgoing[i - 1].origin) {
+      first.push_back(i);
+      dcel.vertices_.push_back(Vertex{outgoing[i].origin,
+                                      outgoing[i].half_edge});
+    }
+    half_edges[outgoing[i].half_edge].origin = dcel.vertices_.size() - 1;
+  }
+  const uint32_t num_vertices = dcel.vertices_.size();
+  first.push_back(num_half_edges);
+  for (uint32_t v = 0; v < num_vertices; ++v) {
+    uint32_t previous = outgoing[first[v + 1] - 1].half_edge;
+    for (uint32_t i = first[v]; i < first[v + 1]; ++i) {
+      uint32_t e = outgoing[i].half_edge;
+      half_edges[Twin(e)].next = previous;
+      half_edges[previous].prev = Twin(e);
+      previous = e;
+    }
+  }
+
+  // Trace the boundary cycles, keeping the cycle of each half-edge in its
+  // face field until the faces are known.
+  for (HalfEdge& e : half_edges) {
+    e.face = kNone;
+  }
+  vector<uint32_t> cycle_edge;
+  vector<uint32_t> cycle_vertex;
+  for (uint32_t start = 0; start < num_half_edges; ++start) {
+    if (half_edges[start].face != kNone) {
+      continue;
+    }
+    uint32_t cycle = cycle_edge.size();
+    uint32_t lowest = half_edges[start].origin;
+    uint32_t e = start;
+    do {
+      half_edges[e].face = cycle;
+      lowest = std::min(lowest, half_edges[e].origin);
+      e = half_edges[e].next;
+    } while (e != start);
+    cycle_edge.push_back(start);
+    cycle_vertex.push_back(lowest);
+  }
+
+  // All edges of a cycle leave its smallest vertex v toward larger points.
+  // The face of the cycle lies left of v, outside the cycle, exactly when
+  // it takes the turn at v from the last half-edge leaving v around to the
+  // first; such a cycle is a hole, and the others are outer boundaries.
+  const uint32_t num_cycles = cycle_edge.size();
+  vector<uint32_t> cycle_face(num_cycles, kNone);
+  // Pairs of the smallest vertex and the cycle of each hole.
+  vector<pair<uint32_t, uint32_t>> holes;
+  for (uint32_t c = 0; c < num_cycles; ++c) {
+    uint32_t v = cycle_vertex[c];
+    if (half_edges[Twin(dcel.vertices_[v].incident_edge)].face == c) {
+      holes.push_back(std::make_pair(v, c));
+    } else {
+      cycle_face[c] = dcel.faces_.size();
+      dcel.faces_.push_back(Face{cycle_edge[c]});
+    }
+  }
+
+  // The hole around the smallest vertex of all lies in the unbounded face.
+  // Every other hole lies in the face directly below its smallest vertex,
+  // which is the face above the highest edge crossing the vertical line
+  // through the vertex below it; edges on the line, or ending on it from the
+  // left, do not come between the two. That edge has a smaller left endpoint
+  // than the vertex, so its face belongs to an outer boundary or to a hole
+  // placed before.
+  std::sort(holes.begin(), holes.end());
+  if (holes.size() == 1) {
+    cycle_face[holes[0].second] = kUnboundedFace;
+  } else {
+    EdgeFinder below(segments);
+    for (const auto& hole : holes) {
+      uint32_t i = below.HighestBelow(dcel.vertices_[hole.first].point);
+      // Half-edge 2i runs left to right, with the face above to its left.
+      cycle_face[hole.second] = i == kNone
+          ? kUnboundedFace
+          : cycle_face[half_edges[2 * i].face];
+    }
+  }
+
+  for (HalfEdge& e : half_edges) {
+    e.face = cycle_face[e.face];
+  }
+  // List the holes of each face by a counting sort on the face.
+  const uint32_t num_faces = dcel.faces_.size();
+  dcel.inner_begin_.assign(num_faces + 1, 0);
+  for (const auto& hole : holes) {
+    ++dcel.inner_begin_[cycle_face[hole.second] + 1];
+  }
+  for (uint32_t f = 0; f < num_faces; ++f) {
+    dcel.inner_begin_[f + 1] += dcel.inner_begin_[f];
+  }
+  dcel.inner_components_.resize(holes.size());
+  vector<uint32_t> next_inner(dcel.inner_begin_.begin(),
+                              dcel.inner_begin_.end() - 1);
+  for (const auto& hole : holes) {
+    uint32_t f = cycle_face[hole.second];
+    dcel.inner_components_[next_inner[f]++] = cycle_edge[hole.second];
+  }
+  return dcel;
+}
+
+namespace {
+
+// A piece of an edge of the overlay, with the edges of the inputs that it
+// lies on, or kNone.
+struct Piece {
+  Segment segment;
+  uint32_t red_edge;
+  uint32_t blue_edge;
+};
+
+// The edges of a subdivision as segments; segment i runs from the origin of
+// half-edge 2i.
+vector<Segment> EdgeSegments(const Dcel& dcel) {
+  vector<Segment> segments;
+  segments.reserve(dcel.num_edges());
+  for (uint32_t i = 0; i < dcel.num_edges(); ++i) {
+    segments.push_back(Segment(dcel.Origin(2 * i), dcel.Destination(2 * i)));
+  }
+  return segments;
+}
+
+// Cuts each segment at the points listed for it, which are pairs of the
+// index of the segment and the point, in lexicographic order of the points,
+// and appends the pieces to pieces. Pieces of segment i get edge i of the
+// input as their red or blue edge.
+void AppendPieces(const vector<Segment>& segments,
+                  const vector<pair<uint32_t, Point>>& cuts, bool red,
+                  vector<Piece>* pieces) {
+  // Group the cuts by segment with a counting sort, which keeps the points
+  // of each segment in order.
+  vector<uint32_t> begin(segments.size() + 1, 0);
+  for (const auto& cut : cuts) {
+    ++begin[cut.first + 1];
+  }
+  for (size_t i = 0; i < segments.size(); ++i) {
+    begin[i + 1] += begin[i];
+  }
+  vector<Point> points(cuts.size());
+  {
+    vector<uint32_t> next(begin.begin(), begin.end() - 1);
+    for (const auto& cut : cuts) {
+      points[next[cut.first]++] = cut.second;
+    }
+  }
+  for (uint32_t i = 0; i < segments.size(); ++i) {
+    Point from = segments[i].endpoint(0);
+    for (uint32_t j = begin[i]; j <= begin[i + 1]; ++j) {
+      Point to = j < begin[i + 1] ? points[j] : segments[i].endpoint(1);
+      pieces->push_back(Piece{Segment(from, to), red ? i : Dcel::kNone,
+                              red ? Dcel::kNone : i});
+      from = to;
+    }
+  }
+}
+
+// Sets label[f] for every face f of overlay that is not labeled yet, from a
+// labeled neighbor across an edge for which has_edge is false. Face 0 and
+// the faces bounded by such edges must be labeled.
+template<class HasEdge>
+void SpreadLabels(const Dcel& overlay, HasEdge has_edge,
+                  vector<uint32_t>* label) {
+  vector<uint32_t> stack;
+  for (uint32_t f = 0; f < overlay.num_faces(); ++f) {
+    if ((*label)[f] != Dcel::kNone) {
+      stack.push_back(f);
+    }
+  }
+  auto visit_cycle = [&](uint32_t start, uint32_t value) {
+    uint32_t e = start;
+    do {
+      if (!has_edge(e >> 1)) {
+        uint32_t g = overlay.half_edge(Dcel::Twin(e)).face;
+        if ((*label)[g] == Dcel::kNone) {
+          (*label)[g] = value;
+          stack.push_back(g);
+        }
+      }
+      e = overlay.half_edge(e).next;
+    } while (e != start);
+  };
+  while (!stack.empty()) {
+    uint32_t f = stack.back();
+    stack.pop_back();
+    uint32_t value = (*label)[f];
+    if (overlay.face(f).outer_component != Dcel::kNone) {
+      visit_cycle(overlay.face(f).outer_component, value);
+    }
+    for (uint32_t e : overlay.inner_components(f)) {
+      visit_cycle(e, value);
+    }
+  }
+}
+
+}  // namespace
+
+Dcel MapOverlay(const Dcel& red, const Dcel& blue,
+                vector<OverlayLabel>* labels) {
+  const vector<Segment> red_segments = EdgeSegments(red);
+  const vector<Segment> blue_segments = EdgeSegments(blue);
+  // Where an edge of one input meets one of the other in its interior, the
+  // edge is cut.
+  vector<pair<uint32_t, Point>> red_cuts, blue_cuts;
+  FindRedBlueIntersections(
+      red_segments, blue_segments, [&](const RedBlueIntersection& meeting) {
+        Point p = meeting.point;
+        for (int i : meeting.red) {
+          if (p != red_segments[i].endpoint(0)
+              && p != red_segments[i].endpoint(1)) {
+            red_cuts.push_back(std::make_pair(i, p));
+          }
+        }
+        for (int i : meeting.blue) {
+          if (p != blue_segments[i].endpoint(0)
+              && p != blue_segments[i].endpoint(1)) {
+            blue_cuts.push_back(std::make_pair(i, p));
+          }
+        }
+        return true;
+      });
+
+  vector<Piece> pieces;
+  pieces.reserve(red_segments.size() + red_cuts.size()
+                 + blue_segments.size() + blue_cuts.size());
+  AppendPieces(red_segments, red_cuts, true, &pieces);
+  AppendPieces(blue_segments, blue_cuts, false, &pieces);
+  // Overlapping edges of the two inputs have been cut into equal pieces,
+  // which become one edge.
+  std::sort(pieces.begin(), pieces.end(),
+            [](const Piece& lhs, const Piece& rhs) {
+              return lhs.segment.endpoints() < rhs.segment.endpoints();
+            });
+  size_t num_pieces = 0;
+  for (size_t i = 0; i < pieces.size(); ++i) {
+    if (num_pieces > 0
+        && pieces[i].segment.endpoints()
+            == pieces[num_pieces - 1].segment.endpoints()) {
+      Piece& merged = pieces[num_pieces - 1];
+      merged.red_edge = std::min(merged.red_edge, pieces[i].red_edge);
+      merged.blue_edge = std::min(merged.blue_edge, pieces[i].blue_edge);
+    } else {
+      pieces[num_pieces++] = pieces[i];
+    }
+  }
+  pieces.erase(pieces.begin() + num_pieces, pieces.end());
+
+  vector<Segment> segments;
+  segments.reserve(pieces.size());
+  for (const Piece& piece : pieces) {
+    segments.push_back(piece.segment);
+  }
+  Dcel overlay = Dcel::FromSegments(segments);
+  if (labels == nullptr) {
+    return overlay;
+  }
+
+  // Half-edge 2i + j of the overlay runs along half-edge 2k + j of an input
+  // edge k that it lies on, as both run from the smaller end of the edge.
+  vector<uint32_t> red_label(overlay.num_faces(), Dcel::kNone);
+  vector<uint32_t> blue_label(overlay.num_faces(), Dcel::kNone);
+  red_label[Dcel::kUnboundedFace] = Dcel::kUnboundedFace;
+  blue_label[Dcel::kUnboundedFace] = Dcel::kUnboundedFace;
+  for (uint32_t e = 0; e < overlay.num_half_edges(); ++e) {
+    const Piece& piece = pieces[e >> 1];
+    uint32_t f = overlay.half_edge(e).face;
+    if (piece.red_edge != Dcel::kNone) {
+      red_label[f] = red.half_edge(2 * piece.red_edge + (e & 1)).face;
+    }
+    if (piece.blue_edge != Dcel::kNone) {
+      blue_label[f] = blue.half_edge(2 * piece.blue_edge + (e & 1)).face;
+    }
+  }
+  SpreadLabels(overlay,
+               [&](uint32_t i) { return pieces[i].red_edge != Dcel::kNone; },
+               &red_label);
+  SpreadLabels(overlay,
+               [&](uint32_t i) { return pieces[i].blue_edge != Dcel::kNone; },
+               &blue_label);
+  labels->resize(overlay.num_faces());
+  for (uint32_t f = 0; f < overlay.num_faces(); ++f) {
+    (*labels)[f] = OverlayLabel{red_label[f], blue_label[f]};
+  }
+  return overlay;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "base/base.h"
+#include "base/span.h"
+
+// A doubly-connected edge list on page 31: the vertices, edges and faces of
+// a planar subdivision, with the edges split into two directed half-edges
+// that bound the face to their left. Records refer to each other by 32-bit
+// indices into three contiguous arrays, one per kind of record, rather than
+// by pointers to nodes allocated one by one, which halves the size of a
+// reference and keeps records that are built together next to each other.
+//
+// Edge i is the pair of half-edges 2i and 2i + 1, so that the twin of a
+// half-edge is not stored; half-edge 2i runs from the lexicographically
+// smaller end of the edge to the larger one. Vertices are numbered in
+// lexicographic order of their points. Face 0 is the unbounded face.
+// Bounded faces have their outer boundary counterclockwise; the boundaries
+// of holes, and the outer boundary of the whole subdivision, run clockwise.
+class Dcel {
+ public:
+  // A missing record, such as the outer component of the unbounded face.
+  static const uint32_t kNone = 0xffffffff;
+  static const uint32_t kUnboundedFace = 0;
+
+  struct Vertex {
+    Point point;
+    // A half-edge with the vertex as its origin.
+    uint32_t incident_edge;
+  };
+
+  struct HalfEdge {
+    uint32_t origin;
+    // The half-edges before and after this one around its face.
+    uint32_t next;
+    uint32_t prev;
+    // The face to the left.
+    uint32_t face;
+  };
+
+  struct Face {
+    // A half-edge on the outer boundary, or kNone for the unbounded face.
+    // Holes are listed by inner_components.
+    uint32_t outer_component;
+  };
+
+  // The subdivision of the plane into the unbounded face alone.
+  Dcel();
+
+  // The subdivision formed by the segments, which must not cross or overlap
+  // one another, though they may share endpoints, and must not have equal
+  // endpoints. Segment i becomes edge i. The endpoints are radix sorted into
+  // vertices, and the edges around each vertex are sorted by angle with
+  // exact predicates, which links every boundary cycle. The face holding
+  // each hole is the one directly below its smallest vertex, found by
+  // walking down a uniform grid of the segments; when the segments form one
+  // connected piece there is no hole to place. Takes O(n log n) time, plus
+  // the walks, which cross about one cell each on maps like those of
+  // RandomSubdivision.
+  static Dcel FromSegments(Span<const Segment> segments);
+
+  size_t num_vertices() const { return vertices_.size(); }
+  size_t num_half_edges() const { return half_edges_.size(); }
+  size_t num_edges() const { return half_edges_.size() / 2; }
+  size_t num_faces() const { return faces_.size(); }
+
+  const Vertex& vertex(uint32_t v) const { return vertices_[v]; }
+  const HalfEdge& half_edge(uint32_t e) const { return half_edges_[e]; }
+  const Face& face(uint32_t f) const { return faces_[f]; }
+
+  // A half-edge on each hole in face f, one per boundary cycle.
+  Span<const uint32_t> inner_components(uint32_t f) const {
+    return Span<const uint32_t>(inner_components_.data() + inner_begin_[f],
+                                inner_begin_[f + 1] - inner_begin_[f]);
+  }
+
+  static uint32_t Twin(uint32_t e) { return e ^ 1; }
+  Point Origin(uint32_t e) const {
+    return vertices_[half_edges_[e].origin].point;
+  }
+  Point Destination(uint32_t e) const { return Origin(Twin(e)); }
+
+  // The bytes taken by the records.
+  size_t bytes_used() const;
+
+ private:
+  std::vector<Vertex> vertices_;
+  std::vector<HalfEdge> half_edges_;
+  std::vector<Face> faces_;
+  // The holes of face f are inner_components_[inner_begin_[f]] up to
+  // inner_components_[inner_begin_[f + 1]].
+  std::vector<uint32_t> inner_begin_;
+  std::vector<uint32_t> inner_components_;
+};
+
+// The faces of two overlaid subdivisions that hold a face of their overlay.
+struct OverlayLabel {
+  uint32_t red_face;
+  uint32_t blue_face;
+};
+
+// The overlay of two subdivisions on page 33, such as land use and parcels:
+// the subdivision formed by the edges of both, cut where they cross. The
+// crossings come from the red-blue sweep of FindRedBlueIntersections, which
+// only stops at endpoints and at points where edges of both inputs meet.
+// Edges of the inputs that overlap become one edge. Unless labels is null,
+// (*labels)[f] is set to the faces of red and blue that hold face f of the
+// overlay. A face bounded by an edge of an input gets its label for that
+// input from the edge, and the label spreads from there to neighboring faces
+// across edges that do not come from the input, in O(n) time in all.
+// Crossing points are rounded to doubles, like those of FindIntersections.
+Dcel MapOverlay(const Dcel& red, const Dcel& blue,
+                std::vector<OverlayLabel>* labels);
@@ -0,0 +1,414 @@
+#include "chapter2/dcel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "base/predicates.h"
+#include "base/workload.h"
+#include "gtest/gtest.h"
+
+using std::vector;
+
+namespace {
+
+double Cross(Point a, Point b) {
+  return a.x * b.y - a.y * b.x;
+}
+
+// The half-edges of the cycle through e, in order.
+vector<uint32_t> Cycle(const Dcel& dcel, uint32_t e) {
+  vector<uint32_t> cycle;
+  uint32_t start = e;
+  do {
+    cycle.push_back(e);
+    e = dcel.half_edge(e).next;
+  } while (e != start && cycle.size() <= dcel.num_half_edges());
+  return cycle;
+}
+
+double CycleArea(const Dcel& dcel, uint32_t e) {
+  double twice_area = 0;
+  for (uint32_t d : Cycle(dcel, e)) {
+    twice_area += Cross(dcel.Origin(d), dcel.Destination(d));
+  }
+  return twice_area / 2;
+}
+
+// The signed areas of the faces, from all their boundary cycles.
+vector<double> FaceAreas(const Dcel& dcel) {
+  vector<double> areas(dcel.num_faces(), 0);
+  for (uint32_t e = 0; e < dcel.num_half_edges(); ++e) {
+    areas[dcel.half_edge(e).face] +=
+        Cross(dcel.Origin(e), dcel.Destination(e)) / 2;
+  }
+  return areas;
+}
+
+// The half-edge from p to q.
+uint32_t HalfEdgeBetween(const Dcel& dcel, Point p, Point q) {
+  for (uint32_t e = 0; e < dcel.num_half_edges(); ++e) {
+    if (dcel.Origin(e) == p && dcel.Destination(e) == q) {
+      return e;
+    }
+  }
+  ADD_FAILURE() << "no half-edge from " << p << " to " << q;
+  return 0;
+}
+
+uint32_t FaceLeftOf(const Dcel& dcel, Point p, Point q) {
+  return dcel.half_edge(HalfEdgeBetween(dcel, p, q)).face;
+}
+
+uint32_t Find(vector<uint32_t>* parent, uint32_t v) {
+  while ((*parent)[v] != v) {
+    v = (*parent)[v] = (*parent)[(*parent)[v]];
+  }
+  return v;
+}
+
+// Checks the links between the records, the orientation of the boundary
+// cycles, and Euler's formula V - E + F = 1 + C for C connected pieces.
+void ExpectValid(const Dcel& dcel) {
+  ASSERT_LE(1, dcel.num_faces());
+  EXPECT_EQ(Dcel::kNone, dcel.face(Dcel::kUnboundedFace).outer_component);
+  for (uint32_t v = 0; v < dcel.num_vertices(); ++v) {
+    ASSERT_EQ(v, dcel.half_edge(dcel.vertex(v).incident_edge).origin);
+    if (v > 0) {
+      ASSERT_LT(dcel.vertex(v - 1).point, dcel.vertex(v).point);
+    }
+  }
+  for (uint32_t e = 0; e < dcel.num_half_edges(); ++e) {
+    const Dcel::HalfEdge& h = dcel.half_edge(e);
+    ASSERT_EQ(e, dcel.half_edge(h.next).prev);
+    ASSERT_EQ(e, dcel.half_edge(h.prev).next);
+    ASSERT_EQ(dcel.half_edge(Dcel::Twin(e)).origin,
+              dcel.half_edge(h.next).origin);
+    ASSERT_EQ(h.face, dcel.half_edge(h.next).face);
+    ASSERT_LT(h.face, dcel.num_faces());
+    if (e % 2 == 0) {
+      ASSERT_LT(dcel.Origin(e), dcel.Destination(e));
+    }
+  }
+  // Every cycle is the outer boundary or a hole of its face, just once.
+  size_t num_cycles = 0;
+  vector<bool> seen(dcel.num_half_edges(), false);
+  for (uint32_t e = 0; e < dcel.num_half_edges(); ++e) {
+    if (!seen[e]) {
+      ++num_cycles;
+      for (uint32_t d : Cycle(dcel, e)) {
+        seen[d] = true;
+      }
+    }
+  }
+  size_t num_components = 0;
+  for (uint32_t f = 0; f < dcel.num_faces(); ++f) {
+    uint32_t outer = dcel.face(f).outer_component;
+    if (f != Dcel::kUnboundedFace) {
+      ASSERT_EQ(f, dcel.half_edge(outer).face);
+      EXPECT_LT(0, CycleArea(dcel, outer));
+      ++num_components;
+    }
+    for (uint32_t e : dcel.inner_components(f)) {
+      ASSERT_EQ(f, dcel.half_edge(e).face);
+      EXPECT_GE(0, CycleArea(dcel, e));
+      ++num_components;
+    }
+  }
+  EXPECT_EQ(num_cycles, num_components);
+
+  vector<uint32_t> parent(dcel.num_vertices());
+  for (uint32_t v = 0; v < parent.size(); ++v) {
+    parent[v] = v;
+  }
+  size_t num_pieces = dcel.num_vertices();
+  for (uint32_t e = 0; e < dcel.num_half_edges(); e += 2) {
+    uint32_t a = Find(&parent, dcel.half_edge(e).origin);
+    uint32_t b = Find(&parent, dcel.half_edge(e + 1).origin);
+    if (a != b) {
+      parent[a] = b;
+      --num_pieces;
+    }
+  }
+  EXPECT_EQ(1 + num_pieces, dcel.num_vertices() - dcel.num_edges()
+                                + dcel.num_faces());
+}
+
+// Whether p lies inside the cycle through e, by the even-odd rule.
+bool CycleContains(const Dcel& dcel, uint32_t e, Point p) {
+  bool inside = false;
+  for (uint32_t d : Cycle(dcel, e)) {
+    Point a = dcel.Origin(d), b = dcel.Destination(d);
+    if ((a.y <= p.y && p.y < b.y && Orientation(a, b, p) > 0)
+        || (b.y <= p.y && p.y < a.y && Orientation(a, b, p) < 0)) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+// Checks the face of every hole against the innermost outer boundary around
+// its smallest vertex, found by testing all of them.
+void ExpectHolesPlaced(const Dcel& dcel) {
+  for (uint32_t f = 0; f < dcel.num_faces(); ++f) {
+    for (uint32_t e : dcel.inner_components(f)) {
+      Point lowest = dcel.Origin(e);
+      for (uint32_t d : Cycle(dcel, e)) {
+        lowest = std::min(lowest, dcel.Origin(d));
+      }
+      uint32_t expected = Dcel::kUnboundedFace;
+      double smallest = INFINITY;
+      for (uint32_t g = 1; g < dcel.num_faces(); ++g) {
+        uint32_t outer = dcel.face(g).outer_component;
+        vector<uint32_t> cycle = Cycle(dcel, outer);
+        bool through = std::any_of(cycle.begin(), cycle.end(),
+                                   [&](uint32_t d) {
+                                     return dcel.Origin(d) == lowest;
+                                   });
+        double area = CycleArea(dcel, outer);
+        if (!through && area < smallest
+            && CycleContains(dcel, outer, lowest)) {
+          expected = g;
+          smallest = area;
+        }
+      }
+      EXPECT_EQ(expected, f) << lowest;
+    }
+  }
+}
+
+vector<Segment> Square(double x0, double y0, double x1, double y1) {
+  return {Segment(Point(x0, y0), Point(x1, y0)),
+          Segment(Point(x1, y0), Point(x1, y1)),
+          Segment(Point(x1, y1), Point(x0, y1)),
+          Segment(Point(x0, y1), Point(x0, y0))};
+}
+
+// The edges of a k x k lattice of unit squares with about a third of them
+// left out, which leaves many pieces lying directly above vertices of
+// others.
+vector<Segment> SparseLattice(int k, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> unit(0, 1);
+  vector<Segment> segments;
+  for (int i = 0; i <= k; ++i) {
+    for (int j = 0; j <= k; ++j) {
+      if (i < k && unit(rng) < 0.6) {
+        segments.push_back(Segment(Point(i, j), Point(i + 1, j)));
+      }
+      if (j < k && unit(rng) < 0.6) {
+        segments.push_back(Segment(Point(i, j), Point(i, j + 1)));
+      }
+    }
+  }
+  return segments;
+}
+
+}  // namespace
+
+TEST(DcelTest, Empty) {
+  Dcel dcel = Dcel::FromSegments(vector<Segment>());
+  EXPECT_EQ(0, dcel.num_vertices());
+  EXPECT_EQ(0, dcel.num_half_edges());
+  ASSERT_EQ(1, dcel.num_faces());
+  EXPECT_EQ(0, dcel.inner_components(Dcel::kUnboundedFace).size());
+  ExpectValid(Dcel());
+}
+
+TEST(DcelTest, Square) {
+  Dcel dcel = Dcel::FromSegments(Square(0, 0, 1, 1));
+  ExpectValid(dcel);
+  ASSERT_EQ(4, dcel.num_vertices());
+  EXPECT_EQ(Point(0, 0), dcel.vertex(0).point);
+  EXPECT_EQ(Point(1, 1), dcel.vertex(3).point);
+  EXPECT_EQ(8, dcel.num_half_edges());
+  ASSERT_EQ(2, dcel.num_faces());
+  EXPECT_EQ(4, Cycle(dcel, dcel.face(1).outer_component).size());
+  EXPECT_EQ(1, CycleArea(dcel, dcel.face(1).outer_component));
+  ASSERT_EQ(1, dcel.inner_components(0).size());
+  EXPECT_EQ(-1, CycleArea(dcel, dcel.inner_components(0)[0]));
+  EXPECT_EQ(0, dcel.inner_components(1).size());
+  EXPECT_EQ(1, FaceLeftOf(dcel, Point(0, 0), Point(1, 0)));
+  EXPECT_EQ(0, FaceLeftOf(dcel, Point(1, 0), Point(0, 0)));
+}
+
+TEST(DcelTest, HolesAndDanglingEdges) {
+  vector<Segment> segments = Square(0, 0, 4, 4);
+  // A triangle inside, above the bottom edge.
+  segments.push_back(Segment(Point(1, 1), Point(2, 1)));
+  segments.push_back(Segment(Point(2, 1), Point(1, 2)));
+  segments.push_back(Segment(Point(1, 2), Point(1, 1)));
+  // An edge dangling from a corner.
+  segments.push_back(Segment(Point(0, 0), Point(0.5, 0.5)));
+  // A vertical edge inside, and a triangle right above its upper end.
+  segments.push_back(Segment(Point(3, 1), Point(3, 3)));
+  segments.push_back(Segment(Point(3, 3.25), Point(3.5, 3.5)));
+  segments.push_back(Segment(Point(3.5, 3.5), Point(3, 3.75)));
+  segments.push_back(Segment(Point(3, 3.75), Point(3, 3.25)));
+  // A square outside, and an edge above it.
+  vector<Segment> outside = Square(5, 0, 6, 1);
+  segments.insert(segments.end(), outside.begin(), outside.end());
+  segments.push_back(Segment(Point(5.5, 2), Point(6, 3)));
+
+  Dcel dcel = Dcel::FromSegments(segments);
+  ExpectValid(dcel);
+  ExpectHolesPlaced(dcel);
+  EXPECT_EQ(segments.size(), dcel.num_edges());
+  ASSERT_EQ(5, dcel.num_faces());
+  uint32_t square = FaceLeftOf(dcel, Point(0, 0), Point(4, 0));
+  EXPECT_EQ(square, FaceLeftOf(dcel, Point(2, 1), Point(1, 1)));
+  EXPECT_EQ(square, FaceLeftOf(dcel, Point(0.5, 0.5), Point(0, 0)));
+  EXPECT_EQ(square, FaceLeftOf(dcel, Point(3, 1), Point(3, 3)));
+  EXPECT_EQ(square, FaceLeftOf(dcel, Point(3, 3.75), Point(3.5, 3.5)));
+  EXPECT_EQ(3, dcel.inner_components(square).size());
+  EXPECT_EQ(0, FaceLeftOf(dcel, Point(6, 0), Point(5, 0)));
+  EXPECT_EQ(0, FaceLeftOf(dcel, Point(5.5, 2), Point(6, 3)));
+  EXPECT_EQ(3, dcel.inner_components(0).size());
+}
+
+TEST(DcelTest, HoleAboveNearlyParallelEdges) {
+  vector<Segment> segments = Square(-10, -10, 10, 10);
+  // A sliver between two edges so close that, at x = 4.5, the height of the
+  // upper one rounds below that of the lower one.
+  Point sliver[] = {{0, 0}, {5, 3}, {6, 3.6}, {1, 0.6000000000000002}};
+  for (int i = 0; i < 4; ++i) {
+    segments.push_back(Segment(sliver[i], sliver[(i + 1) % 4]));
+  }
+  ASSERT_EQ(1, Orientation(sliver[0], sliver[1], sliver[3]));
+  // A triangle right above, whose smallest vertex is at x = 4.5.
+  segments.push_back(Segment(Point(4.5, 5), Point(5.5, 5)));
+  segments.push_back(Segment(Point(5.5, 5), Point(4.5, 6)));
+  segments.push_back(Segment(Point(4.5, 6), Point(4.5, 5)));
+
+  Dcel dcel = Dcel::FromSegments(segments);
+  ExpectValid(dcel);
+  ExpectHolesPlaced(dcel);
+  uint32_t square = FaceLeftOf(dcel, Point(-10, -10), Point(10, -10));
+  EXPECT_EQ(square, FaceLeftOf(dcel, Point(5.5, 5), Point(4.5, 5)));
+}
+
+TEST(DcelTest, RandomSubdivision) {
+  for (int n : {1, 10, 400}) {
+    for (unsigned seed : {1, 2, 3}) {
+      SCOPED_TRACE(n);
+      SCOPED_TRACE(seed);
+      vector<Segment> segments = RandomSubdivision(n, seed);
+      Dcel dcel = Dcel::FromSegments(segments);
+      ExpectValid(dcel);
+      ExpectHolesPlaced(dcel);
+      EXPECT_EQ(segments.size(), dcel.num_edges());
+    }
+  }
+}
+
+TEST(DcelTest, SparseLattice) {
+  for (unsigned seed : {1, 2, 3, 4}) {
+    SCOPED_TRACE(seed);
+    Dcel dcel = Dcel::FromSegments(SparseLattice(12, seed));
+    ExpectValid(dcel);
+    ExpectHolesPlaced(dcel);
+  }
+}
+
+TEST(MapOverlayTest, CrossingSquares) {
+  Dcel red = Dcel::FromSegments(Square(0, 0, 2, 2));
+  Dcel blue = Dcel::FromSegments(Square(1, 1, 3, 3));
+  vector<OverlayLabel> labels;
+  Dcel overlay = MapOverlay(red, blue, &labels);
+  ExpectValid(overlay);
+  EXPECT_EQ(10, overlay.num_vertices());
+  EXPECT_EQ(12, overlay.num_edges());
+  ASSERT_EQ(4, overlay.num_faces());
+  ASSERT_EQ(4, labels.size());
+  uint32_t both = FaceLeftOf(overlay, Point(1, 2), Point(1, 1));
+  uint32_t red_only = FaceLeftOf(overlay, Point(0, 0), Point(2, 0));
+  uint32_t blue_only = FaceLeftOf(overlay, Point(3, 3), Point(1, 3));
+  EXPECT_EQ(1, labels[both].red_face);
+  EXPECT_EQ(1, labels[both].blue_face);
+  EXPECT_EQ(1, labels[red_only].red_face);
+  EXPECT_EQ(0, labels[red_only].blue_face);
+  EXPECT_EQ(0, labels[blue_only].red_face);
+  EXPECT_EQ(1, labels[blue_only].blue_face);
+  EXPECT_EQ(0, labels[0].red_face);
+  EXPECT_EQ(0, labels[0].blue_face);
+}
+
+TEST(MapOverlayTest, SharedEdges) {
+  // The blue square covers the left half of the red one, so their edges
+  // overlap along three sides, one of them vertical.
+  Dcel red = Dcel::FromSegments(Square(0, 0, 2, 2));
+  Dcel blue = Dcel::FromSegments(Square(0, 0, 1, 2));
+  vector<OverlayLabel> labels;
+  Dcel overlay = MapOverlay(red, blue, &labels);
+  ExpectValid(overlay);
+  EXPECT_EQ(6, overlay.num_vertices());
+  EXPECT_EQ(7, overlay.num_edges());
+  ASSERT_EQ(3, overlay.num_faces());
+  uint32_t left = FaceLeftOf(overlay, Point(0, 0), Point(1, 0));
+  uint32_t right = FaceLeftOf(overlay, Point(1, 0), Point(2, 0));
+  EXPECT_EQ(1, labels[left].red_face);
+  EXPECT_EQ(1, labels[left].blue_face);
+  EXPECT_EQ(1, labels[right].red_face);
+  EXPECT_EQ(0, labels[right].blue_face);
+
+  // An island of blue in the middle of a red face gets its red label from
+  // the face around it.
+  blue = Dcel::FromSegments(Square(0.5, 0.5, 1.5, 1.5));
+  overlay = MapOverlay(red, blue, &labels);
+  ExpectValid(overlay);
+  ASSERT_EQ(3, overlay.num_faces());
+  uint32_t island = FaceLeftOf(overlay, Point(0.5, 0.5), Point(1.5, 0.5));
+  EXPECT_EQ(1, labels[island].red_face);
+  EXPECT_EQ(1, labels[island].blue_face);
+}
+
+TEST(MapOverlayTest, WithItselfOrNothing) {
+  Dcel dcel = Dcel::FromSegments(RandomSubdivision(100, 4));
+  vector<double> areas = FaceAreas(dcel);
+  vector<OverlayLabel> labels;
+  for (const Dcel& other : {dcel, Dcel()}) {
+    Dcel overlay = MapOverlay(dcel, other, &labels);
+    ExpectValid(overlay);
+    EXPECT_EQ(dcel.num_vertices(), overlay.num_vertices());
+    EXPECT_EQ(dcel.num_edges(), overlay.num_edges());
+    ASSERT_EQ(dcel.num_faces(), overlay.num_faces());
+    vector<double> overlay_areas = FaceAreas(overlay);
+    for (uint32_t f = 1; f < overlay.num_faces(); ++f) {
+      EXPECT_DOUBLE_EQ(areas[labels[f].red_face], overlay_areas[f]);
+      EXPECT_EQ(other.num_faces() == 1 ? 0 : labels[f].red_face,
+                labels[f].blue_face);
+    }
+  }
+}
+
+TEST(MapOverlayTest, RandomSubdivisions) {
+  for (unsigned seed : {1, 2, 3}) {
+    SCOPED_TRACE(seed);
+    Dcel red = Dcel::FromSegments(RandomSubdivision(400, seed));
+    Dcel blue = Dcel::FromSegments(RandomSubdivision(150, seed + 10));
+    vector<OverlayLabel> labels;
+    Dcel overlay = MapOverlay(red, blue, &labels);
+    ExpectValid(overlay);
+    ExpectHolesPlaced(overlay);
+    EXPECT_LT(red.num_edges() + blue.num_edges(), overlay.num_edges());
+    ASSERT_EQ(overlay.num_faces(), labels.size());
+
+    // The faces of the overlay with a label cover that face of the input.
+    vector<double> overlay_areas = FaceAreas(overlay);
+    vector<double> red_areas = FaceAreas(red), blue_areas = FaceAreas(blue);
+    vector<double> red_covered(red.num_faces(), 0);
+    vector<double> blue_covered(blue.num_faces(), 0);
+    for (uint32_t f = 1; f < overlay.num_faces(); ++f) {
+      ASSERT_LT(labels[f].red_face, red.num_faces());
+      ASSERT_LT(labels[f].blue_face, blue.num_faces());
+      red_covered[labels[f].red_face] += overlay_areas[f];
+      blue_covered[labels[f].blue_face] += overlay_areas[f];
+    }
+    for (uint32_t f = 1; f < red.num_faces(); ++f) {
+      EXPECT_NEAR(red_areas[f], red_covered[f], 1e-12) << f;
+    }
+    for (uint32_t f = 1; f < blue.num_faces(); ++f) {
+      EXPECT_NEAR(blue_areas[f], blue_covered[f], 1e-12) << f;
+    }
+  }
+}
@@ -0,0 +1,379 @@
+#include "chapter2/grid-intersection.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <utility>
+#include "base/parallel.h"
+#include "base/predicates.h"
+
+using std::map;
+using std::numeric_limits;
+using std::vector;
+
+namespace grid_intersection_internal {
+
+Grid::Grid(Span<const Segment> segments,
+           const GridIntersectionOptions& options)
+    : min_x_(numeric_limits<double>::infinity()),
+      min_y_(numeric_limits<double>::infinity()) {
+  double max_x = -numeric_limits<double>::infinity();
+  double max_y = -numeric_limits<double>::infinity();
+  double total_extent = 0;
+  for (const Segment& s : segments) {
+    double low_y = std::min(s.endpoint(0).y, s.endpoint(1).y);
+    double high_y = std::max(s.endpoint(0).y, s.endpoint(1).y);
+    min_x_ = std::min(min_x_, s.endpoint(0).x);
+    max_x = std::max(max_x, s.endpoint(1).x);
+    min_y_ = std::min(min_y_, low_y);
+    max_y = std::max(max_y, high_y);
+    total_extent += std::max(s.endpoint(1).x - s.endpoint(0).x,
+                             high_y - low_y);
+  }
+  if (segments.empty()) {
+    min_x_ = min_y_ = max_x = max_y = 0;
+  }
+  double width = max_x - min_x_;
+  double height = max_y - min_y_;
+
+  cell_size_ = options.cell_size;
+  if (!(cell_size_ > 0) && !segments.empty()) {
+    cell_size_ = total_extent / segments.size();
+  }
+  if (!(cell_size_ > 0)) {
+    cell_size_ = std::max(width, height);
+  }
+  if (!(cell_size_ > 0)) {
+    cell_size_ = 1;
+  }
+  double max_cells = kMaxCellsPerSegment * std::max<double>(segments.size(), 1);
+  auto cells_across = [&](double extent) {
+    return std::max(1.0, std::ceil(extent / cell_size_));
+  };
+  while (cells_across(width) * cells_across(height) > max_cells) {
+    cell_size_ *= 2;
+  }
+  num_columns_ = static_cast<int>(cells_across(width));
+  num_rows_ = static_cast<int>(cells_across(height));
+}
+
+int Grid::Column(double x) const {
+  double column = std::floor((x - min_x_) / cell_size_);
+  if (!(column > 0)) {
+    return 0;
+  }
+  return column < num_columns_ ? static_cast<int>(column) : num_columns_ - 1;
+}
+
+int Grid::Row(double y) const {
+  double row = std::floor((y - min_y_) / cell_size_);
+  if (!(row > 0)) {
+    return 0;
+  }
+  return row < num_rows_ ? static_cast<int>(row) : num_rows_ - 1;
+}
+
+}  // namespace grid_intersection_internal
+
+using grid_intersection_internal::Grid;
+
+namespace {
+
+// Cells handed to a thread at a time.
+const int kCellsPerTask = 256;
+
+// Below this many segments the sweep is fast enough that the grid does not
+// pay for itself.
+const size_t kMinGridSegments = 1 << 10;
+
+// The grid is chosen when the number of cells overlapped plus the number of
+// pairs sharing a cell is below this times (n + k) log n, for k
+// intersections. Testing a pair is much cheaper than handling an event.
+const double kGridWorkPerSweepWork = 8;
+
+// Pairs sharing a cell sampled to estimate k.
+const int kSampledPairs = 1024;
+
+struct Box {
+  double min_x;
+  double min_y;
+  double max_x;
+  double max_y;
+
+  explicit Box(const Segment& s)
+      : min_x(s.endpoint(0).x),
+        min_y(std::min(s.endpoint(0).y, s.endpoint(1).y)),
+        max_x(s.endpoint(1).x),
+        max_y(std::max(s.endpoint(0).y, s.endpoint(1).y)) {}
+};
+
+bool Overlap(const Box& a, const Box& b) {
+  return a.min_x <= b.max_x && b.min_x <= a.max_x
+      && a.min_y <= b.max_y && b.min_y <= a.max_y;
+}
+
+// Two segments meeting at a point.
+struct Hit {
+  Point point;
+  int first;
+  int second;
+};
+
+// Whether p lies in the closed segment s, given that it lies on its line.
+bool WithinCollinear(Point p, const Segment& s) {
+  return !LexicographicLess(p, s.endpoint(0))
+      && !LexicographicLess(s.endpoint(1), p);
+}
+
+// Adds the points where segments i and j meet: the one common point of
+// segments that are not collinear, and otherwise the endpoints of either
+// lying in the other.
+void AddHits(const vector<Segment>& segments, int i, int j,
+             vector<Hit>* hits) {
+  const Segment& a = segments[i];
+  const Segment& b = segments[j];
+  Point p;
+  if (a.IntersectsSegment(b, &p)) {
+    hits->push_back({p, i, j});
+    return;
+  }
+  Point a0 = a.endpoint(0), a1 = a.endpoint(1);
+  Point b0 = b.endpoint(0), b1 = b.endpoint(1);
+  if (Orientation(a0, a1, b0) != 0 || Orientation(a0, a1, b1) != 0
+      || Orientation(b0, b1, a0) != 0 || Orientation(b0, b1, a1) != 0) {
+    return;
+  }
+  for (Point q : {b0, b1}) {
+    if (WithinCollinear(q, a)) {
+      hits->push_back({q, i, j});
+    }
+  }
+  for (Point q : {a0, a1}) {
+    if (q != b0 && q != b1 && WithinCollinear(q, b)) {
+      hits->push_back({q, i, j});
+    }
+  }
+}
+
+// The segments in each cell of the grid, in increasing order, stored one
+// cell after the other: the segments of cell c are
+// segments[begin[c]], ..., segments[begin[c + 1] - 1].
+struct Buckets {
+  vector<int> begin;
+  vector<int> segments;
+};
+
+void FillBuckets(const vector<Box>& boxes,
+                 const Grid& grid,
+                 Buckets* buckets) {
+  buckets->begin.assign(grid.num_cells() + 1, 0);
+  for (const Box& box : boxes) {
+    for (int row = grid.Row(box.min_y); row <= grid.Row(box.max_y); ++row) {
+      for (int column = grid.Column(box.min_x);
+           column <= grid.Column(box.max_x);
+           ++column) {
+        ++buckets->begin[row * grid.num_columns() + column + 1];
+      }
+    }
+  }
+  for (int cell = 0; cell < grid.num_cells(); ++cell) {
+    buckets->begin[cell + 1] += buckets->begin[cell];
+  }
+  buckets->segments.resize(buckets->begin.back());
+  vector<int> next(buckets->begin.begin(), buckets->begin.end() - 1);
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    const Box& box = boxes[i];
+    for (int row = grid.Row(box.min_y); row <= grid.Row(box.max_y); ++row) {
+      for (int column = grid.Column(box.min_x);
+           column <= grid.Column(box.max_x);
+           ++column) {
+        buckets->segments[next[row * grid.num_columns() + column]++] = i;
+      }
+    }
+  }
+}
+
+// Tests the pairs of segments in one cell. A pair whose boxes overlap is
+// tested only in the cell holding the lower left corner of the overlap,
+// which both boxes cover.
+void TestCell(const vector<Segment>& segments,
+              const vector<Box>& boxes,
+              const Grid& grid,
+              const Buckets& buckets,
+              int cell,
+              vector<Hit>* hits) {
+  int column = cell % grid.num_columns();
+  int row = cell / grid.num_columns();
+  const int* begin = buckets.segments.data() + buckets.begin[cell];
+  const int* end = buckets.segments.data() + buckets.begin[cell + 1];
+  for (const int* i = begin; i != end; ++i) {
+    const Box& a = boxes[*i];
+    for (const int* j = i + 1; j != end; ++j) {
+      const Box& b = boxes[*j];
+      if (Overlap(a, b)
+          && grid.Column(std::max(a.min_x, b.min_x)) == column
+          && grid.Row(std::max(a.min_y, b.min_y)) == row) {
+        AddHits(segments, *i, *j, hits);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+bool GridFindIntersections(const vector<Segment>& segments,
+                           const GridIntersectionOptions& options,
+                           const IntersectionVisitor& visitor) {
+  Grid grid(segments, options);
+  vector<Box> boxes;
+  boxes.reserve(segments.size());
+  for (const Segment& s : segments) {
+    boxes.emplace_back(s);
+  }
+  Buckets buckets;
+  FillBuckets(boxes, grid, &buckets);
+
+  int num_tasks = (grid.num_cells() + kCellsPerTask - 1) / kCellsPerTask;
+  int num_threads = ClampNumThreads(options.num_threads, num_tasks, 1);
+  vector<vector<Hit>> thread_hits(num_threads);
+  std::atomic<int> next_task(0);
+  RunInParallel(num_threads, [&](int thread) {
+    for (int task = next_task++; task < num_tasks; task = next_task++) {
+      int end = std::min(grid.num_cells(), (task + 1) * kCellsPerTask);
+      for (int cell = task * kCellsPerTask; cell < end; ++cell) {
+        TestCell(segments, boxes, grid, buckets, cell, &thread_hits[thread]);
+      }
+    }
+  });
+
+  vector<Hit> hits;
+  for (const vector<Hit>& h : thread_hits) {
+    hits.insert(hits.end(), h.begin(), h.end());
+  }
+  std::sort(hits.begin(), hits.end(), [](const Hit& lhs, const Hit& rhs) {
+    return LexicographicLess(lhs.point, rhs.point);
+  });
+
+  Intersection intersection;
+  vector<int> meeting;
+  for (auto group = hits.begin(); group != hits.end();) {
+    auto group_end = group;
+    meeting.clear();
+    for (; group_end != hits.end() && group_end->point == group->point;
+         ++group_end) {
+      meeting.push_back(group_end->first);
+      meeting.push_back(group_end->second);
+    }
+    std::sort(meeting.begin(), meeting.end());
+    meeting.erase(std::unique(meeting.begin(), meeting.end()), meeting.end());
+    intersection.point = group->point;
+    intersection.starting.clear();
+    intersection.ending.clear();
+    intersection.containing.clear();
+    for (int i : meeting) {
+      if (segments[i].endpoint(0) == intersection.point) {
+        intersection.starting.push_back(i);
+      } else if (segments[i].endpoint(1) == intersection.point) {
+        intersection.ending.push_back(i);
+      } else {
+        intersection.containing.push_back(i);
+      }
+    }
+    if (!visitor(intersection)) {
+      return false;
+    }
+    group = group_end;
+  }
+  return true;
+}
+
+map<Point, vector<Segment>> GridFindIntersections(
+    const vector<Segment>& segments, const GridIntersectionOptions& options) {
+  map<Point, vector<Segment>> intersections;
+  GridFindIntersections(segments, options,
+                        [&](const Intersection& intersection) {
+    vector<Segment>& meeting = intersections[intersection.point];
+    for (const vector<int>* indices : {&intersection.starting,
+                                       &intersection.ending,
+                                       &intersection.containing}) {
+      for (int i : *indices) {
+        meeting.push_back(segments[i]);
+      }
+    }
+    return true;
+  });
+  return intersections;
+}
+
+IntersectionEngine ChooseIntersectionEngine(const vector<Segment>& segments) {
+  const size_t n = segments.size();
+  if (n < kMinGridSegments) {
+    return SWEEP_ENGINE;
+  }
+  // The grid overlaps the boxes with the cells and tests the pairs sharing a
+  // cell. The sweep handles n + k events for k intersections in O(log n) time
+  // each. Most of the pairs sharing a cell intersect when k is large, so k is
+  // estimated from a sample of them.
+  const double log_n = std::log2(n);
+  Grid grid(segments, GridIntersectionOptions());
+  vector<Box> boxes;
+  boxes.reserve(n);
+  double overlapped = 0;
+  for (const Segment& s : segments) {
+    boxes.emplace_back(s);
+    const Box& box = boxes.back();
+    overlapped += double(grid.Row(box.max_y) - grid.Row(box.min_y) + 1)
+        * (grid.Column(box.max_x) - grid.Column(box.min_x) + 1);
+  }
+  // Filling that many cells would cost more than the sweep does at best.
+  if (overlapped > kGridWorkPerSweepWork * n * log_n) {
+    return SWEEP_ENGINE;
+  }
+  Buckets buckets;
+  FillBuckets(boxes, grid, &buckets);
+  // pairs_before[c] is the number of pairs sharing the cells before c.
+  vector<double> pairs_before(grid.num_cells() + 1, 0);
+  for (int cell = 0; cell < grid.num_cells(); ++cell) {
+    double size = buckets.begin[cell + 1] - buckets.begin[cell];
+    pairs_before[cell + 1] = pairs_before[cell] + size * (size - 1) / 2;
+  }
+  const double pairs = pairs_before.back();
+  if (overlapped + pairs <= kGridWorkPerSweepWork * n * log_n) {
+    return GRID_ENGINE;
+  }
+  std::mt19937 gen(n);
+  std::uniform_real_distribution<double> pair_dist(0, pairs);
+  int num_meeting = 0;
+  for (int i = 0; i < kSampledPairs; ++i) {
+    int cell = std::upper_bound(pairs_before.begin(), pairs_before.end(),
+                                pair_dist(gen)) - pairs_before.begin() - 1;
+    cell = std::min(cell, grid.num_cells() - 1);
+    const int* members = buckets.segments.data() + buckets.begin[cell];
+    int size = buckets.begin[cell + 1] - buckets.begin[cell];
+    if (size < 2) {
+      continue;
+    }
+    int a = std::uniform_int_distribution<int>(0, size - 1)(gen);
+    int b = std::uniform_int_distribution<int>(0, size - 2)(gen);
+    b += b >= a;
+    Point p;
+    num_meeting += segments[members[a]].IntersectsSegment(segments[members[b]],
+                                                          &p);
+  }
+  double estimated_k = pairs * num_meeting / kSampledPairs;
+  return overlapped + pairs
+      <= kGridWorkPerSweepWork * (n + estimated_k) * log_n
+      ? GRID_ENGINE : SWEEP_ENGINE;
+}
+
+map<Point, vector<Segment>> AutoFindIntersections(
+    const vector<Segment>& segments, int num_threads) {
+  if (ChooseIntersectionEngine(segments) == GRID_ENGINE) {
+    GridIntersectionOptions options;
+    options.num_threads = num_threads;
+    return GridFindIntersections(segments, options);
+  }
+  return ParallelFindIntersections(segments, num_threads);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include "base/base.h"
+#include "base/span.h"
+#include "chapter2/segment-intersection.h"
+
+struct GridIntersectionOptions {
+  // The side of the square grid cells. Zero picks it from the segments: the
+  // mean extent of their bounding boxes, grown until there are at most a few
+  // cells per segment.
+  double cell_size;
+  // The cells are shared out among this many threads.
+  int num_threads;
+
+  GridIntersectionOptions() : cell_size(0), num_threads(1) {}
+};
+
+// The intersections found by FindIntersections, found instead by bucketing
+// the segments into the cells of a uniform grid that their bounding boxes
+// overlap, and testing exactly every pair sharing a cell. Each pair is tested
+// in one cell only. When the segments are short and evenly spread, each cell
+// holds O(1) segments and this takes linear time; long segments fall into
+// many cells and crowded cells cost quadratic time.
+//
+// Where three or more segments cross at one interior point, the point is
+// computed once per pair and the rounded results can differ in their last
+// bits, so the point may be reported more than once; the sweep reports it
+// once. Shared endpoints and endpoints lying on other segments are exact.
+//
+// Intersections are reported in lexicographic order, with the indices of each
+// list in increasing order. Returns false if the visitor stopped.
+bool GridFindIntersections(const std::vector<Segment>& segments,
+                           const GridIntersectionOptions& options,
+                           const IntersectionVisitor& visitor);
+std::map<Point, std::vector<Segment>> GridFindIntersections(
+    const std::vector<Segment>& segments,
+    const GridIntersectionOptions& options = GridIntersectionOptions());
+
+enum IntersectionEngine {
+  SWEEP_ENGINE,
+  GRID_ENGINE,
+};
+
+// Guesses which engine is faster for the segments in about linear time. With
+// the automatic cell size, the work of the grid is the number of cells the
+// bounding boxes overlap plus the number of pairs sharing a cell; the number
+// of intersections, which drives the work of the sweep, is estimated from a
+// sample of those pairs. The sweep wins when many segments share cells
+// without crossing, such as long parallel segments.
+IntersectionEngine ChooseIntersectionEngine(
+    const std::vector<Segment>& segments);
+
+// FindIntersections with the engine chosen by ChooseIntersectionEngine, using
+// up to num_threads threads.
+std::map<Point, std::vector<Segment>> AutoFindIntersections(
+    const std::vector<Segment>& segments, int num_threads = 1);
+
+namespace grid_intersection_internal {
+
+// Bounds the memory of the grid, which is mostly empty cells when a few
+// segments are far from the rest.
+const int kMaxCellsPerSegment = 4;
+
+// A uniform grid of square cells covering a bounding box. Coordinates outside
+// the box are clamped to the border cells.
+class Grid {
+ public:
+  // Uses options.cell_size, or chooses one if it is zero, then grows it until
+  // there are at most kMaxCellsPerSegment cells per segment.
+  Grid(Span<const Segment> segments, const GridIntersectionOptions& options);
+
+  double cell_size() const { return cell_size_; }
+  int num_columns() const { return num_columns_; }
+  int num_rows() const { return num_rows_; }
+  int num_cells() const { return num_columns_ * num_rows_; }
+
+  int Column(double x) const;
+  int Row(double y) const;
+
+ private:
+  double min_x_;
+  double min_y_;
+  double cell_size_;
+  int num_columns_;
+  int num_rows_;
+};
+
+}  // namespace grid_intersection_internal
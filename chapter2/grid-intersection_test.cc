@@ -0,0 +1,151 @@
+#include "chapter2/grid-intersection.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <map>
+#include "base/workload.h"
+#include "gtest/gtest.h"
+
+using std::map;
+using std::vector;
+
+namespace grid_intersection_internal {
+
+// Whether both have the same points, up to rounding, with the same segments.
+bool SameIntersections(const map<Point, vector<Segment>>& lhs,
+                       const map<Point, vector<Segment>>& rhs) {
+  auto endpoints = [](const vector<Segment>& segments) {
+    vector<std::array<Point, 2>> result;
+    for (const Segment& s : segments) {
+      result.push_back(s.endpoints());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  };
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (const auto& l : lhs) {
+    bool found = false;
+    for (auto r = rhs.lower_bound(
+             Point(l.first.x - 1e-9, -std::numeric_limits<double>::infinity()));
+         r != rhs.end() && r->first.x < l.first.x + 1e-9 && !found;
+         ++r) {
+      found = Near(l.first, r->first)
+          && endpoints(l.second) == endpoints(r->second);
+    }
+    if (!found) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(GridTest, CellSize) {
+  vector<Segment> segments = {
+    Segment(Point(0, 0), Point(0.75, 0.5)),
+    Segment(Point(2, 2), Point(2.5, 2.75)),
+    Segment(Point(3, 0), Point(3.75, 0.75)),
+    Segment(Point(3.25, 4), Point(4, 4)),
+  };
+  // The mean extent is 0.75, which would make 6 x 6 cells.
+  Grid grid(segments, GridIntersectionOptions());
+  EXPECT_EQ(1.5, grid.cell_size());
+  EXPECT_EQ(3, grid.num_columns());
+  EXPECT_EQ(3, grid.num_rows());
+  EXPECT_EQ(0, grid.Column(-1));
+  EXPECT_EQ(0, grid.Column(1.4));
+  EXPECT_EQ(1, grid.Column(1.5));
+  EXPECT_EQ(2, grid.Column(4));
+  EXPECT_EQ(2, grid.Row(10));
+
+  GridIntersectionOptions options;
+  options.cell_size = 4;
+  Grid coarse(segments, options);
+  EXPECT_EQ(4, coarse.cell_size());
+  EXPECT_EQ(1, coarse.num_cells());
+
+  vector<Segment> none;
+  Grid empty(none, GridIntersectionOptions());
+  EXPECT_EQ(1, empty.num_cells());
+}
+
+TEST(GridFindIntersectionsTest, Simple) {
+  vector<Segment> segments = {
+    // A crossing.
+    Segment(Point(0, 0), Point(2, 2)),
+    Segment(Point(0, 2), Point(2, 0)),
+    // An endpoint in the interior of the first segment.
+    Segment(Point(1.5, 1.5), Point(3, 0)),
+    // A shared endpoint.
+    Segment(Point(3, 0), Point(4, 1)),
+    // Collinear overlapping segments.
+    Segment(Point(5, 0), Point(7, 0)),
+    Segment(Point(6, 0), Point(8, 0)),
+    // Far from the others.
+    Segment(Point(10, 10), Point(11, 10)),
+  };
+  for (double cell_size : {0.0, 0.25, 1.0, 100.0}) {
+    GridIntersectionOptions options;
+    options.cell_size = cell_size;
+    auto intersections = GridFindIntersections(segments, options);
+    ASSERT_EQ(5, intersections.size()) << cell_size;
+    EXPECT_EQ(2, intersections[Point(1, 1)].size());
+    EXPECT_EQ(2, intersections[Point(1.5, 1.5)].size());
+    EXPECT_EQ(2, intersections[Point(3, 0)].size());
+    EXPECT_EQ(2, intersections[Point(6, 0)].size());
+    EXPECT_EQ(2, intersections[Point(7, 0)].size());
+    EXPECT_TRUE(SameIntersections(FindIntersections(segments),
+                                  intersections));
+  }
+
+  vector<Intersection> found;
+  GridFindIntersections(segments, GridIntersectionOptions(),
+                        [&](const Intersection& intersection) {
+    found.push_back(intersection);
+    return found.size() < 2;
+  });
+  ASSERT_EQ(2, found.size());
+  EXPECT_EQ(Point(1, 1), found[0].point);
+  EXPECT_EQ(vector<int>({0, 1}), found[0].containing);
+  EXPECT_EQ(Point(1.5, 1.5), found[1].point);
+  EXPECT_EQ(vector<int>({2}), found[1].starting);
+  EXPECT_EQ(vector<int>({0}), found[1].containing);
+}
+
+TEST(GridFindIntersectionsTest, SameAsFindIntersections) {
+  const int kSizes[] = {20000, 1000, 4000};
+  for (auto distribution : {SHORT_SEGMENTS, LONG_SEGMENTS,
+                            AXIS_PARALLEL_SEGMENTS}) {
+    vector<Segment> segments =
+        RandomSegments(distribution, kSizes[distribution], 2);
+    auto expected = FindIntersections(segments);
+    for (int num_threads : {1, 3}) {
+      GridIntersectionOptions options;
+      options.num_threads = num_threads;
+      EXPECT_TRUE(SameIntersections(expected,
+                                    GridFindIntersections(segments, options)))
+          << SegmentDistributionName(distribution) << " " << num_threads;
+    }
+  }
+}
+
+TEST(ChooseIntersectionEngineTest, Workloads) {
+  EXPECT_EQ(SWEEP_ENGINE, ChooseIntersectionEngine(
+      RandomSegments(SHORT_SEGMENTS, 100, 1)));
+  EXPECT_EQ(GRID_ENGINE, ChooseIntersectionEngine(
+      RandomSegments(SHORT_SEGMENTS, 1 << 16, 1)));
+  // Most pairs sharing a cell cross, and the sweep has as many events.
+  EXPECT_EQ(GRID_ENGINE, ChooseIntersectionEngine(
+      RandomSegments(LONG_SEGMENTS, 1 << 12, 1)));
+
+  // Long segments that do not cross share every cell.
+  vector<Segment> stripes;
+  for (Point p : RandomPoints(UNIFORM_SQUARE, 1 << 12, 1)) {
+    stripes.push_back(Segment(Point(0, p.y), Point(1, p.y + 0.01)));
+  }
+  EXPECT_EQ(SWEEP_ENGINE, ChooseIntersectionEngine(stripes));
+}
+
+}  // namespace grid_intersection_internal
@@ -1,131 +1,270 @@
 #include "chapter2/segment-intersection.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <iterator>
+#include <functional>
 #include <limits>
-#include "base/stl-utils.h"
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include "base/arena.h"
+#include "base/parallel.h"
+#include "base/predicates.h"
+#include "base/radix-sort.h"
+#include "base/stats.h"
 
 using std::make_pair;
 using std::map;
 using std::numeric_limits;
+using std::pair;
+using std::string;
 using std::vector;
 
 namespace segment_intersection_internal {
 
-const double kEpsilon = 0.00000001;
+// Relative to the magnitude of the event point coordinates, but never less
+// than this in absolute terms.
+const double kEpsilon = 0.00000000000001;
+
+PreparedSegment::PreparedSegment(const Segment& segment)
+    : segment_(&segment),
+      left_x_(segment.endpoint(0).x),
+      left_y_(segment.endpoint(0).y),
+      slope_(0),
+      is_vertical_(segment.is_vertical()),
+      is_horizontal_(segment.is_horizontal()) {
+  if (!is_vertical_ && !is_horizontal_) {
+    slope_ = (segment.endpoint(1).y - segment.endpoint(0).y)
+        / (segment.endpoint(1).x - segment.endpoint(0).x);
+  }
+}
 
 struct Event {
   Point point;
-  vector<SegmentRef> starting_segments;
+  // The segments whose left endpoint is the event point.
+  const SegmentRef* starting_begin;
+  const SegmentRef* starting_end;
 };
 
+// Endpoint events are all known up front, so they are sorted once into an
+// array. Only intersection events found during the sweep go through a heap.
 class EventQueue {
  public:
-  Event* EventAtPoint(Point p) {
-    if (!ContainsKey(queue_impl_, p)) {
-      auto e = new Event;
-      e->point = p;
-      queue_impl_[p] = e;
-    }
-    return FindOrDie(queue_impl_, p);
-  };
-
-  Event* NextEvent() const {
-    return queue_impl_.begin()->second;
+  // Only endpoints with x in [x_begin, x_end) become events.
+  EventQueue(const vector<SegmentRef>& segments,
+             double x_begin,
+             double x_end,
+             Arena* arena);
+
+  // Schedules an event at an intersection point to the right of the current
+  // event. The same point may be added several times.
+  void AddIntersectionEvent(Point p) {
+    intersection_points_.push(p);
   }
 
-  void RemoveEvent(const Event* e) {
-    RemoveKey(&queue_impl_, e->point);
-  }
+  // Removes and returns the next event. The returned event stays valid until
+  // the next call.
+  const Event* PopNextEvent();
 
   bool empty() const {
-    return queue_impl_.empty();
+    return next_endpoint_event_ == num_endpoint_events_
+        && intersection_points_.empty();
   }
 
  private:
-  map<Point, Event*> queue_impl_;
+  struct Later {
+    bool operator()(Point lhs, Point rhs) const {
+      return LexicographicLess(rhs, lhs);
+    }
+  };
+
+  Event* endpoint_events_;
+  size_t num_endpoint_events_;
+  size_t next_endpoint_event_;
+  std::priority_queue<Point, vector<Point>, Later> intersection_points_;
+  Event intersection_event_;
 };
 
-class SegmentComparator {
- public:
-  enum SweepLineShift {
-    NONE,
-    BACKWARD,
-    FORWARD,
+EventQueue::EventQueue(const vector<SegmentRef>& segments,
+                       double x_begin,
+                       double x_end,
+                       Arena* arena)
+    : next_endpoint_event_(0) {
+  auto in_range = [x_begin, x_end](Point p) {
+    return x_begin <= p.x && p.x < x_end;
   };
+  // Right endpoints are recorded with a null segment.
+  vector<pair<Point, SegmentRef>> endpoints;
+  endpoints.reserve(2 * segments.size());
+  size_t num_starting = 0;
+  for (SegmentRef s : segments) {
+    if (in_range(s->endpoint(0))) {
+      endpoints.push_back(make_pair(s->endpoint(0), s));
+      ++num_starting;
+    }
+    if (in_range(s->endpoint(1))) {
+      endpoints.push_back(make_pair(s->endpoint(1), nullptr));
+    }
+  }
+  // Radix sort by x, then sort each run with the same x by y. Ties are broken
+  // by address so that starting segments are listed in input order.
+  vector<pair<Point, SegmentRef>> scratch(endpoints.size());
+  RadixSort(endpoints.data(), endpoints.size(), scratch.data(),
+            [](const pair<Point, SegmentRef>& e) {
+              return OrderedKey(e.first.x);
+            });
+  for (auto run = endpoints.begin(); run != endpoints.end();) {
+    auto run_end = run + 1;
+    while (run_end != endpoints.end() && run_end->first.x == run->first.x) {
+      ++run_end;
+    }
+    std::sort(run,
+              run_end,
+              [](const pair<Point, SegmentRef>& lhs,
+                 const pair<Point, SegmentRef>& rhs) {
+                if (lhs.first.y != rhs.first.y) {
+                  return lhs.first.y < rhs.first.y;
+                }
+                return std::less<SegmentRef>()(lhs.second, rhs.second);
+              });
+    run = run_end;
+  }
 
-  SegmentComparator(Point event_point, SweepLineShift shift)
-      : event_point_(event_point), shift_(shift) {}
+  num_endpoint_events_ = 0;
+  for (size_t i = 0; i < endpoints.size(); ++i) {
+    if (i == 0 || endpoints[i].first != endpoints[i - 1].first) {
+      ++num_endpoint_events_;
+    }
+  }
+  endpoint_events_ = arena->NewArray<Event>(num_endpoint_events_);
+  SegmentRef* starting = arena->NewArray<SegmentRef>(num_starting);
+  size_t num_events = 0;
+  for (size_t i = 0; i < endpoints.size(); ++i) {
+    if (i == 0 || endpoints[i].first != endpoints[i - 1].first) {
+      Event& e = endpoint_events_[num_events++];
+      e.point = endpoints[i].first;
+      e.starting_begin = starting;
+    }
+    if (endpoints[i].second) {
+      *starting++ = endpoints[i].second;
+    }
+    endpoint_events_[num_events - 1].starting_end = starting;
+  }
+}
 
-  bool operator()(SegmentRef lhs, SegmentRef rhs) {
-    if (lhs->is_vertical() && rhs->is_vertical()) {
-      // Both vertical.
-      return false;
+const Event* EventQueue::PopNextEvent() {
+  const Event* e;
+  if (next_endpoint_event_ < num_endpoint_events_
+      && (intersection_points_.empty()
+          || !LexicographicLess(intersection_points_.top(),
+                                endpoint_events_[next_endpoint_event_].point))) {
+    e = &endpoint_events_[next_endpoint_event_++];
+  } else {
+    intersection_event_.point = intersection_points_.top();
+    intersection_event_.starting_begin = nullptr;
+    intersection_event_.starting_end = nullptr;
+    e = &intersection_event_;
+  }
+  // Drop intersections found more than once or coinciding with an endpoint.
+  // New intersections always lie to the right of the current event, so no
+  // duplicate of this event can be added later.
+  while (!intersection_points_.empty()
+         && intersection_points_.top() == e->point) {
+    intersection_points_.pop();
+  }
+  return e;
+}
 
-    } else if (lhs->is_vertical()) {
-      double diff = event_point_.y - rhs->y_for_x(event_point_.x);
-      return diff < (shift_ == BACKWARD ? kEpsilon : -kEpsilon);
+SegmentComparator::SegmentComparator(Point event_point, SweepLineShift shift)
+    : event_point_(event_point),
+      shift_(shift),
+      tolerance_(kEpsilon * std::max(1.0, std::max(std::fabs(event_point.x),
+                                                   std::fabs(event_point.y)))) {}
 
-    } else if (rhs->is_vertical()) {
-      double diff = lhs->y_for_x(event_point_.x) - event_point_.y;
-      return diff < (shift_ == FORWARD ? kEpsilon : -kEpsilon);
+bool SegmentComparator::operator()(SegmentRef lhs, SegmentRef rhs) const {
+  if (lhs->is_vertical() && rhs->is_vertical()) {
+    // Both vertical.
+    return false;
 
-    } else {
-      // Neither vertical.
-      double diff = lhs->y_for_x(event_point_.x) - rhs->y_for_x(event_point_.x);
-      if (std::fabs(diff) > kEpsilon) {
+  } else if (lhs->is_vertical()) {
+    double diff = event_point_.y - rhs->y_for_x(event_point_.x);
+    double tolerance = tolerance_ * (1 + std::fabs(rhs->slope()));
+    return diff < (shift_ == BACKWARD ? tolerance : -tolerance);
+
+  } else if (rhs->is_vertical()) {
+    double diff = lhs->y_for_x(event_point_.x) - event_point_.y;
+    double tolerance = tolerance_ * (1 + std::fabs(lhs->slope()));
+    return diff < (shift_ == FORWARD ? tolerance : -tolerance);
+
+  } else {
+    // Neither vertical.
+    double diff = lhs->y_for_x(event_point_.x) - rhs->y_for_x(event_point_.x);
+    double tolerance =
+        tolerance_ * (1 + std::fabs(lhs->slope()) + std::fabs(rhs->slope()));
+    if (std::fabs(diff) > tolerance) {
+      return diff < 0;
+    } else if (shift_ != NONE) {
+      double shifted = event_point_.x + ((shift_ == FORWARD) ? 1 : -1);
+      diff = lhs->y_for_x(shifted) - rhs->y_for_x(shifted);
+      if (std::fabs(diff) > tolerance) {
         return diff < 0;
-      } else if (shift_ != NONE) {
-        double shifted = event_point_.x + ((shift_ == FORWARD) ? 1 : -1);
-        diff = lhs->y_for_x(shifted) - rhs->y_for_x(shifted);
-        if (std::fabs(diff) > kEpsilon) {
-          return diff < 0;
-        }
       }
-      return false;
     }
+    return false;
   }
+}
 
- private:
-  Point event_point_;
-  SweepLineShift shift_;
-};
+bool SweepLineStatus::Order::operator()(SegmentRef lhs, SegmentRef rhs) const {
+  GEOMETRY_STATS_ONLY(++status_->comparisons_;)
+  return SegmentComparator(status_->event_point_, status_->shift_)(lhs, rhs);
+}
+
+SweepLineStatus::SweepLineStatus()
+    : shift_(SegmentComparator::NONE), segments_(Order(this)),
+      comparisons_(0), misplaced_deletions_(0) {}
 
 void SweepLineStatus::set_event_point(Point p) {
   event_point_ = p;
 }
 
+Segment SweepLineStatus::HorizontalThroughEventPoint() const {
+  return Segment(Point(event_point_.x - 1, event_point_.y),
+                 Point(event_point_.x + 1, event_point_.y));
+}
+
 SegmentRef SweepLineStatus::SegmentAboveCurrentEventPoint() {
-  Segment horizontal(Point(event_point_.x - 1, event_point_.y),
-                     Point(event_point_.x + 1, event_point_.y));
+  const Segment probe = HorizontalThroughEventPoint();
+  const PreparedSegment horizontal(probe);
   return SegmentAboveSegment(&horizontal);
 }
 
 SegmentRef SweepLineStatus::SegmentBelowCurrentEventPoint() {
-  Segment horizontal(Point(event_point_.x - 1, event_point_.y),
-                     Point(event_point_.x + 1, event_point_.y));
+  const Segment probe = HorizontalThroughEventPoint();
+  const PreparedSegment horizontal(probe);
   return SegmentBelowSegment(&horizontal);
 }
 
 vector<SegmentRef> SweepLineStatus::SegmentsPassingCurrentEventPoint() {
-  Segment horizontal(Point(event_point_.x - 1, event_point_.y),
-                     Point(event_point_.x + 1, event_point_.y));
-  auto range = std::equal_range(segments_.begin(),
-                                segments_.end(),
-                                &horizontal,
-                                SegmentComparator(event_point_,
-                                                  SegmentComparator::NONE));
   vector<SegmentRef> matched_segments;
-  copy(range.first, range.second, std::back_inserter(matched_segments));
+  SegmentsPassingCurrentEventPoint(&matched_segments);
   return matched_segments;
 }
 
+void SweepLineStatus::SegmentsPassingCurrentEventPoint(
+    vector<SegmentRef>* matched_segments) {
+  const Segment probe = HorizontalThroughEventPoint();
+  const PreparedSegment horizontal(probe);
+  shift_ = SegmentComparator::NONE;
+  auto range = segments_.equal_range(&horizontal);
+  matched_segments->assign(range.first, range.second);
+}
+
 SegmentRef SweepLineStatus::SegmentAboveSegment(SegmentRef s) {
-  auto iter = std::upper_bound(segments_.begin(),
-                               segments_.end(),
-                               s,
-                               SegmentComparator(event_point_,
-                                                 SegmentComparator::FORWARD));
+  shift_ = SegmentComparator::FORWARD;
+  auto iter = segments_.upper_bound(s);
   if (iter != segments_.end()) {
     return *iter;
   } else {
@@ -134,96 +273,178 @@ SegmentRef SweepLineStatus::SegmentAboveSegment(SegmentRef s) {
 }
 
 SegmentRef SweepLineStatus::SegmentBelowSegment(SegmentRef s) {
-  auto iter = std::lower_bound(segments_.begin(),
-                               segments_.end(),
-                               s,
-                               SegmentComparator(event_point_,
-                                                 SegmentComparator::FORWARD));
+  shift_ = SegmentComparator::FORWARD;
+  auto iter = segments_.lower_bound(s);
   if (iter != segments_.begin()) {
-    return *(iter - 1);
+    return *std::prev(iter);
   } else {
     return nullptr;
   }
 }
 
 void SweepLineStatus::DeleteSegment(SegmentRef s) {
-  auto iter = std::lower_bound(segments_.begin(),
-                               segments_.end(),
-                               s,
-                               SegmentComparator(event_point_,
-                                                 SegmentComparator::BACKWARD));
+  shift_ = SegmentComparator::BACKWARD;
+  auto iter = segments_.lower_bound(s);
+  // Overlapping segments compare equal; find s itself among them.
+  while (iter != segments_.end()
+         && *iter != s
+         && !segments_.key_comp()(s, *iter)) {
+    ++iter;
+  }
+  if (iter == segments_.end() || *iter != s) {
+    // Rounding errors can leave s slightly out of place.
+    ++misplaced_deletions_;
+    iter = std::find(segments_.begin(), segments_.end(), s);
+  }
   assert(iter != segments_.end());
   segments_.erase(iter);
 }
 
 void SweepLineStatus::InsertSegment(SegmentRef s) {
-  auto iter = std::upper_bound(segments_.begin(),
-                               segments_.end(),
-                               s,
-                               SegmentComparator(event_point_,
-                                                 SegmentComparator::FORWARD));
-  segments_.insert(iter, s);
+  shift_ = SegmentComparator::FORWARD;
+  segments_.insert(s);
+}
+
+void SweepLineStatus::AssignSegmentsBefore(const vector<SegmentRef>& segments) {
+  assert(segments_.empty());
+  shift_ = SegmentComparator::BACKWARD;
+  for (SegmentRef s : segments) {
+    segments_.insert(segments_.end(), s);
+  }
 }
 
 class IntersectionFinder {
  public:
-  IntersectionFinder(const vector<Segment>& segments)
-      : segments_(segments) {}
-
-  map<Point, vector<Segment>> Find() {
-    for (const Segment& s : segments_) {
-      Point lower = s.endpoint(0);
-      Event* event = queue_.EventAtPoint(lower);
-      event->starting_segments.push_back(&s);
-      Point upper = s.endpoint(1);
-      queue_.EventAtPoint(upper);
-    }
+  // Sweeps the events of the swept segments with x in [x_begin, x_end),
+  // starting from the ones that cross the sweep line just before x_begin.
+  // Intersections are reported with indices into segments.
+  //
+  // Unless first_blue is null, the sweep is a red-blue one: the segments
+  // before first_blue are red and the others blue, segments of the same
+  // color must not cross or overlap, and only points where both colors meet
+  // are reported. Neighbors of the same color are never tested, so the only
+  // events are endpoints and red-blue intersections.
+  IntersectionFinder(const vector<PreparedSegment>& segments,
+                     const vector<SegmentRef>& swept,
+                     const IntersectionVisitor& visitor,
+                     double x_begin,
+                     double x_end,
+                     SegmentRef first_blue = nullptr)
+      : segments_(segments),
+        visitor_(visitor),
+        queue_(swept, x_begin, x_end, &arena_),
+        x_end_(x_end),
+        first_blue_(first_blue) {
+    StartAt(swept, x_begin);
+  }
 
+  bool Find() {
     while (!queue_.empty()) {
-      Event* event = queue_.NextEvent();
-      queue_.RemoveEvent(event);
-      HandleEvent(event);
+      const Event* e = queue_.PopNextEvent();
+      if (e->point.x >= x_end_) {
+        break;
+      }
+      GEOMETRY_STATS_ONLY(++stats_.events;)
+      if (!HandleEvent(*e)) {
+        return false;
+      }
     }
-    return intersections_;
+    return true;
+  }
+
+  // The counts of the sweep so far.
+  SweepStats stats() const {
+    SweepStats stats = stats_;
+    stats.comparisons = status_.comparisons();
+    stats.arena_bytes = arena_.bytes_allocated();
+    stats.misplaced_deletions = status_.misplaced_deletions();
+    return stats;
   }
 
  private:
-  const vector<Segment>& segments_;
-  map<Point, vector<Segment>> intersections_;
+  const vector<PreparedSegment>& segments_;
+  const IntersectionVisitor& visitor_;
+  // Owns the memory of all events, which is released in one shot when the
+  // finder is destroyed.
+  Arena arena_;
   EventQueue queue_;
+  double x_end_;
+  const SegmentRef first_blue_;
   SweepLineStatus status_;
+  // Scratch space reused by every event.
+  vector<SegmentRef> passing_;
+  vector<SegmentRef> R_;
+  vector<SegmentRef> C_;
+  vector<SegmentRef> LC_;
+  Intersection intersection_;
+  SweepStats stats_;
+
+  // Puts the segments crossing x = x_begin that start to the left of it into
+  // the status, and schedules the intersections of neighbors from x_begin on.
+  void StartAt(const vector<SegmentRef>& swept, double x_begin) {
+    vector<SegmentRef> crossing;
+    for (SegmentRef s : swept) {
+      if (s->endpoint(0).x < x_begin && x_begin <= s->endpoint(1).x) {
+        crossing.push_back(s);
+      }
+    }
+    if (crossing.empty()) {
+      return;
+    }
+    Point p(x_begin, crossing.front()->y_for_x(x_begin));
+    status_.set_event_point(p);
+    std::sort(crossing.begin(),
+              crossing.end(),
+              SegmentComparator(p, SegmentComparator::BACKWARD));
+    status_.AssignSegmentsBefore(crossing);
+    GEOMETRY_STATS_ONLY(stats_.max_status_size = status_.size();)
+    Point before(x_begin, -numeric_limits<double>::infinity());
+    for (size_t i = 1; i < crossing.size(); ++i) {
+      TestNeighbors(crossing[i - 1], crossing[i], before);
+    }
+  }
 
-  void HandleEvent(Event* e) {
-    Point p = e->point;
+  // Returns false if the visitor asked to stop.
+  bool HandleEvent(const Event& e) {
+    Point p = e.point;
     status_.set_event_point(p);
-    const vector<SegmentRef>& L = e->starting_segments;
-    vector<SegmentRef> R;
-    vector<SegmentRef> C;
-    for (auto s : status_.SegmentsPassingCurrentEventPoint()) {
+    const SegmentRef* L_begin = e.starting_begin;
+    const SegmentRef* L_end = e.starting_end;
+    vector<SegmentRef>& R = R_;
+    vector<SegmentRef>& C = C_;
+    R.clear();
+    C.clear();
+    status_.SegmentsPassingCurrentEventPoint(&passing_);
+    for (auto s : passing_) {
       if (s->endpoint(1) == p) {
         R.push_back(s);
       } else {
         C.push_back(s);
       }
     }
-    if (L.size() + R.size() + C.size() > 1) {
-      vector<Segment> all_segments;
-      for (auto s : L) { all_segments.push_back(*s); }
-      for (auto s : R) { all_segments.push_back(*s); }
-      for (auto s : C) { all_segments.push_back(*s); }
-      intersections_.insert(make_pair(p, all_segments));
+    if (ShouldReport(L_begin, L_end)) {
+      intersection_.point = p;
+      ToIndices(L_begin, L_end, &intersection_.starting);
+      ToIndices(R.data(), R.data() + R.size(), &intersection_.ending);
+      ToIndices(C.data(), C.data() + C.size(), &intersection_.containing);
+      GEOMETRY_STATS_ONLY(++stats_.intersections;)
+      if (!visitor_(intersection_)) {
+        return false;
+      }
     }
     for (auto s : R) { status_.DeleteSegment(s); }
     for (auto s : C) { status_.DeleteSegment(s); }
-    vector<SegmentRef> LC;
-    std::copy(L.begin(), L.end(), std::back_inserter(LC));
+    vector<SegmentRef>& LC = LC_;
+    LC.assign(L_begin, L_end);
     std::copy(C.begin(), C.end(), std::back_inserter(LC));
     for (auto s : LC) { status_.InsertSegment(s); }
+    GEOMETRY_STATS_ONLY(stats_.max_status_size =
+                            std::max(stats_.max_status_size, status_.size());)
     if (LC.empty()) {
       SegmentRef sb = status_.SegmentBelowCurrentEventPoint();
       SegmentRef sa = status_.SegmentAboveCurrentEventPoint();
       if (sa && sb) {
-        FindNewEvent(sb, sa, p);
+        TestNeighbors(sb, sa, p);
       }
     } else {
       std::sort(LC.begin(),
@@ -232,28 +453,470 @@ class IntersectionFinder {
       SegmentRef s1 = LC.front();
       SegmentRef sl = status_.SegmentBelowSegment(s1);
       if (sl) {
-        FindNewEvent(sl, s1, p);
+        TestNeighbors(sl, s1, p);
       }
       SegmentRef s2 = LC.back();
       SegmentRef sr = status_.SegmentAboveSegment(s2);
       if (sr) {
-        FindNewEvent(s2, sr, p);
+        TestNeighbors(s2, sr, p);
+      }
+    }
+    return true;
+  }
+
+  bool IsRed(SegmentRef s) const { return s < first_blue_; }
+
+  // Whether the segments meeting at the current event, those starting there
+  // and those in R_ and C_, are to be reported: at least two, and of both
+  // colors in a red-blue sweep.
+  bool ShouldReport(const SegmentRef* L_begin, const SegmentRef* L_end) const {
+    if (!first_blue_) {
+      return (L_end - L_begin) + R_.size() + C_.size() > 1;
+    }
+    bool red = false;
+    bool blue = false;
+    for (const SegmentRef* s = L_begin; s != L_end; ++s) {
+      (IsRed(*s) ? red : blue) = true;
+    }
+    for (const vector<SegmentRef>* segments : {&R_, &C_}) {
+      for (SegmentRef s : *segments) {
+        (IsRed(s) ? red : blue) = true;
       }
     }
+    return red && blue;
+  }
+
+  // Schedules the intersection of neighbors s1 and s2 to the right of p,
+  // unless they have the same color in a red-blue sweep.
+  void TestNeighbors(SegmentRef s1, SegmentRef s2, Point p) {
+    if (!first_blue_ || IsRed(s1) != IsRed(s2)) {
+      FindNewEvent(s1, s2, p);
+    }
   }
 
   void FindNewEvent(SegmentRef s1, SegmentRef s2, Point p) {
+    GEOMETRY_STATS_ONLY(++stats_.intersection_tests;)
     Point intersection;
-    if (s1->IntersectsSegment(*s2, &intersection)
+    if (s1->segment().IntersectsSegment(s2->segment(), &intersection)
         && p < intersection) {
-      queue_.EventAtPoint(intersection);
+      queue_.AddIntersectionEvent(intersection);
+    }
+  }
+
+  void ToIndices(const SegmentRef* begin,
+                 const SegmentRef* end,
+                 vector<int>* indices) const {
+    indices->clear();
+    for (const SegmentRef* s = begin; s != end; ++s) {
+      indices->push_back(*s - segments_.data());
     }
   }
 };
 
+namespace {
+
+// Whether a and b have a common point, decided exactly. With
+// ignore_shared_endpoints, an endpoint of both is not enough if it is the
+// only common point.
+bool SegmentsMeet(const Segment& a, const Segment& b,
+                  bool ignore_shared_endpoints) {
+  Point a0 = a.endpoint(0), a1 = a.endpoint(1);
+  Point b0 = b.endpoint(0), b1 = b.endpoint(1);
+  int b0_side = Orientation(a0, a1, b0);
+  int b1_side = Orientation(a0, a1, b1);
+  int a0_side = Orientation(b0, b1, a0);
+  int a1_side = Orientation(b0, b1, a1);
+  if (b0_side * b1_side > 0 || a0_side * a1_side > 0) {
+    return false;
+  }
+  if (b0_side == 0 && b1_side == 0 && a0_side == 0 && a1_side == 0) {
+    // Collinear; endpoints are ordered along the common line.
+    if (a1 < b0 || b1 < a0) {
+      return false;
+    }
+    return !ignore_shared_endpoints || (a1 != b0 && b1 != a0);
+  }
+  // Segments on different lines meet at one point.
+  return !ignore_shared_endpoints
+      || (a0 != b0 && a0 != b1 && a1 != b0 && a1 != b1);
+}
+
+}  // namespace
+
+// The sweep of Shamos and Hoey. Without intersection events the status
+// stays ordered only up to the first intersection, which is where it stops.
+class IntersectionDetector {
+ public:
+  IntersectionDetector(const vector<PreparedSegment>& segments,
+                       const vector<SegmentRef>& swept,
+                       bool ignore_shared_endpoints)
+      : segments_(segments),
+        queue_(swept,
+               -numeric_limits<double>::infinity(),
+               numeric_limits<double>::infinity(),
+               &arena_),
+        ignore_shared_endpoints_(ignore_shared_endpoints) {}
+
+  // Stores the indices of two segments that meet in witness unless it is
+  // null.
+  bool Find(pair<int, int>* witness) {
+    while (!queue_.empty()) {
+      if (HandleEvent(*queue_.PopNextEvent(), witness)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  const vector<PreparedSegment>& segments_;
+  Arena arena_;
+  EventQueue queue_;
+  SweepLineStatus status_;
+  const bool ignore_shared_endpoints_;
+  // Scratch space reused by every event.
+  vector<SegmentRef> passing_;
+  vector<SegmentRef> meeting_;
+  vector<SegmentRef> R_;
+  vector<SegmentRef> L_;
+
+  bool HandleEvent(const Event& e, pair<int, int>* witness) {
+    Point p = e.point;
+    status_.set_event_point(p);
+    status_.SegmentsPassingCurrentEventPoint(&passing_);
+    // Segments containing p in their interior go first, since they meet the
+    // others even when shared endpoints are ignored. Segments merely close
+    // to p are left alone.
+    meeting_.clear();
+    R_.clear();
+    for (auto s : passing_) {
+      if (s->endpoint(1) == p) {
+        R_.push_back(s);
+      } else if (Orientation(s->endpoint(0), s->endpoint(1), p) == 0) {
+        meeting_.push_back(s);
+      }
+    }
+    bool contained = !meeting_.empty();
+    meeting_.insert(meeting_.end(), e.starting_begin, e.starting_end);
+    meeting_.insert(meeting_.end(), R_.begin(), R_.end());
+    if (meeting_.size() >= 2 && (contained || !ignore_shared_endpoints_)) {
+      return Report(meeting_[0], meeting_[1], witness);
+    }
+
+    for (auto s : R_) { status_.DeleteSegment(s); }
+    vector<SegmentRef>& L = L_;
+    L.assign(e.starting_begin, e.starting_end);
+    for (auto s : L) { status_.InsertSegment(s); }
+    if (L.empty()) {
+      SegmentRef sb = status_.SegmentBelowCurrentEventPoint();
+      SegmentRef sa = status_.SegmentAboveCurrentEventPoint();
+      return Test(sb, sa, witness);
+    }
+    std::sort(L.begin(), L.end(),
+              SegmentComparator(p, SegmentComparator::FORWARD));
+    // Segments starting together meet beyond p only if they overlap, and
+    // overlapping ones are next to each other in L.
+    for (size_t i = 1; i < L.size(); ++i) {
+      if (Test(L[i - 1], L[i], witness)) {
+        return true;
+      }
+    }
+    return Test(status_.SegmentBelowSegment(L.front()), L.front(), witness)
+        || Test(L.back(), status_.SegmentAboveSegment(L.back()), witness);
+  }
+
+  bool Test(SegmentRef s1, SegmentRef s2, pair<int, int>* witness) {
+    if (s1 && s2
+        && SegmentsMeet(s1->segment(), s2->segment(),
+                        ignore_shared_endpoints_)) {
+      return Report(s1, s2, witness);
+    }
+    return false;
+  }
+
+  bool Report(SegmentRef s1, SegmentRef s2, pair<int, int>* witness) {
+    if (witness) {
+      *witness = make_pair(s1 - segments_.data(), s2 - segments_.data());
+    }
+    return true;
+  }
+};
+
 }  // namespace segment_intersection_internal
 
+namespace {
+
+using segment_intersection_internal::IntersectionFinder;
+using segment_intersection_internal::PreparedSegment;
+using segment_intersection_internal::SegmentRef;
+
+// Below this many segments per thread the threads cost more than they save.
+const size_t kMinSegmentsPerThread = 1 << 9;
+
+// More slabs than threads even out slabs with more intersections than
+// others.
+const int kSlabsPerThread = 4;
+
+vector<SegmentRef> AllOf(const vector<PreparedSegment>& prepared) {
+  vector<SegmentRef> refs;
+  refs.reserve(prepared.size());
+  for (const PreparedSegment& s : prepared) {
+    refs.push_back(&s);
+  }
+  return refs;
+}
+
+// Sweeps all the prepared segments, as a red-blue sweep unless first_blue is
+// null. Fills in stats unless it is null.
+bool Sweep(const vector<PreparedSegment>& prepared,
+           const IntersectionVisitor& visitor,
+           SweepStats* stats = nullptr,
+           SegmentRef first_blue = nullptr) {
+  GEOMETRY_STATS_ONLY(Stopwatch stopwatch; double sort_seconds = 0;)
+  IntersectionFinder finder(prepared, AllOf(prepared), visitor,
+                            -numeric_limits<double>::infinity(),
+                            numeric_limits<double>::infinity(), first_blue);
+  GEOMETRY_STATS_ONLY(stopwatch.Lap(&sort_seconds);)
+  bool finished = finder.Find();
+  if (stats) {
+    *stats = finder.stats();
+    GEOMETRY_STATS_ONLY(stats->sort_seconds = sort_seconds;
+                        stopwatch.Lap(&stats->sweep_seconds);)
+  }
+  return finished;
+}
+
+vector<Segment> SegmentsOf(const Intersection& intersection,
+                           Span<const Segment> segments) {
+  vector<Segment> all_segments;
+  for (int i : intersection.starting) {
+    all_segments.push_back(segments[i]);
+  }
+  for (int i : intersection.ending) {
+    all_segments.push_back(segments[i]);
+  }
+  for (int i : intersection.containing) {
+    all_segments.push_back(segments[i]);
+  }
+  return all_segments;
+}
+
+}  // namespace
+
+string SweepStats::ToJson() const {
+  return NumbersToJson({{"events", events},
+                        {"intersections", intersections},
+                        {"max_status_size", max_status_size},
+                        {"comparisons", comparisons},
+                        {"intersection_tests", intersection_tests},
+                        {"arena_bytes", arena_bytes},
+                        {"misplaced_deletions", misplaced_deletions},
+                        {"sort_seconds", sort_seconds},
+                        {"sweep_seconds", sweep_seconds}});
+}
+
 map<Point, vector<Segment>> FindIntersections(const vector<Segment>& segments) {
-  segment_intersection_internal::IntersectionFinder finder(segments);
-  return finder.Find();
+  return FindIntersections(Span<const Segment>(segments));
+}
+
+bool FindIntersections(const vector<Segment>& segments,
+                       const IntersectionVisitor& visitor) {
+  return FindIntersections(Span<const Segment>(segments), visitor);
+}
+
+map<Point, vector<Segment>> FindIntersections(Span<const Segment> segments) {
+  map<Point, vector<Segment>> intersections;
+  FindIntersections(segments, [&](const Intersection& intersection) {
+    intersections[intersection.point] = SegmentsOf(intersection, segments);
+    return true;
+  });
+  return intersections;
+}
+
+bool FindIntersections(Span<const Segment> segments,
+                       const IntersectionVisitor& visitor) {
+  return FindIntersections(segments, visitor, nullptr);
+}
+
+bool FindIntersections(Span<const Segment> segments,
+                       const IntersectionVisitor& visitor,
+                       SweepStats* stats) {
+  const vector<PreparedSegment> prepared(segments.begin(), segments.end());
+  return Sweep(prepared, visitor, stats);
+}
+
+template<class T>
+map<Point, vector<BasicSegment<T>>> FindIntersections(
+    const vector<BasicSegment<T>>& segments) {
+  map<Point, vector<BasicSegment<T>>> intersections;
+  FindIntersections(segments, [&](const Intersection& intersection) {
+    vector<BasicSegment<T>>& meeting = intersections[intersection.point];
+    for (const vector<int>* indices : {&intersection.starting,
+                                       &intersection.ending,
+                                       &intersection.containing}) {
+      for (int i : *indices) {
+        meeting.push_back(segments[i]);
+      }
+    }
+    return true;
+  });
+  return intersections;
+}
+
+namespace {
+
+// Whether the integer x converts to double exactly because it does not
+// exceed 2^53 in magnitude.
+bool ConvertsExactly(int64_t x) {
+  const int64_t kMaxExactInteger = int64_t(1) << 53;
+  return -kMaxExactInteger <= x && x <= kMaxExactInteger;
+}
+
+// The point with double coordinates, which must be exact.
+template<class T>
+Point ToDouble(BasicPoint<T> p) {
+  assert(!std::is_integral<T>::value
+         || (ConvertsExactly(p.x) && ConvertsExactly(p.y)));
+  return Point(p.x, p.y);
+}
+
+}  // namespace
+
+template<class T>
+bool FindIntersections(const vector<BasicSegment<T>>& segments,
+                       const IntersectionVisitor& visitor) {
+  vector<Segment> converted;
+  converted.reserve(segments.size());
+  for (const BasicSegment<T>& s : segments) {
+    converted.emplace_back(ToDouble(s.endpoint(0)), ToDouble(s.endpoint(1)));
+  }
+  const vector<PreparedSegment> prepared(converted.begin(), converted.end());
+  return Sweep(prepared, visitor);
+}
+
+#define INSTANTIATE_FIND_INTERSECTIONS(T)                                     \
+  template map<Point, vector<BasicSegment<T>>> FindIntersections(             \
+      const vector<BasicSegment<T>>& segments);                               \
+  template bool FindIntersections(const vector<BasicSegment<T>>& segments,    \
+                                  const IntersectionVisitor& visitor);
+
+INSTANTIATE_FIND_INTERSECTIONS(float)
+INSTANTIATE_FIND_INTERSECTIONS(int32_t)
+INSTANTIATE_FIND_INTERSECTIONS(int64_t)
+
+#undef INSTANTIATE_FIND_INTERSECTIONS
+
+map<Point, vector<Segment>> ParallelFindIntersections(
+    const vector<Segment>& segments, int num_threads) {
+  num_threads =
+      ClampNumThreads(num_threads, segments.size(), kMinSegmentsPerThread);
+  if (num_threads <= 1) {
+    return FindIntersections(segments);
+  }
+
+  // Slab i holds the events with splitters[i - 1] <= x < splitters[i]. The
+  // splitters are quantiles of a sample of the endpoints.
+  int num_slabs = num_threads * kSlabsPerThread;
+  vector<double> splitters;
+  int num_samples = num_slabs * kSamplesPerSlab;
+  for (int i = 0; i < num_samples; ++i) {
+    const Segment& s = segments[i * (segments.size() / num_samples)];
+    splitters.push_back(s.endpoint(i % 2).x);
+  }
+  std::sort(splitters.begin(), splitters.end());
+  for (int i = 1; i < num_slabs; ++i) {
+    splitters[i - 1] = splitters[i * kSamplesPerSlab];
+  }
+  splitters.resize(num_slabs - 1);
+  splitters.erase(std::unique(splitters.begin(), splitters.end()),
+                  splitters.end());
+  splitters.insert(splitters.begin(), -numeric_limits<double>::infinity());
+  splitters.push_back(numeric_limits<double>::infinity());
+  num_slabs = splitters.size() - 1;
+
+  // Every slab sweeps the segments overlapping its x-range.
+  const vector<PreparedSegment> prepared(segments.begin(), segments.end());
+  vector<vector<SegmentRef>> swept(num_slabs);
+  for (const PreparedSegment& s : prepared) {
+    int first = std::upper_bound(splitters.begin(), splitters.end(),
+                                 s.endpoint(0).x) - splitters.begin() - 1;
+    int last = std::upper_bound(splitters.begin(), splitters.end(),
+                                s.endpoint(1).x) - splitters.begin() - 1;
+    for (int slab = first; slab <= last; ++slab) {
+      swept[slab].push_back(&s);
+    }
+  }
+  vector<vector<pair<Point, vector<Segment>>>> found(num_slabs);
+  std::atomic<int> next_slab(0);
+  RunInParallel(num_threads, [&](int) {
+    for (int slab = next_slab++; slab < num_slabs; slab = next_slab++) {
+      IntersectionVisitor visitor = [&](const Intersection& intersection) {
+        found[slab].push_back(
+            make_pair(intersection.point, SegmentsOf(intersection, segments)));
+        return true;
+      };
+      IntersectionFinder finder(prepared, swept[slab], visitor,
+                                splitters[slab], splitters[slab + 1]);
+      finder.Find();
+    }
+  });
+
+  map<Point, vector<Segment>> intersections;
+  for (auto& slab : found) {
+    for (auto& intersection : slab) {
+      intersections.insert(intersections.end(), std::move(intersection));
+    }
+  }
+  return intersections;
+}
+
+bool FindRedBlueIntersections(const vector<Segment>& red,
+                              const vector<Segment>& blue,
+                              const RedBlueIntersectionVisitor& visitor) {
+  if (red.empty() || blue.empty()) {
+    return true;
+  }
+  // Red segments come first, so an index tells the color.
+  vector<PreparedSegment> prepared;
+  prepared.reserve(red.size() + blue.size());
+  for (const Segment& s : red) {
+    prepared.emplace_back(s);
+  }
+  for (const Segment& s : blue) {
+    prepared.emplace_back(s);
+  }
+  const int num_red = red.size();
+  RedBlueIntersection red_blue;
+  auto split = [&](const Intersection& intersection) {
+    red_blue.point = intersection.point;
+    red_blue.red.clear();
+    red_blue.blue.clear();
+    for (const vector<int>* indices : {&intersection.starting,
+                                       &intersection.ending,
+                                       &intersection.containing}) {
+      for (int i : *indices) {
+        if (i < num_red) {
+          red_blue.red.push_back(i);
+        } else {
+          red_blue.blue.push_back(i - num_red);
+        }
+      }
+    }
+    return visitor(red_blue);
+  };
+  return Sweep(prepared, split, nullptr, &prepared[num_red]);
+}
+
+bool AnyIntersection(const vector<Segment>& segments,
+                     pair<int, int>* witness) {
+  return AnyIntersection(segments, AnyIntersectionOptions(), witness);
+}
+
+bool AnyIntersection(const vector<Segment>& segments,
+                     const AnyIntersectionOptions& options,
+                     pair<int, int>* witness) {
+  const vector<PreparedSegment> prepared(segments.begin(), segments.end());
+  segment_intersection_internal::IntersectionDetector detector(
+      prepared, AllOf(prepared), options.ignore_shared_endpoints);
+  return detector.Find(witness);
 }
@@ -1,32 +1,262 @@
 #pragma once
 
+#include <functional>
 #include <map>
+#include <set>
+#include <string>
+#include <utility>
 #include <vector>
 #include "base/base.h"
+#include "base/span.h"
 
 // A place sweep algorithm to find line segment intersections on page 25.
 std::map<Point, std::vector<Segment>> FindIntersections(
     const std::vector<Segment>& segments);
 
+// The segments meeting at an intersection point, given as indices into the
+// input of FindIntersections.
+struct Intersection {
+  Point point;
+  // Segments whose left endpoint is the point.
+  std::vector<int> starting;
+  // Segments whose right endpoint is the point.
+  std::vector<int> ending;
+  // Segments containing the point in their interior.
+  std::vector<int> containing;
+};
+
+// Receives intersections in lexicographic order of their points. The
+// Intersection is only valid during the call. Returning false stops the sweep.
+using IntersectionVisitor = std::function<bool(const Intersection&)>;
+
+// The same plane sweep, reporting each intersection to the visitor as soon as
+// it is found instead of collecting them. No segment is copied: the sweep
+// keeps a pointer to each one with its slope, next to its entries in the event
+// queue, and otherwise uses memory proportional to the number of segments
+// crossing the sweep line. Returns false if the visitor stopped the sweep.
+bool FindIntersections(const std::vector<Segment>& segments,
+                       const IntersectionVisitor& visitor);
+
+// Both forms of FindIntersections for segments owned elsewhere, such as in a
+// MappedGeometryFile of base/geometry-file.h, without copying them into a
+// vector first. Indices refer to positions in the span.
+std::map<Point, std::vector<Segment>> FindIntersections(
+    Span<const Segment> segments);
+bool FindIntersections(Span<const Segment> segments,
+                       const IntersectionVisitor& visitor);
+
+// Counts of the work done by the sweep of FindIntersections, to tell why a
+// call took long. All but arena_bytes and misplaced_deletions are measured
+// only when built with GEOMETRY_STATS, see base/stats.h.
+struct SweepStats {
+  // The event points handled, endpoints and intersections.
+  size_t events;
+  // The intersections reported to the visitor.
+  size_t intersections;
+  // The most segments crossing the sweep line at once.
+  size_t max_status_size;
+  // The segment comparisons made by the sweep line status.
+  size_t comparisons;
+  // The pairs of neighbors tested with IntersectsSegment.
+  size_t intersection_tests;
+  // The bytes of endpoint events allocated from the arena.
+  size_t arena_bytes;
+  // The segments that rounding left out of place in the sweep line status,
+  // so that deleting them took a scan of the whole status.
+  size_t misplaced_deletions;
+  // The seconds spent sorting the endpoints into events and sweeping.
+  double sort_seconds;
+  double sweep_seconds;
+
+  SweepStats()
+      : events(0), intersections(0), max_status_size(0), comparisons(0),
+        intersection_tests(0), arena_bytes(0), misplaced_deletions(0),
+        sort_seconds(0), sweep_seconds(0) {}
+
+  // All fields as one JSON object.
+  std::string ToJson() const;
+};
+
+// The visitor form of FindIntersections. Fills in stats unless it is null.
+bool FindIntersections(Span<const Segment> segments,
+                       const IntersectionVisitor& visitor,
+                       SweepStats* stats);
+
+// Both forms of FindIntersections for segments with the other coordinate
+// types of base/base.h: float, int32_t and int64_t. The sweep runs on double
+// coordinates, which hold float and int32_t coordinates exactly, but int64_t
+// ones only up to 2^53: int64_t coordinates must not exceed 2^53 in
+// magnitude, which is checked by an assert. Both forms convert a copy of the
+// segments to double. Intersection points are doubles for every type, since
+// they do not have integer coordinates in general.
+template<class T>
+std::map<Point, std::vector<BasicSegment<T>>> FindIntersections(
+    const std::vector<BasicSegment<T>>& segments);
+template<class T>
+bool FindIntersections(const std::vector<BasicSegment<T>>& segments,
+                       const IntersectionVisitor& visitor);
+
+// The same result as FindIntersections computed by num_threads threads. The
+// plane is cut into vertical slabs holding about equal numbers of endpoints,
+// and each slab is swept on its own, starting from the segments that cross
+// its left boundary. Every intersection is reported by the one slab whose
+// x-range contains it, so nothing is reported twice.
+std::map<Point, std::vector<Segment>> ParallelFindIntersections(
+    const std::vector<Segment>& segments, int num_threads);
+
+// A point where segments of two sets, red and blue, meet, such as roads and
+// rivers. Segments are given as indices into their own set.
+struct RedBlueIntersection {
+  Point point;
+  // The segments containing the point, in their interior or as an endpoint.
+  std::vector<int> red;
+  std::vector<int> blue;
+};
+
+using RedBlueIntersectionVisitor =
+    std::function<bool(const RedBlueIntersection&)>;
+
+// Reports the points where at least one red and one blue segment meet, in
+// lexicographic order. Segments of the same color must not cross or overlap,
+// though they may share endpoints like the edges of a planar map; otherwise
+// red-blue points may be missed. The sweep never tests two segments of the
+// same color against each other, so it only stops at endpoints and red-blue
+// intersections, and takes O((n + k) log n) time for k reported points.
+// Returns false if the visitor stopped the sweep.
+bool FindRedBlueIntersections(const std::vector<Segment>& red,
+                              const std::vector<Segment>& blue,
+                              const RedBlueIntersectionVisitor& visitor);
+
+struct AnyIntersectionOptions {
+  // Segments that meet only at an endpoint of both, such as consecutive
+  // edges of a polyline, do not count.
+  bool ignore_shared_endpoints;
+
+  AnyIntersectionOptions() : ignore_shared_endpoints(false) {}
+};
+
+// Whether two of the segments meet, that is whether FindIntersections would
+// find anything, decided by the sweep of Shamos and Hoey in O(n log n) time.
+// Only endpoints are events: segments are tested as they become neighbors
+// in the sweep line status, and the sweep stops at the first pair that
+// meets. Their indices are stored in witness unless it is null.
+bool AnyIntersection(const std::vector<Segment>& segments,
+                     std::pair<int, int>* witness = nullptr);
+bool AnyIntersection(const std::vector<Segment>& segments,
+                     const AnyIntersectionOptions& options,
+                     std::pair<int, int>* witness);
+
 namespace segment_intersection_internal {
 
-using SegmentRef = const Segment*;
+// A segment's supporting line in slope form, computed once per input
+// segment. The sweep line comparator evaluates y for x on every probe, and
+// this makes that a subtraction and a multiply-add instead of building a
+// DirectedLine and dividing. Refers to the segment, which must outlive it.
+class PreparedSegment {
+ public:
+  explicit PreparedSegment(const Segment& segment);
+
+  const Segment& segment() const { return *segment_; }
+  Point endpoint(int i) const { return segment_->endpoint(i); }
+
+  bool is_vertical() const { return is_vertical_; }
+  bool is_horizontal() const { return is_horizontal_; }
+  // Zero for vertical segments.
+  double slope() const { return slope_; }
+
+  // The line is anchored at the left endpoint, so this is exact there and
+  // accurate near the segment even far from the origin.
+  double y_for_x(double x) const {
+    return left_y_ + slope_ * (x - left_x_);
+  }
+
+ private:
+  const Segment* segment_;
+  double left_x_;
+  double left_y_;
+  double slope_;
+  bool is_vertical_;
+  bool is_horizontal_;
+};
+
+using SegmentRef = const PreparedSegment*;
+
+// Orders segments by where they cross the sweep line through an event point.
+// Segments crossing at the same point are ordered as they are slightly before
+// (BACKWARD) or after (FORWARD) the event point, or considered equal (NONE).
+class SegmentComparator {
+ public:
+  enum SweepLineShift {
+    NONE,
+    BACKWARD,
+    FORWARD,
+  };
+
+  SegmentComparator(Point event_point, SweepLineShift shift);
+
+  bool operator()(SegmentRef lhs, SegmentRef rhs) const;
+
+ private:
+  Point event_point_;
+  SweepLineShift shift_;
+  // Heights closer than this times one plus the slopes involved are equal.
+  // It grows with the magnitude of the coordinates, as the rounding error of
+  // computed intersections and heights does.
+  double tolerance_;
+};
 
+// The segments crossing the sweep line, kept in a balanced search tree so that
+// insertions, deletions and neighbor queries take O(log n) time.
 class SweepLineStatus {
  public:
+  SweepLineStatus();
+  SweepLineStatus(const SweepLineStatus&) = delete;
+  SweepLineStatus& operator=(const SweepLineStatus&) = delete;
+
   void set_event_point(Point p);
 
   SegmentRef SegmentAboveCurrentEventPoint();
   SegmentRef SegmentBelowCurrentEventPoint();
   std::vector<SegmentRef> SegmentsPassingCurrentEventPoint();
+  void SegmentsPassingCurrentEventPoint(std::vector<SegmentRef>* segments);
   SegmentRef SegmentBelowSegment(SegmentRef s);
   SegmentRef SegmentAboveSegment(SegmentRef s);
   void DeleteSegment(SegmentRef s);
   void InsertSegment(SegmentRef s);
+  // Fills the empty status with the segments crossing the sweep line just
+  // before the current event point, which must be sorted by a
+  // SegmentComparator with BACKWARD shift there.
+  void AssignSegmentsBefore(const std::vector<SegmentRef>& segments);
+
+  size_t size() const { return segments_.size(); }
+  // The comparisons made so far, counted only when built with
+  // GEOMETRY_STATS.
+  size_t comparisons() const { return comparisons_; }
+  // The deletions that did not find the segment among those comparing equal
+  // to it and fell back to a linear scan.
+  size_t misplaced_deletions() const { return misplaced_deletions_; }
 
 private:
+  // Compares segments with SegmentComparator at the status's current event
+  // point and shift. The order of the segments in the tree does not change
+  // between events, so the tree stays valid as the event point moves.
+  class Order {
+   public:
+    explicit Order(const SweepLineStatus* status) : status_(status) {}
+    bool operator()(SegmentRef lhs, SegmentRef rhs) const;
+
+   private:
+    const SweepLineStatus* status_;
+  };
+
+  // A short horizontal segment centered at the event point, used as a probe.
+  Segment HorizontalThroughEventPoint() const;
+
   Point event_point_;
-  std::vector<SegmentRef> segments_;
+  SegmentComparator::SweepLineShift shift_;
+  std::multiset<SegmentRef, Order> segments_;
+  mutable size_t comparisons_;
+  size_t misplaced_deletions_;
 };
 
 }  // internal
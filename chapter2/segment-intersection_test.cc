@@ -1,8 +1,17 @@
 #include "chapter2/segment-intersection.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <utility>
+#include "base/stats.h"
+#include "base/workload.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using std::make_pair;
 using std::vector;
+using testing::ElementsAre;
 using testing::Matches;
 using testing::UnorderedElementsAre;
 
@@ -13,14 +22,55 @@ MATCHER_P(SegmentNear, s, "") {
       && Near(s.endpoint(1), arg.endpoint(1));
 }
 
+// Whether both have the same points with the same segments in the same order.
+bool SameIntersections(const std::map<Point, vector<Segment>>& lhs,
+                       const std::map<Point, vector<Segment>>& rhs) {
+  auto same_segments = [](const vector<Segment>& l, const vector<Segment>& r) {
+    return std::equal(l.begin(), l.end(), r.begin(), r.end(),
+                      [](const Segment& a, const Segment& b) {
+                        return a.endpoints() == b.endpoints();
+                      });
+  };
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                    [&](const std::pair<const Point, vector<Segment>>& l,
+                        const std::pair<const Point, vector<Segment>>& r) {
+                      return l.first == r.first
+                          && same_segments(l.second, r.second);
+                    });
+}
+
+TEST(PreparedSegmentTest, YForX) {
+  const Segment segment(Point(1, 2), Point(0, 0));
+  PreparedSegment s(segment);
+  EXPECT_EQ(&segment, &s.segment());
+  EXPECT_FALSE(s.is_vertical());
+  EXPECT_FALSE(s.is_horizontal());
+  EXPECT_EQ(Point(0, 0), s.endpoint(0));
+  EXPECT_DOUBLE_EQ(-0.2, s.y_for_x(-0.1));
+  EXPECT_DOUBLE_EQ(0, s.y_for_x(0));
+  EXPECT_DOUBLE_EQ(0.6, s.y_for_x(0.3));
+  EXPECT_DOUBLE_EQ(2, s.y_for_x(1));
+
+  const Segment horizontal_segment(Point(0, 2), Point(1, 2));
+  PreparedSegment horizontal(horizontal_segment);
+  EXPECT_TRUE(horizontal.is_horizontal());
+  EXPECT_EQ(2, horizontal.y_for_x(0.3));
+  EXPECT_EQ(2, horizontal.y_for_x(1.1));
+
+  const Segment vertical_segment(Point(1, 0), Point(1, 2));
+  PreparedSegment vertical(vertical_segment);
+  EXPECT_TRUE(vertical.is_vertical());
+}
+
 TEST(SweepLineStatus, Comprehensive) {
-  Segment segments[] = {
+  const Segment input[] = {
     Segment(Point(1.1, 3.3), Point(3.3, 5.5)),
     Segment(Point(1.1, 5.5), Point(3.3, 3.3)),
     Segment(Point(2.2, 2.2), Point(5.5, 5.5)),
     Segment(Point(2.2, 6.6), Point(5.5, 3.3)),
     Segment(Point(3.3, 1.1), Point(3.3, 7.7)),
   };
+  const vector<PreparedSegment> segments(std::begin(input), std::end(input));
 
   SweepLineStatus status;
 
@@ -75,6 +125,38 @@ TEST(SweepLineStatus, Comprehensive) {
               UnorderedElementsAre(&segments[2], &segments[3]));
 }
 
+TEST(SweepLineStatus, Neighbors) {
+  const int kNumSegments = 100;
+  vector<Segment> input;
+  for (int i = 0; i < kNumSegments; ++i) {
+    input.push_back(Segment(Point(0, i), Point(10, i + 0.5)));
+  }
+  const vector<PreparedSegment> segments(input.begin(), input.end());
+  vector<int> order;
+  for (int i = 0; i < kNumSegments; ++i) {
+    order.push_back((i * 37) % kNumSegments);
+  }
+
+  SweepLineStatus status;
+  for (int i : order) {
+    status.set_event_point(segments[i].endpoint(0));
+    status.InsertSegment(&segments[i]);
+  }
+
+  status.set_event_point(Point(5, 50.5));
+  EXPECT_EQ(&segments[50], status.SegmentBelowCurrentEventPoint());
+  EXPECT_EQ(&segments[51], status.SegmentAboveCurrentEventPoint());
+  EXPECT_EQ(&segments[49], status.SegmentBelowSegment(&segments[50]));
+  EXPECT_EQ(&segments[51], status.SegmentAboveSegment(&segments[50]));
+  EXPECT_EQ(nullptr, status.SegmentBelowSegment(&segments[0]));
+  EXPECT_EQ(nullptr, status.SegmentAboveSegment(&segments[99]));
+
+  status.DeleteSegment(&segments[50]);
+  status.DeleteSegment(&segments[51]);
+  EXPECT_EQ(&segments[49], status.SegmentBelowCurrentEventPoint());
+  EXPECT_EQ(&segments[52], status.SegmentAboveCurrentEventPoint());
+}
+
 TEST(FindIntersectionsTest, Empty) {
   vector<Segment> segments;
   auto intersections = FindIntersections(segments);
@@ -111,4 +193,370 @@ TEST(FindIntersectionsTest, TwoSegments) {
                                    SegmentNear(segments[1])));
 }
 
+TEST(FindIntersectionsTest, CrossingAtEndpoint) {
+  vector<Segment> segments {
+    {{0, 0}, {2, 2}},
+    {{0, 2}, {2, 0}},
+    {{1, 1}, {3, 1}},
+    {{3, 1}, {4, 0}},
+  };
+  auto intersections = FindIntersections(segments);
+  ASSERT_EQ(2, intersections.size());
+  EXPECT_THAT(intersections[Point(1, 1)],
+              UnorderedElementsAre(SegmentNear(segments[0]),
+                                   SegmentNear(segments[1]),
+                                   SegmentNear(segments[2])));
+  EXPECT_THAT(intersections[Point(3, 1)],
+              UnorderedElementsAre(SegmentNear(segments[2]),
+                                   SegmentNear(segments[3])));
+}
+
+TEST(FindIntersectionsTest, LargeCoordinates) {
+  // A tilted 20 by 20 grid of crossings at UTM-like coordinates, in meters.
+  const double x0 = 500000.25;
+  const double y0 = 4000000.5;
+  vector<Segment> segments;
+  for (int i = 0; i < 20; ++i) {
+    segments.push_back(Segment(Point(x0, y0 + i * 10.25),
+                               Point(x0 + 200, y0 + i * 10.25 + 3)));
+    segments.push_back(Segment(Point(x0 + i * 9.5 + 1, y0 - 5),
+                               Point(x0 + i * 9.5 + 3, y0 + 220)));
+  }
+  int num_points = 0;
+  bool completed = FindIntersections(
+      segments,
+      [&](const Intersection& intersection) {
+        ++num_points;
+        EXPECT_EQ(2, intersection.starting.size()
+                  + intersection.ending.size()
+                  + intersection.containing.size())
+            << intersection.point;
+        return true;
+      });
+  EXPECT_TRUE(completed);
+  EXPECT_EQ(400, num_points);
+}
+
+TEST(FindIntersectionsTest, Visitor) {
+  vector<Segment> segments {
+    {{0, 0}, {2, 2}},
+    {{0, 2}, {2, 0}},
+    {{1, 1}, {3, 1}},
+    {{3, 1}, {4, 0}},
+  };
+  vector<Point> points;
+  bool completed = FindIntersections(
+      segments,
+      [&](const Intersection& intersection) {
+        points.push_back(intersection.point);
+        if (intersection.point == Point(1, 1)) {
+          EXPECT_THAT(intersection.starting, ElementsAre(2));
+          EXPECT_THAT(intersection.ending, ElementsAre());
+          EXPECT_THAT(intersection.containing, UnorderedElementsAre(0, 1));
+        } else {
+          EXPECT_THAT(intersection.starting, ElementsAre(3));
+          EXPECT_THAT(intersection.ending, ElementsAre(2));
+          EXPECT_THAT(intersection.containing, ElementsAre());
+        }
+        return true;
+      });
+  EXPECT_TRUE(completed);
+  EXPECT_THAT(points, ElementsAre(Point(1, 1), Point(3, 1)));
+}
+
+TEST(FindIntersectionsTest, Visitor_StopEarly) {
+  vector<Segment> segments {
+    {{0, 0}, {2, 2}},
+    {{0, 2}, {2, 0}},
+    {{1, 1}, {3, 1}},
+    {{3, 1}, {4, 0}},
+  };
+  int calls = 0;
+  bool completed = FindIntersections(segments,
+                                     [&](const Intersection&) {
+                                       ++calls;
+                                       return false;
+                                     });
+  EXPECT_FALSE(completed);
+  EXPECT_EQ(1, calls);
+}
+
+TEST(FindIntersectionsTest, Span) {
+  vector<Segment> segments = RandomSegments(SHORT_SEGMENTS, 3000, 4);
+  Span<const Segment> middle(segments.data() + 500, 2000);
+  vector<Segment> copy(middle.begin(), middle.end());
+  EXPECT_TRUE(SameIntersections(FindIntersections(copy),
+                                FindIntersections(middle)));
+  size_t num_points = 0;
+  FindIntersections(middle, [&](const Intersection& intersection) {
+    for (int i : intersection.containing) {
+      EXPECT_LT(i, 2000);
+    }
+    ++num_points;
+    return true;
+  });
+  EXPECT_EQ(FindIntersections(copy).size(), num_points);
+}
+
+TEST(FindIntersectionsTest, Stats) {
+  vector<Segment> segments = RandomSegments(SHORT_SEGMENTS, 2000, 5);
+  size_t num_points = 0;
+  SweepStats stats;
+  EXPECT_TRUE(FindIntersections(segments, [&](const Intersection&) {
+    ++num_points;
+    return true;
+  }, &stats));
+  EXPECT_GT(stats.arena_bytes, 0);
+  EXPECT_EQ(0, stats.misplaced_deletions);
+  EXPECT_NE(std::string::npos, stats.ToJson().find("\"comparisons\": "));
+  if (!kGeometryStatsEnabled) {
+    EXPECT_EQ(0, stats.events);
+    EXPECT_EQ(0, stats.comparisons);
+    return;
+  }
+  // Every segment has two endpoint events, unless it shares them.
+  EXPECT_GE(stats.events, num_points);
+  EXPECT_LE(stats.events, 2 * segments.size() + num_points);
+  EXPECT_EQ(num_points, stats.intersections);
+  EXPECT_GT(stats.max_status_size, 1);
+  EXPECT_LT(stats.max_status_size, segments.size());
+  EXPECT_GT(stats.comparisons, stats.events);
+  EXPECT_GE(stats.intersection_tests, num_points);
+  EXPECT_GT(stats.sort_seconds, 0);
+  EXPECT_GT(stats.sweep_seconds, 0);
+}
+
+TEST(FindIntersectionsTest, IntegerCoordinates) {
+  using Point32 = BasicPoint<int32_t>;
+  using Segment32 = BasicSegment<int32_t>;
+  vector<Segment32> segments;
+  vector<Segment> as_double;
+  for (const Segment& s : RandomSegments(SHORT_SEGMENTS, 2000, 3)) {
+    Point32 p(s.endpoint(0).x * 1e9, s.endpoint(0).y * 1e9);
+    Point32 q(s.endpoint(1).x * 1e9, s.endpoint(1).y * 1e9);
+    segments.push_back(Segment32(p, q));
+    as_double.push_back(Segment(Point(p.x, p.y), Point(q.x, q.y)));
+  }
+  // A shared endpoint, exact in integers.
+  segments.push_back(Segment32(Point32(0, 0), Point32(7, 3)));
+  segments.push_back(Segment32(Point32(7, 3), Point32(9, 0)));
+  as_double.push_back(Segment(Point(0, 0), Point(7, 3)));
+  as_double.push_back(Segment(Point(7, 3), Point(9, 0)));
+
+  auto expected = FindIntersections(as_double);
+  auto intersections = FindIntersections(segments);
+  ASSERT_EQ(expected.size(), intersections.size());
+  EXPECT_GT(intersections.size(), 100);
+  auto e = expected.begin();
+  for (const auto& intersection : intersections) {
+    EXPECT_EQ(e->first, intersection.first);
+    ASSERT_EQ(e->second.size(), intersection.second.size());
+    for (size_t i = 0; i < e->second.size(); ++i) {
+      for (int j : {0, 1}) {
+        Point32 p = intersection.second[i].endpoint(j);
+        EXPECT_EQ(e->second[i].endpoint(j), Point(p.x, p.y));
+      }
+    }
+    ++e;
+  }
+  EXPECT_EQ(2, intersections[Point(7, 3)].size());
+}
+
+TEST(ParallelFindIntersectionsTest, SameAsFindIntersections) {
+  // Large enough for several threads, small enough to sweep quickly.
+  const std::pair<SegmentDistribution, int> inputs[] = {
+      {SHORT_SEGMENTS, 20000}, {LONG_SEGMENTS, 1100},
+      {AXIS_PARALLEL_SEGMENTS, 4000}};
+  for (auto input : inputs) {
+    SegmentDistribution distribution = input.first;
+    vector<Segment> segments = RandomSegments(distribution, input.second, 5);
+    auto expected = FindIntersections(segments);
+    for (int num_threads : {-1, 2, 3, 8}) {
+      auto found = ParallelFindIntersections(segments, num_threads);
+      EXPECT_EQ(expected.size(), found.size());
+      EXPECT_TRUE(SameIntersections(expected, found))
+          << SegmentDistributionName(distribution) << " " << num_threads;
+    }
+  }
+}
+
+TEST(FindRedBlueIntersectionsTest, Simple) {
+  // Two red polylines and a blue one. The red ones meet each other, and the
+  // blue one meets them at a crossing, at a shared vertex and where it ends on
+  // a red segment.
+  vector<Segment> red {
+    {{0, 0}, {2, 0}},
+    {{2, 0}, {4, 2}},
+    {{1, -1}, {1, 1}},
+  };
+  vector<Segment> blue {
+    {{0, 1}, {2, -1}},
+    {{2, -1}, {2, 0}},
+    {{3, 3}, {3, 1}},
+  };
+  vector<Point> points;
+  bool completed = FindRedBlueIntersections(
+      red,
+      blue,
+      [&](const RedBlueIntersection& intersection) {
+        points.push_back(intersection.point);
+        if (intersection.point == Point(1, 0)) {
+          EXPECT_THAT(intersection.red, UnorderedElementsAre(0, 2));
+          EXPECT_THAT(intersection.blue, ElementsAre(0));
+        } else if (intersection.point == Point(2, 0)) {
+          EXPECT_THAT(intersection.red, UnorderedElementsAre(0, 1));
+          EXPECT_THAT(intersection.blue, ElementsAre(1));
+        } else {
+          EXPECT_THAT(intersection.red, ElementsAre(1));
+          EXPECT_THAT(intersection.blue, ElementsAre(2));
+        }
+        return true;
+      });
+  EXPECT_TRUE(completed);
+  EXPECT_THAT(points, ElementsAre(Point(1, 0), Point(2, 0), Point(3, 1)));
+}
+
+// Red-blue points found by sweeping both colors together with
+// FindIntersections and keeping the points where both meet.
+std::map<Point, std::pair<vector<int>, vector<int>>> RedBluePointsOf(
+    const vector<Segment>& red, const vector<Segment>& blue) {
+  vector<Segment> all = red;
+  all.insert(all.end(), blue.begin(), blue.end());
+  std::map<Point, std::pair<vector<int>, vector<int>>> points;
+  FindIntersections(all, [&](const Intersection& intersection) {
+    vector<int> red_indices, blue_indices;
+    for (const vector<int>* indices : {&intersection.starting,
+                                       &intersection.ending,
+                                       &intersection.containing}) {
+      for (int i : *indices) {
+        if (i < red.size()) {
+          red_indices.push_back(i);
+        } else {
+          blue_indices.push_back(i - red.size());
+        }
+      }
+    }
+    if (!red_indices.empty() && !blue_indices.empty()) {
+      points[intersection.point] = make_pair(red_indices, blue_indices);
+    }
+    return true;
+  });
+  return points;
+}
+
+TEST(FindRedBlueIntersectionsTest, SameAsFindIntersections) {
+  // Two planar maps, whose edges meet only at shared corners. Blue also
+  // copies the red edges on the left, so that some red and blue edges
+  // overlap and share endpoints, and keeps its own on the right.
+  vector<Segment> red = RandomSubdivision(2000, 1);
+  vector<Segment> blue;
+  for (const Segment& s : red) {
+    if (s.endpoint(1).x < 0.3) {
+      blue.push_back(s);
+    }
+  }
+  for (const Segment& s : RandomSubdivision(1500, 2)) {
+    if (s.endpoint(0).x > 0.4) {
+      blue.push_back(s);
+    }
+  }
+  auto expected = RedBluePointsOf(red, blue);
+  EXPECT_LT(1000, expected.size());
+
+  std::map<Point, std::pair<vector<int>, vector<int>>> found;
+  vector<Point> order;
+  EXPECT_TRUE(FindRedBlueIntersections(
+      red, blue, [&](const RedBlueIntersection& intersection) {
+        order.push_back(intersection.point);
+        EXPECT_FALSE(intersection.red.empty());
+        EXPECT_FALSE(intersection.blue.empty());
+        found[intersection.point] =
+            make_pair(intersection.red, intersection.blue);
+        return true;
+      }));
+  EXPECT_EQ(expected, found);
+  EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+  EXPECT_TRUE(FindRedBlueIntersections(
+      red, {}, [](const RedBlueIntersection&) { return false; }));
+}
+
+TEST(AnyIntersectionTest, Simple) {
+  EXPECT_FALSE(AnyIntersection({}));
+  EXPECT_FALSE(AnyIntersection({{{0, 0}, {1, 1}}}));
+  EXPECT_FALSE(AnyIntersection({{{0, 0}, {1, 1}}, {{0, 1}, {1, 2}}}));
+  std::pair<int, int> witness;
+  EXPECT_TRUE(AnyIntersection(
+      {{{0, 0}, {4, 0}}, {{5, 5}, {6, 6}}, {{1, -1}, {3, 1}}}, &witness));
+  EXPECT_THAT(witness, testing::AnyOf(make_pair(0, 2), make_pair(2, 0)));
+}
+
+TEST(AnyIntersectionTest, IgnoreSharedEndpoints) {
+  AnyIntersectionOptions options;
+  options.ignore_shared_endpoints = true;
+  vector<Segment> polyline {
+    {{0, 0}, {1, 1}},
+    {{1, 1}, {2, 0}},
+    {{2, 0}, {3, 0}},
+    {{3, 0}, {4, 0}},
+    {{3, 0}, {3, -1}},
+  };
+  EXPECT_TRUE(AnyIntersection(polyline));
+  EXPECT_FALSE(AnyIntersection(polyline, options, nullptr));
+
+  std::pair<int, int> witness;
+  // An endpoint in the interior of another segment.
+  polyline.push_back({{0.5, 0.5}, {0.5, 2}});
+  EXPECT_TRUE(AnyIntersection(polyline, options, &witness));
+  polyline.pop_back();
+  // Collinear segments overlapping beyond a shared endpoint.
+  polyline.push_back({{2, 0}, {4, 0}});
+  EXPECT_TRUE(AnyIntersection(polyline, options, &witness));
+}
+
+TEST(AnyIntersectionTest, IgnoreSharedEndpointsOfIdenticalSegments) {
+  AnyIntersectionOptions options;
+  options.ignore_shared_endpoints = true;
+  std::pair<int, int> witness;
+  // Segments with both endpoints in common overlap along their length, in
+  // either direction and also when vertical.
+  for (Segment s : {Segment({0, 0}, {1, 0}), Segment({0, 0}, {1, 1}),
+                    Segment({0, 0}, {0, 1})}) {
+    vector<Segment> segments {s, Segment(s.endpoint(1), s.endpoint(0))};
+    EXPECT_TRUE(AnyIntersection(segments, options, &witness)) << s;
+    EXPECT_THAT(witness, testing::AnyOf(make_pair(0, 1), make_pair(1, 0)));
+    // With another segment starting there too.
+    segments.push_back({{0, 0}, {1, -1}});
+    EXPECT_TRUE(AnyIntersection(segments, options, nullptr)) << s;
+  }
+  // Starting together on the same line, with different ends.
+  EXPECT_TRUE(AnyIntersection({{{0, 0}, {2, 2}}, {{0, 0}, {1, 1}}}, options,
+                              nullptr));
+  EXPECT_FALSE(AnyIntersection({{{0, 0}, {2, 2}}, {{0, 0}, {2, 1}}}, options,
+                               nullptr));
+}
+
+TEST(AnyIntersectionTest, SameAsFindIntersections) {
+  int num_intersecting = 0;
+  for (auto distribution : {SHORT_SEGMENTS, LONG_SEGMENTS,
+                            AXIS_PARALLEL_SEGMENTS}) {
+    for (unsigned seed = 0; seed < 100; ++seed) {
+      vector<Segment> segments = RandomSegments(distribution, 8, seed);
+      auto intersections = FindIntersections(segments);
+      std::pair<int, int> witness;
+      bool found = AnyIntersection(segments, &witness);
+      ASSERT_EQ(!intersections.empty(), found)
+          << SegmentDistributionName(distribution) << " " << seed;
+      if (found) {
+        ++num_intersecting;
+        Point p;
+        EXPECT_TRUE(segments[witness.first].IntersectsSegment(
+                        segments[witness.second], &p))
+            << SegmentDistributionName(distribution) << " " << seed;
+      }
+    }
+  }
+  EXPECT_LT(50, num_intersecting);
+  EXPECT_GT(250, num_intersecting);
+}
+
 }  // namespace segment_intersection_internal
@@ -0,0 +1,423 @@
+#include "chapter6/polygon-index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include "base/parallel.h"
+#include "base/predicates.h"
+
+using std::vector;
+
+namespace {
+
+// Edges are listed in every cell within this fraction of a cell of them, so
+// that rounding in locating edges and query points never loses an edge.
+const double kSlack = 1e-3;
+
+// The most cells a grid gets, whatever the number of edges.
+const double kMaxCells = 1 << 26;
+
+// Grids nest at most this deep, as edges meeting at a vertex stay together
+// however fine the grid.
+const int kMaxDepth = 3;
+
+// The fewest cells of a nested grid.
+const double kMinNestedCells = 4;
+
+// Query points are located this many at a time.
+const size_t kBlockSize = 256;
+
+// Whether p lies to the left of the edge from a to b directed upward, for
+// an edge with one endpoint above p.y and the other not.
+bool LeftOfUpwardEdge(Point a, Point b, Point p) {
+  return a.y < b.y ? Orientation(a, b, p) > 0 : Orientation(b, a, p) > 0;
+}
+
+// Whether p lies below the edge from a to b directed to the right, for an
+// edge with one endpoint to the right of p.x and the other not.
+bool BelowRightwardEdge(Point a, Point b, Point p) {
+  return a.x < b.x ? Orientation(a, b, p) < 0 : Orientation(b, a, p) < 0;
+}
+
+}  // namespace
+
+bool PointInPolygon(const Polygon& polygon, Point p) {
+  const vector<Point>& v = polygon.points;
+  bool inside = false;
+  for (size_t i = 0; i < v.size(); ++i) {
+    Point a = v[i];
+    Point b = v[i + 1 == v.size() ? 0 : i + 1];
+    if ((a.y > p.y) != (b.y > p.y) && LeftOfUpwardEdge(a, b, p)) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+PolygonIndex::PolygonIndex(const Polygon& polygon,
+                           const PolygonIndexOptions& options)
+    : polygon_(polygon),
+      options_(options),
+      min_x_(std::numeric_limits<double>::infinity()),
+      min_y_(std::numeric_limits<double>::infinity()),
+      max_x_(-std::numeric_limits<double>::infinity()),
+      max_y_(-std::numeric_limits<double>::infinity()) {
+  const vector<Point>& v = polygon.points;
+  vector<uint32_t> all_edges;
+  for (size_t i = 0; i < v.size(); ++i) {
+    edges_.push_back(Edge{v[i], v[i + 1 == v.size() ? 0 : i + 1]});
+    all_edges.push_back(i);
+    min_x_ = std::min(min_x_, v[i].x);
+    min_y_ = std::min(min_y_, v[i].y);
+    max_x_ = std::max(max_x_, v[i].x);
+    max_y_ = std::max(max_y_, v[i].y);
+  }
+  if (v.empty()) {
+    grids_.push_back(MakeGrid(0, 0, 0, 0, 1));
+  } else {
+    grids_.push_back(MakeGrid(min_x_, min_y_, max_x_ - min_x_, max_y_ - min_y_,
+                              options.cells_per_edge * v.size()));
+  }
+  BuildGrid(0, all_edges, 0, 0, 0);
+}
+
+size_t PolygonIndex::num_cells() const {
+  size_t count = 0;
+  for (const Grid& grid : grids_) {
+    count += grid.num_cells();
+  }
+  return count;
+}
+
+size_t PolygonIndex::num_edge_cells() const {
+  size_t count = 0;
+  for (const Grid& grid : grids_) {
+    count += std::count_if(grid.cell_states.begin(), grid.cell_states.end(),
+                           [](uint8_t state) { return state & HAS_EDGES; });
+  }
+  return count;
+}
+
+size_t PolygonIndex::num_cell_edges() const {
+  size_t count = 0;
+  for (const Grid& grid : grids_) {
+    count += grid.cell_edges.size();
+  }
+  return count;
+}
+
+PolygonIndex::Grid PolygonIndex::MakeGrid(double min_x, double min_y,
+                                          double width, double height,
+                                          double num_cells) {
+  Grid grid;
+  grid.min_x = min_x;
+  grid.min_y = min_y;
+  grid.num_columns = 1;
+  grid.num_rows = 1;
+  num_cells = std::min(kMaxCells, std::max(1.0, std::ceil(num_cells)));
+  // Roughly square cells, unless the box is flat.
+  if (width > 0 && height > 0) {
+    double side = std::sqrt(width * height / num_cells);
+    grid.num_columns = std::min(num_cells, std::ceil(width / side));
+    grid.num_rows = std::min(num_cells / grid.num_columns,
+                             std::ceil(height / side));
+    grid.num_rows = std::max(grid.num_rows, 1);
+  } else if (width > 0) {
+    grid.num_columns = num_cells;
+  } else if (height > 0) {
+    grid.num_rows = num_cells;
+  }
+  grid.cell_width = width > 0 ? width / grid.num_columns : 1;
+  grid.cell_height = height > 0 ? height / grid.num_rows : 1;
+  grid.inverse_cell_width = 1 / grid.cell_width;
+  grid.inverse_cell_height = 1 / grid.cell_height;
+  return grid;
+}
+
+int PolygonIndex::Grid::ColumnOf(double x) const {
+  double column = std::floor((x - min_x) * inverse_cell_width);
+  return std::min(std::max(0.0, column), num_columns - 1.0);
+}
+
+int PolygonIndex::Grid::RowOf(double y) const {
+  double row = std::floor((y - min_y) * inverse_cell_height);
+  return std::min(std::max(0.0, row), num_rows - 1.0);
+}
+
+size_t PolygonIndex::Grid::CellOf(Point p) const {
+  // Truncation rounds down, since the clamped values are not negative.
+  int column = std::min(std::max(0.0, (p.x - min_x) * inverse_cell_width),
+                        num_columns - 1.0);
+  int row = std::min(std::max(0.0, (p.y - min_y) * inverse_cell_height),
+                     num_rows - 1.0);
+  return static_cast<size_t>(row) * num_columns + column;
+}
+
+double PolygonIndex::Grid::CenterX(int column) const {
+  return min_x + (column + 0.5) * cell_width;
+}
+
+double PolygonIndex::Grid::CenterY(int row) const {
+  return min_y + (row + 0.5) * cell_height;
+}
+
+Point PolygonIndex::Grid::CenterOf(size_t cell) const {
+  return Point(CenterX(cell % num_columns), CenterY(cell / num_columns));
+}
+
+size_t PolygonIndex::LocateCell(Point p) const {
+  bool in_box = p.x >= min_x_ && p.x <= max_x_
+      && p.y >= min_y_ && p.y <= max_y_;
+  // NaN coordinates are outside the box.
+  size_t cell = grids_[0].CellOf(p);
+  return in_box ? cell : grids_[0].num_cells();
+}
+
+template<class Function>
+void PolygonIndex::ForEachCellOfEdge(const Grid& grid, const Edge& e,
+                                     const Function& fn) {
+  double slack_x = kSlack * grid.cell_width;
+  double slack_y = kSlack * grid.cell_height;
+  int first_row = grid.RowOf(std::min(e.a.y, e.b.y) - slack_y);
+  int last_row = grid.RowOf(std::max(e.a.y, e.b.y) + slack_y);
+  for (int row = first_row; row <= last_row; ++row) {
+    // The part of the edge within the row, widened by the slack.
+    double x0 = e.a.x, x1 = e.b.x;
+    if (e.a.y != e.b.y) {
+      double y0 = grid.min_y + row * grid.cell_height - slack_y;
+      double y1 = grid.min_y + (row + 1) * grid.cell_height + slack_y;
+      double t0 = (y0 - e.a.y) / (e.b.y - e.a.y);
+      double t1 = (y1 - e.a.y) / (e.b.y - e.a.y);
+      if (t0 > t1) {
+        std::swap(t0, t1);
+      }
+      t0 = std::max(t0, 0.0);
+      t1 = std::min(t1, 1.0);
+      x0 = e.a.x + t0 * (e.b.x - e.a.x);
+      x1 = e.a.x + t1 * (e.b.x - e.a.x);
+    }
+    int first_column = grid.ColumnOf(std::min(x0, x1) - slack_x);
+    int last_column = grid.ColumnOf(std::max(x0, x1) + slack_x);
+    for (int column = first_column; column <= last_column; ++column) {
+      fn(static_cast<size_t>(row) * grid.num_columns + column);
+    }
+  }
+}
+
+bool PolygonIndex::OnEdge(const Edge& e, Point p) {
+  return Orientation(e.a, e.b, p) == 0
+      && std::min(e.a.x, e.b.x) <= p.x && p.x <= std::max(e.a.x, e.b.x)
+      && std::min(e.a.y, e.b.y) <= p.y && p.y <= std::max(e.a.y, e.b.y);
+}
+
+void PolygonIndex::BuildGrid(size_t index, const vector<uint32_t>& edges,
+                             size_t parent, size_t parent_cell, int depth) {
+  Grid& grid = grids_[index];
+  size_t num_cells = grid.num_cells();
+
+  // The edges of every cell, counted and then filled in.
+  grid.cell_begin.assign(num_cells + 2, 0);
+  for (uint32_t i : edges) {
+    ForEachCellOfEdge(grid, edges_[i], [&grid](size_t cell) {
+      ++grid.cell_begin[cell + 1];
+    });
+  }
+  for (size_t cell = 0; cell <= num_cells; ++cell) {
+    grid.cell_begin[cell + 1] += grid.cell_begin[cell];
+  }
+  grid.cell_edges.resize(grid.cell_begin[num_cells]);
+  vector<uint32_t> next(grid.cell_begin.begin(), grid.cell_begin.end() - 1);
+  for (uint32_t i : edges) {
+    ForEachCellOfEdge(grid, edges_[i], [&](size_t cell) {
+      grid.cell_edges[next[cell]++] = i;
+    });
+  }
+
+  // A cell center is inside if the ray from it crosses an odd number of
+  // edges, as in PointInPolygon. In every row, each edge crossing the line
+  // through the centers flips the state of the centers to its left. The
+  // edges of a nested grid are only those near its box, so its centers
+  // differ from the first one in their row by the flips between them, and
+  // the first one is asked of the parent cell.
+  int num_columns = grid.num_columns;
+  vector<uint8_t> flips(static_cast<size_t>(grid.num_rows) * (num_columns + 1));
+  for (uint32_t i : edges) {
+    const Edge& e = edges_[i];
+    if (e.a.y == e.b.y) {
+      continue;
+    }
+    Point lower = e.a.y < e.b.y ? e.a : e.b;
+    Point upper = e.a.y < e.b.y ? e.b : e.a;
+    // The rows whose centers have lower.y <= y < upper.y, found from one
+    // row early to be safe from rounding.
+    for (int row = std::max(0, grid.RowOf(lower.y) - 1);
+         row < grid.num_rows && grid.CenterY(row) < upper.y; ++row) {
+      double y = grid.CenterY(row);
+      if (y < lower.y) {
+        continue;
+      }
+      double x = lower.x
+          + (y - lower.y) * (upper.x - lower.x) / (upper.y - lower.y);
+      // The number of centers to the left, estimated and then corrected
+      // with exact tests.
+      double estimate =
+          std::ceil((x - grid.min_x) * grid.inverse_cell_width - 0.5);
+      int count = std::min<double>(std::max(0.0, estimate), num_columns);
+      auto left = [&](int column) {
+        return Orientation(lower, upper, Point(grid.CenterX(column), y)) > 0;
+      };
+      while (count > 0 && !left(count - 1)) {
+        --count;
+      }
+      while (count < num_columns && left(count)) {
+        ++count;
+      }
+      uint8_t* row_flips = &flips[static_cast<size_t>(row) * (num_columns + 1)];
+      row_flips[0] ^= 1;
+      row_flips[count] ^= 1;
+    }
+  }
+  // One more cell, never inside and without edges, for points outside the
+  // bounding box.
+  grid.cell_states.assign(num_cells + 1, 0);
+  for (int row = 0; row < grid.num_rows; ++row) {
+    const uint8_t* row_flips =
+        &flips[static_cast<size_t>(row) * (num_columns + 1)];
+    uint8_t inside = row_flips[0];
+    if (index != 0) {
+      Point first(grid.CenterX(0), grid.CenterY(row));
+      inside = ContainsInCell(first, grids_[parent], parent_cell);
+    }
+    for (int column = 0; column < num_columns; ++column) {
+      if (column > 0) {
+        inside ^= row_flips[column];
+      }
+      grid.cell_states[static_cast<size_t>(row) * num_columns + column] =
+          inside ? CENTER_INSIDE : 0;
+    }
+  }
+
+  vector<size_t> crowded;
+  for (size_t cell = 0; cell < num_cells; ++cell) {
+    uint32_t begin = grid.cell_begin[cell], end = grid.cell_begin[cell + 1];
+    if (begin == end) {
+      continue;
+    }
+    grid.cell_states[cell] |= HAS_EDGES;
+    Point c = grid.CenterOf(cell);
+    for (uint32_t i = begin; i < end; ++i) {
+      if (OnEdge(edges_[grid.cell_edges[i]], c)) {
+        grid.cell_states[cell] |= CENTER_ON_BOUNDARY;
+      }
+    }
+    if (end - begin > static_cast<uint32_t>(options_.max_cell_edges)
+        && depth < kMaxDepth) {
+      crowded.push_back(cell);
+    }
+  }
+
+  // Crowded cells get finer grids, which may move grid.
+  if (!crowded.empty()) {
+    grid.nested.assign(num_cells, 0);
+  }
+  for (size_t cell : crowded) {
+    const Grid& g = grids_[index];
+    uint32_t begin = g.cell_begin[cell], end = g.cell_begin[cell + 1];
+    vector<uint32_t> cell_edges(g.cell_edges.begin() + begin,
+                                g.cell_edges.begin() + end);
+    Point c = g.CenterOf(cell);
+    Grid nested = MakeGrid(
+        c.x - g.cell_width / 2, c.y - g.cell_height / 2, g.cell_width,
+        g.cell_height,
+        std::max(kMinNestedCells, options_.cells_per_edge * (end - begin)));
+    size_t nested_index = grids_.size();
+    grids_[index].nested[cell] = nested_index;
+    grids_[index].cell_states[cell] |= HAS_GRID;
+    grids_.push_back(std::move(nested));
+    BuildGrid(nested_index, cell_edges, index, cell, depth + 1);
+  }
+}
+
+bool PolygonIndex::Contains(Point p) const {
+  size_t cell = LocateCell(p);
+  uint8_t state = grids_[0].cell_states[cell];
+  if (!(state & HAS_EDGES)) {
+    return state & CENTER_INSIDE;
+  }
+  return ContainsInEdgeCell(p, grids_[0], cell);
+}
+
+bool PolygonIndex::ContainsInEdgeCell(Point p, const Grid& grid,
+                                      size_t cell) const {
+  const Grid* g = &grid;
+  while (g->cell_states[cell] & HAS_GRID) {
+    g = &grids_[g->nested[cell]];
+    cell = g->CellOf(p);
+  }
+  uint8_t state = g->cell_states[cell];
+  if (!(state & HAS_EDGES)) {
+    return state & CENTER_INSIDE;
+  }
+  return ContainsInCell(p, *g, cell);
+}
+
+bool PolygonIndex::ContainsInCell(Point p, const Grid& grid,
+                                  size_t cell) const {
+  uint8_t state = grid.cell_states[cell];
+  if (state & CENTER_ON_BOUNDARY) {
+    return PointInPolygon(polygon_, p);
+  }
+  // The state of the center changes wherever the path from it to p crosses
+  // an edge, counted with the rule of PointInPolygon on the horizontal leg
+  // and the same rule turned by 90 degrees on the vertical one. The rules
+  // agree off the boundary, so the corner of the path must not lie on it.
+  Point c = grid.CenterOf(cell);
+  Point corner(c.x, p.y);
+  bool inside = state & CENTER_INSIDE;
+  for (uint32_t i = grid.cell_begin[cell]; i < grid.cell_begin[cell + 1];
+       ++i) {
+    const Edge& e = edges_[grid.cell_edges[i]];
+    if ((e.a.x > c.x) != (e.b.x > c.x)) {
+      if (OnEdge(e, corner)) {
+        return PointInPolygon(polygon_, p);
+      }
+      inside ^= BelowRightwardEdge(e.a, e.b, c)
+          != BelowRightwardEdge(e.a, e.b, corner);
+    } else if (std::max(e.a.x, e.b.x) == c.x && OnEdge(e, corner)) {
+      return PointInPolygon(polygon_, p);
+    }
+    if ((e.a.y > p.y) != (e.b.y > p.y)) {
+      inside ^= LeftOfUpwardEdge(e.a, e.b, corner)
+          != LeftOfUpwardEdge(e.a, e.b, p);
+    }
+  }
+  return inside;
+}
+
+void PolygonIndex::Contains(Span<const Point> points, Span<signed char> inside,
+                            int num_threads) const {
+  num_threads =
+      ClampNumThreads(num_threads, points.size(), kMinPointsPerThread);
+  size_t chunk_size = (points.size() + num_threads - 1) / num_threads;
+  const Grid& grid = grids_[0];
+  RunInParallel(num_threads, [&](int thread) {
+    size_t end = std::min(points.size(), (thread + 1) * chunk_size);
+    size_t cells[kBlockSize];
+    for (size_t begin = thread * chunk_size; begin < end;
+         begin += kBlockSize) {
+      size_t n = std::min(kBlockSize, end - begin);
+      const Point* block = points.data() + begin;
+      signed char* out = inside.data() + begin;
+      for (size_t i = 0; i < n; ++i) {
+        cells[i] = LocateCell(block[i]);
+        out[i] = grid.cell_states[cells[i]] & CENTER_INSIDE;
+      }
+      for (size_t i = 0; i < n; ++i) {
+        if (grid.cell_states[cells[i]] & HAS_EDGES) {
+          out[i] = ContainsInEdgeCell(block[i], grid, cells[i]);
+        }
+      }
+    }
+  });
+}
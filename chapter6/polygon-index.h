@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "base/base.h"
+#include "base/span.h"
+
+// Whether p lies inside the polygon by the even-odd rule, in O(n) time: the
+// number of edges crossed by the ray from p in the +x direction is odd. An
+// edge is crossed if one endpoint lies above p and the other does not, and p
+// lies strictly to the left of it, all decided exactly. This half-open rule
+// gives every point of the plane an answer, and on a shared boundary exactly
+// one of two neighboring polygons contains it.
+bool PointInPolygon(const Polygon& polygon, Point p);
+
+struct PolygonIndexOptions {
+  // The number of grid cells per polygon edge. More cells leave fewer edges
+  // in each cell, and so fewer points to test against edges, at the cost of
+  // memory.
+  double cells_per_edge;
+  // A cell meeting more edges than this gets a finer grid of its own.
+  int max_cell_edges;
+
+  PolygonIndexOptions() : cells_per_edge(2), max_cell_edges(16) {}
+};
+
+// A polygon prepared for many containment queries, with the same answers as
+// PointInPolygon. The bounding box of the polygon is cut into a uniform grid.
+// Every cell lists the edges meeting it and knows whether its center lies
+// inside, so a query in a cell that no edge meets takes O(1) time, and one
+// in another cell only tests the edges of that cell: a path from the center
+// to the query point with one vertical and one horizontal leg crosses no
+// other edge. A cell meeting many edges, which is where a long boundary
+// passes, is cut into a finer grid of its own in the same way, so queries
+// next to the boundary stay fast too. Building takes time and memory in
+// proportion to the number of cells plus the number of edge cells.
+//
+// The rare query for which the path touches the boundary at its corner, or
+// in a cell whose center lies on the boundary, falls back to
+// PointInPolygon.
+class PolygonIndex {
+ public:
+  explicit PolygonIndex(const Polygon& polygon,
+                        const PolygonIndexOptions& options =
+                            PolygonIndexOptions());
+
+  bool Contains(Point p) const;
+
+  // Sets inside[i] to 1 if points[i] lies inside and to 0 otherwise; inside
+  // must have room for points.size() values. Points are located in blocks,
+  // first all of a block at once in a loop without branches, and then only
+  // the points in cells with edges are tested against them. The blocks are
+  // split over up to num_threads threads.
+  void Contains(Span<const Point> points, Span<signed char> inside,
+                int num_threads = 1) const;
+
+  // The grid over the bounding box.
+  int num_columns() const { return grids_[0].num_columns; }
+  int num_rows() const { return grids_[0].num_rows; }
+  // The number of finer grids.
+  size_t num_nested_grids() const { return grids_.size() - 1; }
+  // The number of cells of all grids, the number of them that edges meet,
+  // and the number of edges listed in them, counting an edge once for every
+  // cell it meets.
+  size_t num_cells() const;
+  size_t num_edge_cells() const;
+  size_t num_cell_edges() const;
+
+ private:
+  enum CellState : uint8_t {
+    // The cell center lies inside.
+    CENTER_INSIDE = 1,
+    // Edges meet the cell.
+    HAS_EDGES = 2,
+    // The cell center lies on an edge, so it cannot anchor queries.
+    CENTER_ON_BOUNDARY = 4,
+    // The cell has a finer grid, which answers its queries.
+    HAS_GRID = 8,
+  };
+
+  struct Edge {
+    Point a, b;
+  };
+
+  // A uniform grid over a box, with cells numbered row by row. The cell
+  // after the last one stands for points outside the bounding box of the
+  // polygon.
+  struct Grid {
+    double min_x, min_y;
+    double cell_width, cell_height;
+    double inverse_cell_width, inverse_cell_height;
+    int num_columns, num_rows;
+    std::vector<uint8_t> cell_states;
+    // The edges of cell i are cell_edges[cell_begin[i]] up to
+    // cell_edges[cell_begin[i + 1]].
+    std::vector<uint32_t> cell_begin;
+    std::vector<uint32_t> cell_edges;
+    // For cells with a finer grid, its index in grids_.
+    std::vector<uint32_t> nested;
+
+    size_t num_cells() const {
+      return static_cast<size_t>(num_rows) * num_columns;
+    }
+    // Clamped into the grid.
+    int ColumnOf(double x) const;
+    int RowOf(double y) const;
+    // Clamped into the grid, without branches.
+    size_t CellOf(Point p) const;
+    double CenterX(int column) const;
+    double CenterY(int row) const;
+    Point CenterOf(size_t cell) const;
+  };
+
+  // Cuts the box into about num_cells roughly square cells.
+  static Grid MakeGrid(double min_x, double min_y, double width,
+                       double height, double num_cells);
+  // Calls fn(cell) for every cell of grid that e meets or nearly meets.
+  template<class Function>
+  static void ForEachCellOfEdge(const Grid& grid, const Edge& e,
+                                const Function& fn);
+  static bool OnEdge(const Edge& e, Point p);
+
+  // Fills in the cells of grids_[index] from the edges near its box, and
+  // adds finer grids for its crowded cells. A nested grid refines
+  // parent_cell of grids_[parent] and lies depth levels down.
+  void BuildGrid(size_t index, const std::vector<uint32_t>& edges,
+                 size_t parent, size_t parent_cell, int depth);
+  // The cell of grids_[0] holding p, or the one after the last if p lies
+  // outside the bounding box. Without branches.
+  size_t LocateCell(Point p) const;
+  // Contains for a point in a cell with edges, which may have a finer grid.
+  bool ContainsInEdgeCell(Point p, const Grid& grid, size_t cell) const;
+  // Contains for a point in a cell with edges and no finer grid.
+  bool ContainsInCell(Point p, const Grid& grid, size_t cell) const;
+
+  Polygon polygon_;
+  PolygonIndexOptions options_;
+  std::vector<Edge> edges_;
+  double min_x_, min_y_, max_x_, max_y_;
+  // grids_[0] covers the bounding box.
+  std::vector<Grid> grids_;
+};
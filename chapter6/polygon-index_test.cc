@@ -0,0 +1,129 @@
+#include "chapter6/polygon-index.h"
+
+#include <vector>
+#include "base/workload.h"
+#include "gtest/gtest.h"
+
+using std::vector;
+
+namespace {
+
+// Checks the index against PointInPolygon at every point, one at a time and
+// in batches.
+void ExpectSameAsPointInPolygon(const Polygon& polygon,
+                                const vector<Point>& points,
+                                const PolygonIndexOptions& options) {
+  PolygonIndex index(polygon, options);
+  vector<signed char> expected;
+  for (Point p : points) {
+    expected.push_back(PointInPolygon(polygon, p));
+    ASSERT_EQ(expected.back(), index.Contains(p)) << p;
+  }
+  for (int num_threads : {-1, 1, 4}) {
+    vector<signed char> inside(points.size(), -1);
+    index.Contains(points, inside, num_threads);
+    EXPECT_EQ(expected, inside) << num_threads;
+  }
+}
+
+TEST(PointInPolygonTest, Square) {
+  Polygon square{{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+  EXPECT_TRUE(PointInPolygon(square, Point(0.5, 0.5)));
+  EXPECT_FALSE(PointInPolygon(square, Point(1.5, 0.5)));
+  EXPECT_FALSE(PointInPolygon(square, Point(-0.5, 0.5)));
+  EXPECT_FALSE(PointInPolygon(square, Point(0.5, 1.5)));
+  // Of the boundary, the left and bottom sides are inside.
+  EXPECT_TRUE(PointInPolygon(square, Point(0, 0.5)));
+  EXPECT_FALSE(PointInPolygon(square, Point(1, 0.5)));
+  EXPECT_TRUE(PointInPolygon(square, Point(0.5, 0)));
+  EXPECT_FALSE(PointInPolygon(square, Point(0.5, 1)));
+  EXPECT_FALSE(PointInPolygon(Polygon(), Point(0, 0)));
+}
+
+TEST(PointInPolygonTest, SharedBoundary) {
+  // Two triangles splitting a square along its diagonal.
+  Polygon lower{{0, 0}, {1, 0}, {1, 1}};
+  Polygon upper{{0, 0}, {1, 1}, {0, 1}};
+  for (Point p : {Point(0.5, 0.5), Point(0.25, 0.25), Point(0.5, 0.75),
+                  Point(0.75, 0.5)}) {
+    EXPECT_NE(PointInPolygon(lower, p), PointInPolygon(upper, p)) << p;
+  }
+}
+
+TEST(PolygonIndexTest, RandomPolygon) {
+  Polygon polygon = RandomPolygon(1000, 5);
+  vector<Point> points = RandomPoints(UNIFORM_SQUARE, 20000, 6);
+  // Points on the boundary too.
+  const vector<Point>& v = polygon.points;
+  for (size_t i = 0; i < v.size(); ++i) {
+    Point a = v[i], b = v[(i + 1) % v.size()];
+    points.push_back(a);
+    points.push_back(Point((a.x + b.x) / 2, (a.y + b.y) / 2));
+  }
+  for (double cells_per_edge : {0.01, 0.5, 2.0, 16.0}) {
+    // Grids nested as deep as they go too.
+    for (int max_cell_edges : {1, 16}) {
+      SCOPED_TRACE(cells_per_edge);
+      SCOPED_TRACE(max_cell_edges);
+      PolygonIndexOptions options;
+      options.cells_per_edge = cells_per_edge;
+      options.max_cell_edges = max_cell_edges;
+      ExpectSameAsPointInPolygon(polygon, points, options);
+    }
+  }
+}
+
+TEST(PolygonIndexTest, Lattice) {
+  // A comb with axis-parallel edges on a lattice of spacing 1/2, indexed
+  // with a 4 by 4 grid, so that cell centers and query paths run along the
+  // edges and through the vertices.
+  Polygon comb{{0, 0}, {4, 0}, {4, 4}, {3.5, 4}, {3.5, 0.5}, {2.5, 0.5},
+               {2.5, 4}, {1.5, 4}, {1.5, 0.5}, {0.5, 0.5}, {0.5, 4},
+               {0, 4}};
+  Polygon diamond{{2, 0}, {4, 2}, {2, 4}, {0, 2}};
+  for (const Polygon* polygon : {&comb, &diamond}) {
+    PolygonIndexOptions options;
+    options.cells_per_edge = 16.0 / polygon->points.size();
+    PolygonIndex index(*polygon, options);
+    EXPECT_EQ(4, index.num_columns());
+    EXPECT_EQ(4, index.num_rows());
+    vector<Point> points;
+    for (int i = -2; i <= 18; ++i) {
+      for (int j = -2; j <= 18; ++j) {
+        points.push_back(Point(i / 4.0, j / 4.0));
+      }
+    }
+    ExpectSameAsPointInPolygon(*polygon, points, options);
+  }
+}
+
+TEST(PolygonIndexTest, Degenerate) {
+  vector<Point> points = RandomPoints(DEGENERATE, 1000, 7);
+  points.push_back(Point(0.5, 0.5));
+  for (const Polygon& polygon : {Polygon(), Polygon{{0.5, 0.5}},
+                                 Polygon{{0, 0.5}, {1, 0.5}},
+                                 Polygon{{0.5, 0}, {0.5, 1}},
+                                 Polygon{{0, 0}, {1, 1}, {0.5, 0.5}}}) {
+    ExpectSameAsPointInPolygon(polygon, points, PolygonIndexOptions());
+  }
+}
+
+TEST(PolygonIndexTest, Sizes) {
+  Polygon polygon = RandomPolygon(10000, 8);
+  PolygonIndex index(polygon);
+  EXPECT_NEAR(20000, index.num_columns() * index.num_rows(), 400);
+  // The cells along the boundary get finer grids, which add fewer cells
+  // than the grid over the bounding box has.
+  EXPECT_GT(index.num_nested_grids(), 0);
+  EXPECT_LT(index.num_cells(), 2 * index.num_columns() * index.num_rows());
+  // Most cells lie wholly inside or outside, and short edges meet few
+  // cells.
+  EXPECT_LT(index.num_edge_cells(), index.num_cells() / 8);
+  EXPECT_LT(index.num_cell_edges(), 2 * polygon.points.size());
+
+  PolygonIndexOptions options;
+  options.max_cell_edges = polygon.points.size();
+  EXPECT_EQ(0, PolygonIndex(polygon, options).num_nested_grids());
+}
+
+}  // namespace